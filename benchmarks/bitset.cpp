@@ -0,0 +1,61 @@
+// Compares boolean masks stored as fp_dynarray(bool) against fp_bitset for counting and combining, at each SIMD level
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+#define FP_IMPLEMENTATION
+#include <fp/dynarray.hpp>
+#include <fp/bitset.hpp>
+
+constexpr size_t bits = 1 << 24;
+constexpr size_t repeats = 20;
+
+template<typename F>
+static double measure(F f) {
+	auto start = std::chrono::steady_clock::now();
+	for(size_t i = 0; i < repeats; ++i) f();
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / repeats;
+}
+
+int main() {
+	std::mt19937_64 rng(42);
+	fp::raii::dynarray<bool> bools_a, bools_b;
+	fp::raii::bitset set_a(bits), set_b(bits);
+	for(size_t i = 0; i < bits; ++i) {
+		bool a = rng() & 1, b = rng() & 1;
+		bools_a.push_back(a);
+		bools_b.push_back(b);
+		set_a.set(i, a);
+		set_b.set(i, b);
+	}
+
+	size_t sink = 0;
+	printf("%zu bits (dynarray(bool): %zu KiB, bitset: %zu KiB)\n", bits, bits / 1024, bits / 8 / 1024);
+	printf("  %-34s %8.3f ms\n", "dynarray(bool) count", measure([&] {
+		size_t count = 0;
+		for(bool b: bools_a) count += b;
+		sink += count;
+	}));
+	printf("  %-34s %8.3f ms\n", "dynarray(bool) and", measure([&] {
+		for(size_t i = 0; i < bits; ++i) bools_a[i] = bools_a[i] & bools_b[i];
+	}));
+
+	const char* levels[] = {"scalar", "sse2", "avx2", "avx512"};
+	for(int level = FP_SIMD_SCALAR; level <= FP_SIMD_AVX512; ++level) {
+		if(fp_simd_set_level((enum fp_simd_level)level) != level) continue;
+		char name[64];
+		snprintf(name, sizeof(name), "bitset count (%s)", levels[level]);
+		printf("  %-34s %8.3f ms\n", name, measure([&] { sink += set_a.count(); }));
+		snprintf(name, sizeof(name), "bitset and (%s)", levels[level]);
+		printf("  %-34s %8.3f ms\n", name, measure([&] { set_a &= set_b; }));
+	}
+	fp_simd_set_level(fp_simd_detect());
+
+	auto index = set_b.rank_index();
+	printf("  %-34s %8.3f ms (per million)\n", "bitset select", measure([&] {
+		size_t total = set_b.count();
+		for(size_t k = 0; k < 1000000; ++k) sink += set_b.select(index.data(), (k * 7919) % total);
+	}));
+	return sink == 42;
+}
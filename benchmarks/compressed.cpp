@@ -0,0 +1,63 @@
+// Measures how much smaller sorted IDs get in each compressed integer format, and how quickly they decode back into uint64_t
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+#define FP_IMPLEMENTATION
+#include <fp/dynarray.hpp>
+#include <fp/compressed.hpp>
+
+constexpr size_t count = 1 << 24;
+constexpr size_t repeats = 10;
+
+template<typename F>
+static double measure(F f) {
+	auto start = std::chrono::steady_clock::now();
+	for(size_t i = 0; i < repeats; ++i) f();
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / repeats;
+}
+
+static void report(const char* name, size_t bytes, double ms) {
+	printf("  %-28s %10.1f MiB %8.2fx %10.2f GB/s\n", name, bytes / 1048576.0, double(count * sizeof(uint64_t)) / bytes, count * sizeof(uint64_t) / ms / 1e6);
+}
+
+int main() {
+	std::mt19937_64 rng(42);
+	fp::raii::dynarray<uint64_t> ids, out;
+	uint64_t id = 1ull << 40;
+	for(size_t i = 0; i < count; ++i) ids.push_back(id += 1 + rng() % 32);
+	out.resize(count);
+	uint64_t sink = 0;
+
+	printf("%zu sorted IDs (gaps of 1-32), decoded throughput counts uint64_t output\n", count);
+	printf("  %-28s %10.1f MiB %8.2fx %10.2f GB/s\n", "fp_dynarray(uint64_t) copy", count * 8 / 1048576.0, 1.0, count * sizeof(uint64_t) / measure([&] {
+		memcpy(out.data(), ids.data(), count * sizeof(uint64_t));
+		sink += out[count / 2];
+	}) / 1e6);
+
+	fp::packed_array packed(ids.full_view());
+	const char* levels[] = {"scalar", "sse2", "avx2", "avx512"};
+	for(int level = FP_SIMD_SCALAR; level <= FP_SIMD_AVX512; ++level) {
+		if(fp_simd_set_level((enum fp_simd_level)level) != level || level == FP_SIMD_SSE2) continue;
+		char name[64];
+		snprintf(name, sizeof(name), "packed (%u bits, %s)", packed.width(), levels[level]);
+		report(name, packed.bytes(), measure([&] { packed.unpack(0, out.full_view()); sink += out[count / 2]; }));
+	}
+	fp_simd_set_level(fp_simd_detect());
+
+	for(bool delta: {false, true}) {
+		fp::for_array encoded(ids.full_view(), delta);
+		report(delta ? "delta + frame of reference" : "frame of reference", encoded.bytes(), measure([&] { encoded.decode(0, out.full_view()); sink += out[count / 2]; }));
+		auto start = std::chrono::steady_clock::now();
+		for(size_t i = 0; i < 1000000; ++i) sink += encoded[(i * 7919) % count];
+		printf("  %-28s %10.1f ns\n", "  random access", std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / 1000000);
+	}
+
+	auto bytes = fp::varint_encode(ids.full_view(), true);
+	report("delta + varint", bytes.size(), measure([&] {
+		fp_varint_decode(bytes.data(), bytes.size(), out.data(), count, true);
+		sink += out[count / 2];
+	}));
+	return sink == 42;
+}
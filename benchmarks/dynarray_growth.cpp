@@ -0,0 +1,98 @@
+// Measures how many bytes long fpda_push_back loops copy (and how much memory they briefly need) while growing
+// Compares the library's reallocating growth against allocating a new block, copying into it, and freeing the old one,
+// and against a segmented dynarray (which never copies)
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+
+struct counters {
+	size_t live = 0; // Bytes currently allocated
+	size_t peak = 0; // Most bytes allocated at once
+	size_t copied = 0; // Bytes moved by realloc (when it couldn't resize the block in place) or by hand
+} stats;
+
+// Every block is prefixed by the size requested for it so that realloc's copies can be counted
+static void* counting_allocate(void* p, size_t size) noexcept {
+	size_t* block = p ? ((size_t*)p) - 2 : nullptr;
+	size_t old_size = block ? block[0] : 0;
+	if(size == 0) {
+		stats.live -= old_size;
+		free(block);
+		return nullptr;
+	}
+
+	size_t* resized = (size_t*)realloc(block, size + 2 * sizeof(size_t));
+	if(!resized) return nullptr;
+	if(block && resized != block)
+		stats.copied += old_size < size ? old_size : size;
+	resized[0] = size;
+	stats.live += size - old_size;
+	if(stats.live > stats.peak) stats.peak = stats.live;
+	return resized + 2;
+}
+
+#define FP_ALLOCATION_FUNCTION counting_allocate
+#define FP_IMPLEMENTATION
+#include <fp/pointer.h>
+#include <fp/dynarray.h>
+#include <fp/segmented_dynarray.h>
+
+static void release(uint32_t* da) { fpda_free(da); }
+static void release(fp_segmented_dynarray a) { fp_segmented_dynarray_free(&a); }
+
+template<typename F>
+static void measure(const char* name, size_t count, F push_all) {
+	stats = {};
+	auto start = std::chrono::steady_clock::now();
+	auto array = push_all(count);
+	double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	printf("%-24s %12zu %16zu %14.2f %14zu %10.2f\n", name, count, stats.copied, double(stats.copied) / (count * sizeof(uint32_t)), stats.peak, ms);
+	release(array);
+}
+
+int main() {
+#ifdef FP_HAS_MMAP
+	fp_mmap_options()->threshold = 0; // Keep every block in the counting allocator
+#endif
+	printf("%-24s %12s %16s %14s %14s %10s\n", "strategy", "elements", "bytes copied", "copies/byte", "peak bytes", "ms");
+	for(size_t count = 1000; count <= 100000000; count *= 10) {
+		measure("realloc (fpda_push_back)", count, [](size_t count) {
+			fp_dynarray(uint32_t) da = nullptr;
+			for(size_t i = 0; i < count; ++i)
+				fpda_push_back(da, (uint32_t)i);
+			return da;
+		});
+		measure("malloc + copy + free", count, [](size_t count) {
+			fp_dynarray(uint32_t) da = nullptr;
+			for(size_t i = 0; i < count; ++i) {
+				if(fpda_size(da) == fpda_capacity(da)) {
+					fp_dynarray(uint32_t) bigger = nullptr;
+					fpda_reserve(bigger, da ? fpda_capacity(da) * 2 : FPDA_DEFAULT_SIZE_BYTES / sizeof(uint32_t));
+					if(da) {
+						fpda_grow_to_size(bigger, fpda_size(da));
+						memcpy(bigger, da, fpda_size(da) * sizeof(uint32_t));
+						stats.copied += fpda_size(da) * sizeof(uint32_t);
+						fpda_free(da);
+					}
+					da = bigger;
+				}
+				fpda_push_back(da, (uint32_t)i);
+			}
+			return da;
+		});
+		measure("segmented dynarray", count, [](size_t count) {
+			fp_segmented_dynarray a;
+			fp_segmented_dynarray_init_type(&a, uint32_t);
+			for(size_t i = 0; i < count; ++i) {
+				uint32_t value = i;
+				fp_segmented_dynarray_push_back(&a, &value);
+			}
+			return a;
+		});
+	}
+	return 0;
+}
@@ -0,0 +1,94 @@
+// Measures how much memory small fat pointers, strings, and dynarrays consume
+// Built twice by CMake, once with the default headers and once with FP_COMPACT_HEADERS, so the two layouts can be compared
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <cstddef>
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+struct counters {
+	size_t requested = 0; // Bytes asked for by the library
+	size_t usable = 0; // Bytes the system allocator actually handed out
+} live;
+
+// Every block is prefixed by the size requested for it so that frees can be subtracted
+// NOTE: The prefix is a multiple of glibc's 16 byte chunk granularity, so it is simply subtracted from the usable size
+static void* counting_allocate(void* p, size_t size) noexcept {
+	size_t* block = p ? ((size_t*)p) - 2 : nullptr;
+	if(block) {
+		live.requested -= block[0];
+#ifdef __GLIBC__
+		live.usable -= malloc_usable_size(block) - 2 * sizeof(size_t);
+#endif
+	}
+	if(size == 0) {
+		free(block);
+		return nullptr;
+	}
+
+	block = (size_t*)realloc(block, size + 2 * sizeof(size_t));
+	if(!block) return nullptr;
+	block[0] = size;
+	live.requested += size;
+#ifdef __GLIBC__
+	live.usable += malloc_usable_size(block) - 2 * sizeof(size_t);
+#endif
+	return block + 2;
+}
+
+#define FP_ALLOCATION_FUNCTION counting_allocate
+#define FP_IMPLEMENTATION
+#include <fp/pointer.h>
+#include <fp/dynarray.h>
+#include <fp/string.h>
+
+constexpr size_t count = 1000000;
+
+template<typename F>
+static void measure(const char* name, F make) {
+	auto pointers = (void**)malloc(sizeof(void*) * count);
+	counters before = live;
+	for(size_t i = 0; i < count; ++i)
+		pointers[i] = make(i);
+	double requested = double(live.requested - before.requested) / count;
+	double usable = double(live.usable - before.usable) / count;
+	printf("%-32s %10.2f %10.2f\n", name, requested, usable);
+
+	for(size_t i = 0; i < count; ++i)
+		fp_string_free((fp_string)pointers[i]);
+	free(pointers);
+}
+
+int main() {
+#ifdef FP_COMPACT_HEADERS
+	printf("Compact headers: ");
+#else
+	printf("Default headers: ");
+#endif
+	printf("FP_HEADER_SIZE = %zu, FPDA_HEADER_SIZE = %zu\n", (size_t)FP_HEADER_SIZE, (size_t)FPDA_HEADER_SIZE);
+	printf("%-32s %10s %10s\n", "bytes per allocation", "requested", "usable");
+
+	measure("fp_malloc(int, 4)", [](size_t) -> void* {
+		return fp_malloc(int, 4);
+	});
+	measure("fpda_reserve(int, 4)", [](size_t) -> void* {
+		fp_dynarray(int) da = nullptr;
+		fpda_reserve(da, 4);
+		return da;
+	});
+	measure("fp_string (1-24 characters)", [](size_t i) -> void* {
+		static const char* text = "abcdefghijklmnopqrstuvwx";
+		return fp_string_view_make_dynamic(fp_string_view_literal((char*)text, 1 + i % 24));
+	});
+	measure("fpda_push_back(int) x 3", [](size_t) -> void* {
+		fp_dynarray(int) da = nullptr;
+		for(int i = 0; i < 3; ++i)
+			fpda_push_back(da, i);
+		return da;
+	});
+	return 0;
+}
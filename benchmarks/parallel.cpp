@@ -0,0 +1,52 @@
+// Compares the parallel algorithms in parallel.hpp against their sequential counterparts as the number of threads grows
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <thread>
+
+#define FP_IMPLEMENTATION
+#include <fp/dynarray.hpp>
+#include <fp/parallel.hpp>
+
+constexpr size_t count = 20000000;
+
+template<typename F>
+static double measure(F f) {
+	auto start = std::chrono::steady_clock::now();
+	f();
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main() {
+	std::mt19937_64 rng(42);
+	fp::raii::dynarray<uint32_t> input; input.reserve(count);
+	for(size_t i = 0; i < count; ++i)
+		input.push_back((uint32_t)rng());
+	fp::raii::dynarray<uint32_t> data = input;
+	fp::raii::dynarray<double> out; out.resize(count);
+	fp::raii::dynarray<uint64_t> sums; sums.resize(count);
+
+	printf("%-8s %12s %12s %12s %12s %12s\n", "threads", "sort ms", "fill ms", "transform ms", "reduce ms", "scan ms");
+	size_t hardware = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+	for(size_t threads = 1; threads <= hardware; threads *= 2) {
+		fp::thread_pool pool(threads - 1);
+		fp::parallel::options opts{.pool = &pool};
+		uint64_t total = 0;
+
+		std::copy(input.begin(), input.end(), data.begin());
+		double sort = measure([&] { fp::parallel::sort(data.full_view(), std::less<>{}, opts); });
+		if(!std::is_sorted(data.begin(), data.end())) printf("NOT SORTED\n");
+		double fill = measure([&] { fp::parallel::fill(out.full_view(), 1.0, opts); });
+		double transform = measure([&] { fp::parallel::transform(input.full_view(), out.full_view(), [](uint32_t x) { return std::sqrt((double)x); }, opts); });
+		double reduce = measure([&] { total = fp::parallel::reduce(input.full_view(), uint64_t{0}, std::plus<>{}, opts); });
+		double scan = measure([&] { fp::parallel::inclusive_scan(input.full_view(), sums.full_view(), std::plus<>{}, opts); });
+		if(sums[count - 1] != total) printf("SCAN MISMATCH\n");
+		printf("%-8zu %12.2f %12.2f %12.2f %12.2f %12.2f\n", threads, sort, fill, transform, reduce, scan);
+	}
+	return 0;
+}
@@ -0,0 +1,108 @@
+// Measures the throughput of the lock-free queues in queue.h against a mutex protected dynarray as producers and consumers are added
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#define FP_IMPLEMENTATION
+#include <fp/dynarray.hpp>
+#include <fp/queue.hpp>
+
+constexpr size_t items = 4000000; // Per producer
+constexpr size_t capacity = 1024;
+constexpr size_t batch = 64;
+
+// Baseline: dynarray used as a FIFO under a mutex (consumers take everything at once)
+struct locked_queue {
+	std::mutex lock;
+	fp::raii::dynarray<size_t> items;
+
+	bool push(size_t value) {
+		std::lock_guard guard(lock);
+		if(items.size() >= capacity) return false;
+		items.push_back(value);
+		return true;
+	}
+	bool pop(size_t& out) {
+		std::lock_guard guard(lock);
+		if(items.empty()) return false;
+		out = items[0];
+		items.delete_(0);
+		return true;
+	}
+};
+
+// Runs producers and consumers until every item has been passed through the queue, returns millions of items per second
+template<typename Push, typename Pop>
+static double run(size_t producers, size_t consumers, Push push, Pop pop) {
+	std::atomic<size_t> consumed = 0, checksum = 0;
+	std::vector<std::thread> threads;
+	auto start = std::chrono::steady_clock::now();
+	for(size_t p = 0; p < producers; ++p)
+		threads.emplace_back([&] {
+			for(size_t i = 1; i <= items; )
+				if(push(i)) ++i;
+				else std::this_thread::yield();
+		});
+	for(size_t c = 0; c < consumers; ++c)
+		threads.emplace_back([&] {
+			size_t sum = 0;
+			while(consumed.load(std::memory_order_relaxed) < producers * items) {
+				size_t value;
+				if(pop(value)) {
+					sum += value;
+					consumed.fetch_add(1, std::memory_order_relaxed);
+				} else std::this_thread::yield();
+			}
+			checksum += sum;
+		});
+	for(auto& thread: threads)
+		thread.join();
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	if(checksum != producers * (items * (items + 1) / 2)) printf("CHECKSUM MISMATCH\n");
+	return producers * items / seconds / 1e6;
+}
+
+int main() {
+	printf("%-30s %10s %10s %12s\n", "queue", "producers", "consumers", "Mitems/s");
+
+	{
+		fp::spsc_queue<size_t> q(capacity);
+		printf("%-30s %10d %10d %12.2f\n", "fp::spsc_queue", 1, 1, run(1, 1, [&](size_t v) { return q.push(v); }, [&](size_t& v) { return q.pop(v); }));
+	}
+	{
+		// Batches amortize the atomic stores over many elements
+		fp::spsc_queue<size_t> q(capacity);
+		std::atomic<size_t> consumed = 0;
+		auto start = std::chrono::steady_clock::now();
+		std::thread consumer([&] {
+			size_t out[batch];
+			while(consumed.load(std::memory_order_relaxed) < items)
+				if(size_t popped = q.pop_range({out, batch})) consumed += popped;
+				else std::this_thread::yield();
+		});
+		size_t in[batch];
+		for(size_t i = 0; i < items; ) {
+			size_t count = std::min(batch, items - i);
+			for(size_t j = 0; j < count; ++j) in[j] = i + j;
+			if(size_t pushed = q.push_range({in, count})) i += pushed;
+			else std::this_thread::yield();
+		}
+		consumer.join();
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		printf("%-30s %10d %10d %12.2f\n", "fp::spsc_queue (batches of 64)", 1, 1, items / seconds / 1e6);
+	}
+
+	size_t hardware = std::max<size_t>(std::thread::hardware_concurrency() / 2, 1);
+	for(size_t threads = 1; threads <= hardware; threads *= 2) {
+		fp::mpmc_queue<size_t> q(capacity);
+		printf("%-30s %10zu %10zu %12.2f\n", "fp::mpmc_queue", threads, threads, run(threads, threads, [&](size_t v) { return q.push(v); }, [&](size_t& v) { return q.pop(v); }));
+		locked_queue locked;
+		printf("%-30s %10zu %10zu %12.2f\n", "mutex + dynarray", threads, threads, run(threads, threads, [&](size_t v) { return locked.push(v); }, [&](size_t& v) { return locked.pop(v); }));
+	}
+	return 0;
+}
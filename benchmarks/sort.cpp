@@ -0,0 +1,61 @@
+// Compares the sorts in sort.h / sort.hpp against std::sort (and qsort) on a few input distributions
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <random>
+
+#define FP_IMPLEMENTATION
+#include <fp/dynarray.hpp>
+#include <fp/sort.hpp>
+
+constexpr size_t count = 10000000;
+
+static int compare_u32(void*, const void* a, const void* b) noexcept {
+	uint32_t x = *(const uint32_t*)a, y = *(const uint32_t*)b;
+	return (x > y) - (x < y);
+}
+static int qsort_compare_u32(const void* a, const void* b) { return compare_u32(nullptr, a, b); }
+
+template<typename T, typename F>
+static void measure(const char* name, const fp::raii::dynarray<T>& input, F sort) {
+	fp::raii::dynarray<T> data = input;
+	auto start = std::chrono::steady_clock::now();
+	sort(data.full_view());
+	double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	bool sorted = std::is_sorted(data.begin(), data.end());
+	printf("  %-28s %10.2f ms%s\n", name, ms, sorted ? "" : " (NOT SORTED)");
+}
+
+template<typename T>
+static void measure_all(const char* distribution, const fp::raii::dynarray<T>& input) {
+	printf("%s (%zu elements of %zu bytes)\n", distribution, input.size(), sizeof(T));
+	measure("std::sort", input, [](fp::view<T> v) { std::sort(v.begin(), v.end()); });
+	measure("fp::sort", input, [](fp::view<T> v) { fp::sort(v); });
+	measure("fp::radix_sort", input, [](fp::view<T> v) { fp::radix_sort(v); });
+	if constexpr(std::is_same_v<T, uint32_t>) {
+		measure("fp_view_sort (C comparator)", input, [](fp::view<T> v) { fp_view_sort(T, v, compare_u32, nullptr); });
+		measure("qsort", input, [](fp::view<T> v) { qsort(v.data(), v.size(), sizeof(T), qsort_compare_u32); });
+	}
+}
+
+int main() {
+	std::mt19937_64 rng(42);
+	fp::raii::dynarray<uint32_t> random, sorted, few_unique;
+	fp::raii::dynarray<double> doubles;
+	random.reserve(count); sorted.reserve(count); few_unique.reserve(count); doubles.reserve(count);
+	for(size_t i = 0; i < count; ++i) {
+		random.push_back((uint32_t)rng());
+		sorted.push_back((uint32_t)i);
+		few_unique.push_back((uint32_t)(rng() % 16));
+		doubles.push_back(std::normal_distribution<double>(0, 1000)(rng));
+	}
+
+	measure_all("random uint32_t", random);
+	measure_all("sorted uint32_t", sorted);
+	measure_all("uint32_t with 16 unique values", few_unique);
+	measure_all("normally distributed doubles", doubles);
+	return 0;
+}
@@ -0,0 +1,192 @@
+#ifndef __LIB_FAT_POINTER_ARENA_ALLOCATOR_H__
+#define __LIB_FAT_POINTER_ARENA_ALLOCATOR_H__
+
+#include "../pointer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef FP_ARENA_DEFAULT_CHUNK_SIZE
+#define FP_ARENA_DEFAULT_CHUNK_SIZE (64 * 1024)
+#endif
+
+#ifndef FP_ARENA_ALIGNMENT
+#define FP_ARENA_ALIGNMENT 16
+#endif
+
+// Every allocation is prefixed by its size, padded so that the allocation itself remains aligned
+#define FP_ARENA_PREFIX_SIZE (sizeof(size_t) > FP_ARENA_ALIGNMENT ? sizeof(size_t) : FP_ARENA_ALIGNMENT)
+
+struct __FatArenaChunk {
+	struct __FatArenaChunk* previous;
+	size_t capacity;
+	size_t used;
+	size_t padding; // Keeps data aligned to 16 bytes
+#ifndef __cplusplus
+	uint8_t data[];
+#else
+	uint8_t data[8];
+#endif
+};
+#ifndef __cplusplus
+	#define FP_ARENA_CHUNK_HEADER_SIZE sizeof(struct __FatArenaChunk)
+#else
+	static constexpr size_t FP_ARENA_CHUNK_HEADER_SIZE = sizeof(__FatArenaChunk) - detail::completed_sizeof_v<decltype(__FatArenaChunk{}.data)>;
+#endif
+
+struct fp_arena {
+	struct __FatArenaChunk* current;
+	uint8_t* last; // The most recent allocation, the only one which can be extended or freed in place
+	size_t chunk_size;
+	fp_allocator_id allocator;
+};
+
+inline static size_t __fp_arena_round_up(size_t size) FP_NOEXCEPT {
+	return (size + FP_ARENA_ALIGNMENT - 1) & ~((size_t)FP_ARENA_ALIGNMENT - 1);
+}
+
+inline static size_t* __fp_arena_prefix(const void* p) FP_NOEXCEPT {
+	return (size_t*)(((uint8_t*)p) - FP_ARENA_PREFIX_SIZE);
+}
+
+inline static bool __fp_arena_is_last(struct fp_arena* arena, const void* p) FP_NOEXCEPT {
+	return arena->last != NULL && arena->last == (uint8_t*)p;
+}
+
+void* __fp_arena_bump(struct fp_arena* arena, size_t size) FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+	size_t needed = __fp_arena_round_up(FP_ARENA_PREFIX_SIZE + size);
+	struct __FatArenaChunk* chunk = arena->current;
+	if(chunk == NULL || chunk->used + needed > chunk->capacity) {
+		size_t capacity = needed > arena->chunk_size ? needed : arena->chunk_size;
+		chunk = (struct __FatArenaChunk*)FP_ALLOCATION_FUNCTION(NULL, FP_ARENA_CHUNK_HEADER_SIZE + capacity);
+		if(!chunk) return NULL;
+		chunk->previous = arena->current;
+		chunk->capacity = capacity;
+		chunk->used = 0;
+		arena->current = chunk;
+	}
+
+	uint8_t* p = chunk->data + chunk->used + FP_ARENA_PREFIX_SIZE;
+	chunk->used += needed;
+	*__fp_arena_prefix(p) = size;
+	arena->last = p;
+	return p;
+}
+#else
+;
+#endif
+
+/**
+* @brief Allocation function for arenas, follows the same semantics as FP_ALLOCATION_FUNCTION
+* @note Only the most recent allocation can be grown or released in place, freeing anything else is a no-op (the memory is reclaimed by fp_arena_reset)
+*/
+void* __fp_arena_allocate(void* userdata, void* p, size_t size) FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+	struct fp_arena* arena = (struct fp_arena*)userdata;
+	if(p == NULL) return size == 0 ? NULL : __fp_arena_bump(arena, size);
+
+	if(__fp_arena_is_last(arena, p)) {
+		struct __FatArenaChunk* chunk = arena->current;
+		size_t start = ((uint8_t*)p) - chunk->data - FP_ARENA_PREFIX_SIZE;
+		if(size == 0) { // Pop the allocation off the top of the arena
+			chunk->used = start;
+			arena->last = NULL;
+			return NULL;
+		}
+
+		size_t needed = __fp_arena_round_up(FP_ARENA_PREFIX_SIZE + size);
+		if(start + needed <= chunk->capacity) { // Extend (or shrink) in place
+			chunk->used = start + needed;
+			*__fp_arena_prefix(p) = size;
+			return p;
+		}
+	}
+	if(size == 0) return NULL;
+
+	size_t old_size = *__fp_arena_prefix(p);
+	if(size <= old_size) {
+		*__fp_arena_prefix(p) = size;
+		return p;
+	}
+
+	void* out = __fp_arena_bump(arena, size);
+	if(out) memcpy(out, p, old_size);
+	return out;
+}
+#else
+;
+#endif
+
+/**
+* @brief Creates a new arena and registers it as an allocator
+* @param chunk_size the number of bytes to reserve each time the arena runs out of space (0 uses FP_ARENA_DEFAULT_CHUNK_SIZE)
+* @return the new arena (or null if it couldn't be allocated or registered), use fp_arena_allocator to allocate fat pointers in it
+*/
+struct fp_arena* fp_arena_create(size_t chunk_size) FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+	struct fp_arena* arena = (struct fp_arena*)FP_ALLOCATION_FUNCTION(NULL, sizeof(struct fp_arena));
+	if(!arena) return NULL;
+	arena->current = NULL;
+	arena->last = NULL;
+	arena->chunk_size = chunk_size ? chunk_size : FP_ARENA_DEFAULT_CHUNK_SIZE;
+
+	struct fp_allocator allocator = {__fp_arena_allocate, arena};
+	arena->allocator = fp_allocator_register(allocator);
+	if(arena->allocator == FP_DEFAULT_ALLOCATOR) {
+		FP_ALLOCATION_FUNCTION(arena, 0);
+		return NULL;
+	}
+	return arena;
+}
+#else
+;
+#endif
+
+inline static fp_allocator_id fp_arena_allocator(const struct fp_arena* arena) FP_NOEXCEPT { return arena->allocator; }
+
+inline static size_t fp_arena_bytes_used(const struct fp_arena* arena) FP_NOEXCEPT {
+	size_t sum = 0;
+	for(struct __FatArenaChunk* chunk = arena->current; chunk; chunk = chunk->previous)
+		sum += chunk->used;
+	return sum;
+}
+
+inline static void __fp_arena_free_chunks(struct __FatArenaChunk* chunk) FP_NOEXCEPT {
+	while(chunk) {
+		struct __FatArenaChunk* previous = chunk->previous;
+		FP_ALLOCATION_FUNCTION(chunk, 0);
+		chunk = previous;
+	}
+}
+
+/**
+* @brief Releases every allocation made in the arena at once
+* @note The most recent chunk is kept around to be reused by future allocations
+*/
+inline static void fp_arena_reset(struct fp_arena* arena) FP_NOEXCEPT {
+	if(arena->current == NULL) return;
+	__fp_arena_free_chunks(arena->current->previous);
+	arena->current->previous = NULL;
+	arena->current->used = 0;
+	arena->last = NULL;
+}
+
+// Releases every allocation made in the arena, unregisters it, and frees the arena itself
+inline static void fp_arena_destroy(struct fp_arena* arena) FP_NOEXCEPT {
+	if(arena == NULL) return;
+	__fp_arena_free_chunks(arena->current);
+	fp_allocator_unregister(arena->allocator);
+	FP_ALLOCATION_FUNCTION(arena, 0);
+}
+#define fp_arena_destroy_and_null(arena) (fp_arena_destroy(arena), arena = NULL)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __LIB_FAT_POINTER_ARENA_ALLOCATOR_H__
@@ -0,0 +1,136 @@
+#ifndef __LIB_FAT_POINTER_MMAP_ALLOCATOR_H__
+#define __LIB_FAT_POINTER_MMAP_ALLOCATOR_H__
+
+// NOTE: This header sits underneath pointer.h (it is included by it on POSIX platforms unless FP_DISABLE_MMAP is defined) so it can't depend on it
+// NOTE: Growing mappings without copying relies on mremap, which glibc only declares when _GNU_SOURCE is defined before any system header
+//	(other platforms fall back on mapping, copying, and unmapping)
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#define FP_HAS_MMAP
+
+#if !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+	#define MAP_ANONYMOUS MAP_ANON
+#endif
+
+#ifndef FP_NOEXCEPT
+	#ifdef __cplusplus
+		#define FP_NOEXCEPT noexcept
+	#else
+		#define FP_NOEXCEPT
+	#endif
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Allocations from the default allocator at least this large are automatically mapped
+#ifndef FP_MMAP_THRESHOLD
+#define FP_MMAP_THRESHOLD (64 * 1024 * 1024)
+#endif
+
+#define FP_MMAP_PREFIX_SIZE 16 // Every mapping is prefixed by its length, padded so that the allocation remains aligned
+
+struct fp_mmap_options {
+	size_t threshold; // 0 disables automatically mapping large allocations
+	bool huge_pages; // Ask for transparent huge pages (MADV_HUGEPAGE) where available
+	bool populate; // Prefault the pages of new mappings (MAP_POPULATE) where available
+};
+
+// Options used by every mapped allocation, may be modified at any time (though not concurrently with allocations)
+struct fp_mmap_options* fp_mmap_options() FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+	static struct fp_mmap_options options = {FP_MMAP_THRESHOLD, true, false};
+	return &options;
+}
+#else
+;
+#endif
+
+inline static size_t __fp_mmap_round_to_pages(size_t size) FP_NOEXCEPT {
+	size_t page = (size_t)sysconf(_SC_PAGESIZE);
+	return (size + page - 1) & ~(page - 1);
+}
+
+inline static size_t* __fp_mmap_prefix(const void* p) FP_NOEXCEPT {
+	return (size_t*)(((uint8_t*)p) - FP_MMAP_PREFIX_SIZE);
+}
+
+inline static void __fp_mmap_advise(void* base, size_t length) FP_NOEXCEPT {
+#ifdef MADV_HUGEPAGE
+	if(fp_mmap_options()->huge_pages) madvise(base, length, MADV_HUGEPAGE);
+#endif
+	(void)base; (void)length;
+}
+
+inline static void* __fp_mmap_map(size_t size) FP_NOEXCEPT {
+	size_t length = __fp_mmap_round_to_pages(FP_MMAP_PREFIX_SIZE + size);
+	int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#ifdef MAP_POPULATE
+	if(fp_mmap_options()->populate) flags |= MAP_POPULATE;
+#endif
+	uint8_t* base = (uint8_t*)mmap(NULL, length, PROT_READ | PROT_WRITE, flags, -1, 0);
+	if(base == (uint8_t*)MAP_FAILED) return NULL;
+	__fp_mmap_advise(base, length);
+
+	*(size_t*)base = length;
+	return base + FP_MMAP_PREFIX_SIZE;
+}
+
+/**
+* @brief Allocation function backed directly by anonymous memory mappings, follows the same semantics as FP_ALLOCATION_FUNCTION
+* @note Growing a mapping remaps its pages (on Linux) rather than copying them, and shrinking releases the unused pages
+*/
+void* __fp_mmap_allocate(void* userdata, void* p, size_t size) FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+	(void)userdata;
+	if(p == NULL) return size == 0 ? NULL : __fp_mmap_map(size);
+
+	uint8_t* base = (uint8_t*)__fp_mmap_prefix(p);
+	size_t length = *(size_t*)base;
+	if(size == 0) {
+		munmap(base, length);
+		return NULL;
+	}
+
+	size_t new_length = __fp_mmap_round_to_pages(FP_MMAP_PREFIX_SIZE + size);
+	if(new_length <= length) {
+		if(new_length < length) munmap(base + new_length, length - new_length);
+		*(size_t*)base = new_length;
+		return p;
+	}
+
+#if defined(__linux__) && defined(MREMAP_MAYMOVE)
+	uint8_t* out = (uint8_t*)mremap(base, length, new_length, MREMAP_MAYMOVE);
+	if(out == (uint8_t*)MAP_FAILED) return NULL;
+	__fp_mmap_advise(out, new_length);
+	*(size_t*)out = new_length;
+	return out + FP_MMAP_PREFIX_SIZE;
+#else
+	uint8_t* out = (uint8_t*)__fp_mmap_map(size);
+	if(!out) return NULL;
+	memcpy(out, p, length - FP_MMAP_PREFIX_SIZE);
+	munmap(base, length);
+	return out;
+#endif
+}
+#else
+;
+#endif
+
+// Counts the bytes actually mapped for an allocation made by __fp_mmap_allocate
+inline static size_t __fp_mmap_mapped_size(const void* p) FP_NOEXCEPT { return *__fp_mmap_prefix(p); }
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __LIB_FAT_POINTER_MMAP_ALLOCATOR_H__
@@ -0,0 +1,214 @@
+#ifndef __LIB_FAT_POINTER_SLAB_ALLOCATOR_H__
+#define __LIB_FAT_POINTER_SLAB_ALLOCATOR_H__
+
+#include "../dynarray.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Size classes hold power of two payloads (matching the capacities dynarrays grow through) plus room for the fat pointer headers
+#ifndef FP_SLAB_MIN_PAYLOAD
+#define FP_SLAB_MIN_PAYLOAD FPDA_DEFAULT_SIZE_BYTES
+#endif
+
+#ifndef FP_SLAB_MAX_PAYLOAD
+#define FP_SLAB_MAX_PAYLOAD 4096
+#endif
+
+#ifndef FP_SLAB_PAGE_SIZE
+#define FP_SLAB_PAGE_SIZE (64 * 1024)
+#endif
+
+#define FP_SLAB_CLASS_COUNT 16 // Enough classes for FP_SLAB_MAX_PAYLOAD / FP_SLAB_MIN_PAYLOAD <= 2^15
+#define FP_SLAB_LARGE_CLASS ((size_t)-1) // Marks allocations too big for any size class, these are forwarded to FP_ALLOCATION_FUNCTION
+#define FP_SLAB_PREFIX_SIZE 16 // Every block is prefixed by its size class, padded so that the block remains aligned
+#define FP_SLAB_OVERHEAD (FP_HEADER_SIZE + 1 + FPDA_HEADER_SIZE + 1) // Bytes a dynarray adds on top of its payload (both headers add a null terminator)
+
+struct __FatSlabPage {
+	struct __FatSlabPage* next;
+	size_t padding; // Keeps data aligned to 16 bytes
+#ifndef __cplusplus
+	uint8_t data[];
+#else
+	uint8_t data[8];
+#endif
+};
+#ifndef __cplusplus
+	#define FP_SLAB_PAGE_HEADER_SIZE sizeof(struct __FatSlabPage)
+#else
+	static constexpr size_t FP_SLAB_PAGE_HEADER_SIZE = sizeof(__FatSlabPage) - detail::completed_sizeof_v<decltype(__FatSlabPage{}.data)>;
+#endif
+
+struct fp_slab {
+	void* free_lists[FP_SLAB_CLASS_COUNT]; // Singly linked lists threaded through the free blocks themselves
+	struct __FatSlabPage* pages;
+	fp_allocator_id allocator;
+};
+
+inline static size_t __fp_slab_class_payload(size_t size_class) FP_NOEXCEPT { return ((size_t)FP_SLAB_MIN_PAYLOAD) << size_class; }
+
+inline static size_t __fp_slab_class_block_size(size_t size_class) FP_NOEXCEPT {
+	size_t size = FP_SLAB_PREFIX_SIZE + FP_SLAB_OVERHEAD + __fp_slab_class_payload(size_class);
+	return (size + 15) & ~(size_t)15;
+}
+
+inline static size_t __fp_slab_class_of(size_t size) FP_NOEXCEPT {
+	size_t payload = size > FP_SLAB_OVERHEAD ? size - FP_SLAB_OVERHEAD : 1;
+	if(payload > FP_SLAB_MAX_PAYLOAD) return FP_SLAB_LARGE_CLASS;
+
+	size_t size_class = 0;
+	for(size_t rounded = fp_upper_power_of_two(payload); rounded > FP_SLAB_MIN_PAYLOAD; rounded >>= 1)
+		++size_class;
+	assert(size_class < FP_SLAB_CLASS_COUNT);
+	return size_class;
+}
+
+inline static size_t* __fp_slab_prefix(const void* p) FP_NOEXCEPT {
+	return (size_t*)(((uint8_t*)p) - FP_SLAB_PREFIX_SIZE);
+}
+
+// Carves a new page into blocks of the given size class and threads them onto its free list
+bool __fp_slab_refill(struct fp_slab* slab, size_t size_class) FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+	size_t block_size = __fp_slab_class_block_size(size_class);
+	size_t count = FP_SLAB_PAGE_SIZE / block_size;
+	if(count < 8) count = 8;
+
+	struct __FatSlabPage* page = (struct __FatSlabPage*)FP_ALLOCATION_FUNCTION(NULL, FP_SLAB_PAGE_HEADER_SIZE + count * block_size);
+	if(!page) return false;
+	page->next = slab->pages;
+	slab->pages = page;
+
+	for(size_t i = count; i--; ) {
+		uint8_t* block = page->data + i * block_size + FP_SLAB_PREFIX_SIZE;
+		*__fp_slab_prefix(block) = size_class;
+		*(void**)block = slab->free_lists[size_class];
+		slab->free_lists[size_class] = block;
+	}
+	return true;
+}
+#else
+;
+#endif
+
+inline static void* __fp_slab_pop(struct fp_slab* slab, size_t size) FP_NOEXCEPT {
+	size_t size_class = __fp_slab_class_of(size);
+	if(size_class == FP_SLAB_LARGE_CLASS) {
+		uint8_t* p = (uint8_t*)FP_ALLOCATION_FUNCTION(NULL, FP_SLAB_PREFIX_SIZE + size);
+		if(!p) return NULL;
+		p += FP_SLAB_PREFIX_SIZE;
+		*__fp_slab_prefix(p) = FP_SLAB_LARGE_CLASS;
+		return p;
+	}
+
+	if(slab->free_lists[size_class] == NULL && !__fp_slab_refill(slab, size_class)) return NULL;
+	void* p = slab->free_lists[size_class];
+	slab->free_lists[size_class] = *(void**)p;
+	return p;
+}
+
+inline static void __fp_slab_push(struct fp_slab* slab, void* p) FP_NOEXCEPT {
+	size_t size_class = *__fp_slab_prefix(p);
+	if(size_class == FP_SLAB_LARGE_CLASS) {
+		FP_ALLOCATION_FUNCTION(__fp_slab_prefix(p), 0);
+		return;
+	}
+
+	*(void**)p = slab->free_lists[size_class];
+	slab->free_lists[size_class] = p;
+}
+
+/**
+* @brief Allocation function for slabs, follows the same semantics as FP_ALLOCATION_FUNCTION
+* @note Reallocations which stay within the same size class are performed in place
+*/
+void* __fp_slab_allocate(void* userdata, void* p, size_t size) FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+	struct fp_slab* slab = (struct fp_slab*)userdata;
+	if(size == 0) {
+		if(p) __fp_slab_push(slab, p);
+		return NULL;
+	}
+	if(p == NULL) return __fp_slab_pop(slab, size);
+
+	size_t old_class = *__fp_slab_prefix(p);
+	if(old_class != FP_SLAB_LARGE_CLASS && old_class == __fp_slab_class_of(size))
+		return p;
+	if(old_class == FP_SLAB_LARGE_CLASS && __fp_slab_class_of(size) == FP_SLAB_LARGE_CLASS) {
+		uint8_t* out = (uint8_t*)FP_ALLOCATION_FUNCTION(__fp_slab_prefix(p), FP_SLAB_PREFIX_SIZE + size);
+		return out ? out + FP_SLAB_PREFIX_SIZE : NULL;
+	}
+
+	void* out = __fp_slab_pop(slab, size);
+	if(!out) return NULL;
+	// NOTE: Large blocks are bigger than every size class, so when shrinking out of one the new size bounds the copy
+	size_t old_payload = old_class == FP_SLAB_LARGE_CLASS ? size : __fp_slab_class_block_size(old_class) - FP_SLAB_PREFIX_SIZE;
+	memcpy(out, p, old_payload < size ? old_payload : size);
+	__fp_slab_push(slab, p);
+	return out;
+}
+#else
+;
+#endif
+
+/**
+* @brief Creates a new slab allocator and registers it
+* @note Slabs are not thread safe, each slab should only be used from one thread at a time
+* @return the new slab (or null if it couldn't be allocated or registered), use fp_slab_allocator to allocate fat pointers in it
+*/
+struct fp_slab* fp_slab_create() FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+	struct fp_slab* slab = (struct fp_slab*)FP_ALLOCATION_FUNCTION(NULL, sizeof(struct fp_slab));
+	if(!slab) return NULL;
+	memset(slab, 0, sizeof(struct fp_slab));
+
+	struct fp_allocator allocator = {__fp_slab_allocate, slab};
+	slab->allocator = fp_allocator_register(allocator);
+	if(slab->allocator == FP_DEFAULT_ALLOCATOR) {
+		FP_ALLOCATION_FUNCTION(slab, 0);
+		return NULL;
+	}
+	return slab;
+}
+#else
+;
+#endif
+
+inline static fp_allocator_id fp_slab_allocator(const struct fp_slab* slab) FP_NOEXCEPT { return slab->allocator; }
+
+// Counts how many blocks of the size class which would serve an allocation of \p size bytes are ready to be reused
+inline static size_t fp_slab_free_count(const struct fp_slab* slab, size_t size) FP_NOEXCEPT {
+	size_t size_class = __fp_slab_class_of(size);
+	if(size_class == FP_SLAB_LARGE_CLASS) return 0;
+
+	size_t count = 0;
+	for(void* block = slab->free_lists[size_class]; block; block = *(void**)block)
+		++count;
+	return count;
+}
+
+/**
+* @brief Releases every page owned by the slab, unregisters it, and frees the slab itself
+* @note Allocations too large for any size class are not tracked and should be freed before the slab is destroyed
+*/
+inline static void fp_slab_destroy(struct fp_slab* slab) FP_NOEXCEPT {
+	if(slab == NULL) return;
+	for(struct __FatSlabPage* page = slab->pages; page; ) {
+		struct __FatSlabPage* next = page->next;
+		FP_ALLOCATION_FUNCTION(page, 0);
+		page = next;
+	}
+	fp_allocator_unregister(slab->allocator);
+	FP_ALLOCATION_FUNCTION(slab, 0);
+}
+#define fp_slab_destroy_and_null(slab) (fp_slab_destroy(slab), slab = NULL)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __LIB_FAT_POINTER_SLAB_ALLOCATOR_H__
@@ -0,0 +1,295 @@
+#ifndef __LIB_FAT_POINTER_THREAD_CACHE_ALLOCATOR_H__
+#define __LIB_FAT_POINTER_THREAD_CACHE_ALLOCATOR_H__
+
+// NOTE: This header sits underneath pointer.h (it is included by it when FP_ENABLE_THREAD_CACHE is defined) so it can't depend on it
+
+#include "../atomic.h"
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+	#include <pthread.h>
+	#define FP_THREAD_CACHE_PTHREAD_CLEANUP // Thread caches are automatically flushed when their thread exits
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef FP_THREAD_CACHE_MAX_SIZE
+#define FP_THREAD_CACHE_MAX_SIZE (32 * 1024)
+#endif
+
+#ifndef FP_THREAD_CACHE_MAGAZINE_SIZE
+#define FP_THREAD_CACHE_MAGAZINE_SIZE 32
+#endif
+
+// The number of free blocks (per size class) the shared pool holds onto before handing them back to the system
+#ifndef FP_THREAD_CACHE_POOL_LIMIT
+#define FP_THREAD_CACHE_POOL_LIMIT 1024
+#endif
+
+#define FP_THREAD_CACHE_MIN_SIZE 32
+#define FP_THREAD_CACHE_CLASS_COUNT 16 // Enough classes for FP_THREAD_CACHE_MAX_SIZE / FP_THREAD_CACHE_MIN_SIZE <= 2^15
+#define FP_THREAD_CACHE_LARGE_CLASS ((size_t)-1) // Marks allocations too big for any size class, these go straight to the system
+#define FP_THREAD_CACHE_PREFIX_SIZE 16 // Every block is prefixed by its size class, padded so that the block remains aligned
+#define FP_THREAD_CACHE_BATCH_SIZE (FP_THREAD_CACHE_MAGAZINE_SIZE / 2) // Blocks are moved between magazines and the shared pool in batches
+
+struct __FatThreadCacheMagazine {
+	size_t count;
+	void* blocks[FP_THREAD_CACHE_MAGAZINE_SIZE];
+};
+
+struct __FatThreadCache {
+	bool initialized;
+	struct __FatThreadCacheMagazine magazines[FP_THREAD_CACHE_CLASS_COUNT];
+};
+
+struct __FatThreadCachePool {
+	fp_spinlock lock;
+	size_t count;
+	void* head; // Singly linked list threaded through the free blocks themselves
+	uint8_t padding[FP_CACHE_LINE_SIZE - 2 * sizeof(size_t) - sizeof(void*)]; // Rounds each pool up to a whole cache line
+};
+
+inline static size_t __fp_thread_cache_class_size(size_t size_class) FP_NOEXCEPT { return ((size_t)FP_THREAD_CACHE_MIN_SIZE) << size_class; }
+
+inline static size_t __fp_thread_cache_class_of(size_t size) FP_NOEXCEPT {
+	size_t total = FP_THREAD_CACHE_PREFIX_SIZE + size;
+	if(total > FP_THREAD_CACHE_MAX_SIZE) return FP_THREAD_CACHE_LARGE_CLASS;
+
+	size_t size_class = 0;
+	while(__fp_thread_cache_class_size(size_class) < total)
+		++size_class;
+	assert(size_class < FP_THREAD_CACHE_CLASS_COUNT);
+	return size_class;
+}
+
+inline static size_t* __fp_thread_cache_prefix(const void* p) FP_NOEXCEPT {
+	return (size_t*)(((uint8_t*)p) - FP_THREAD_CACHE_PREFIX_SIZE);
+}
+
+struct __FatThreadCachePool* __fp_thread_cache_pools() FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+	FP_CACHE_LINE_ALIGNED static struct __FatThreadCachePool pools[FP_THREAD_CACHE_CLASS_COUNT]; // Together with the padding, gives every pool its own cache line
+	return pools;
+}
+#else
+;
+#endif
+
+// Moves the first \p count blocks of the magazine into the shared pool (or back to the system if the pool is full)
+inline static void __fp_thread_cache_return_batch(struct __FatThreadCacheMagazine* magazine, size_t size_class, size_t count) FP_NOEXCEPT {
+	struct __FatThreadCachePool* pool = __fp_thread_cache_pools() + size_class;
+	if(count == 0) return;
+
+	// Link the batch together before taking the lock, so that the critical section is just a splice
+	for(size_t i = 0; i < count - 1; ++i)
+		*(void**)magazine->blocks[i] = magazine->blocks[i + 1];
+
+	fp_spinlock_lock(&pool->lock);
+	bool release = pool->count + count > FP_THREAD_CACHE_POOL_LIMIT;
+	if(!release) {
+		*(void**)magazine->blocks[count - 1] = pool->head;
+		pool->head = magazine->blocks[0];
+		pool->count += count;
+	}
+	fp_spinlock_unlock(&pool->lock);
+
+	if(release) for(size_t i = 0; i < count; ++i)
+		free(__fp_thread_cache_prefix(magazine->blocks[i]));
+
+	magazine->count -= count;
+	memmove(magazine->blocks, magazine->blocks + count, magazine->count * sizeof(void*));
+}
+
+// Refills an empty magazine with up to a batch of blocks from the shared pool
+inline static void __fp_thread_cache_take_batch(struct __FatThreadCacheMagazine* magazine, size_t size_class) FP_NOEXCEPT {
+	struct __FatThreadCachePool* pool = __fp_thread_cache_pools() + size_class;
+	fp_spinlock_lock(&pool->lock);
+	while(magazine->count < FP_THREAD_CACHE_BATCH_SIZE && pool->head) {
+		magazine->blocks[magazine->count++] = pool->head;
+		pool->head = *(void**)pool->head;
+		--pool->count;
+	}
+	fp_spinlock_unlock(&pool->lock);
+}
+
+/**
+* @brief Flushes every block cached by the given thread cache into the shared pool
+* @note Called automatically when a thread exits on platforms with pthreads
+*/
+void __fp_thread_cache_flush(struct __FatThreadCache* cache) FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+	for(size_t size_class = 0; size_class < FP_THREAD_CACHE_CLASS_COUNT; ++size_class)
+		__fp_thread_cache_return_batch(cache->magazines + size_class, size_class, cache->magazines[size_class].count);
+}
+#else
+;
+#endif
+
+#ifdef FP_THREAD_CACHE_PTHREAD_CLEANUP
+inline static void __fp_thread_cache_destructor(void* cache) FP_NOEXCEPT {
+	__fp_thread_cache_flush((struct __FatThreadCache*)cache);
+}
+
+pthread_key_t* __fp_thread_cache_key_storage() FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+	static pthread_key_t key;
+	return &key;
+}
+#else
+;
+#endif
+
+inline static void __fp_thread_cache_create_key() FP_NOEXCEPT {
+	pthread_key_create(__fp_thread_cache_key_storage(), __fp_thread_cache_destructor);
+}
+
+pthread_key_t __fp_thread_cache_key() FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+	static pthread_once_t once = PTHREAD_ONCE_INIT;
+	pthread_once(&once, __fp_thread_cache_create_key);
+	return *__fp_thread_cache_key_storage();
+}
+#else
+;
+#endif
+#endif
+
+struct __FatThreadCache* __fp_thread_cache() FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+	static thread_local struct __FatThreadCache cache;
+	if(!cache.initialized) {
+		cache.initialized = true;
+#ifdef FP_THREAD_CACHE_PTHREAD_CLEANUP
+		pthread_setspecific(__fp_thread_cache_key(), &cache);
+#endif
+	}
+	return &cache;
+}
+#else
+;
+#endif
+
+inline static void* __fp_thread_cache_acquire(size_t size) FP_NOEXCEPT {
+	size_t size_class = __fp_thread_cache_class_of(size);
+	if(size_class == FP_THREAD_CACHE_LARGE_CLASS) {
+		uint8_t* p = (uint8_t*)malloc(FP_THREAD_CACHE_PREFIX_SIZE + size);
+		if(!p) return NULL;
+		p += FP_THREAD_CACHE_PREFIX_SIZE;
+		*__fp_thread_cache_prefix(p) = FP_THREAD_CACHE_LARGE_CLASS;
+		return p;
+	}
+
+	struct __FatThreadCacheMagazine* magazine = __fp_thread_cache()->magazines + size_class;
+	if(magazine->count == 0) __fp_thread_cache_take_batch(magazine, size_class);
+	if(magazine->count > 0) return magazine->blocks[--magazine->count];
+
+	uint8_t* p = (uint8_t*)malloc(__fp_thread_cache_class_size(size_class));
+	if(!p) return NULL;
+	p += FP_THREAD_CACHE_PREFIX_SIZE;
+	*__fp_thread_cache_prefix(p) = size_class;
+	return p;
+}
+
+// NOTE: Blocks don't remember which thread allocated them, so a block freed on another thread simply joins that thread's cache
+inline static void __fp_thread_cache_release(void* p) FP_NOEXCEPT {
+	size_t size_class = *__fp_thread_cache_prefix(p);
+	if(size_class == FP_THREAD_CACHE_LARGE_CLASS) {
+		free(__fp_thread_cache_prefix(p));
+		return;
+	}
+
+	struct __FatThreadCacheMagazine* magazine = __fp_thread_cache()->magazines + size_class;
+	if(magazine->count == FP_THREAD_CACHE_MAGAZINE_SIZE)
+		__fp_thread_cache_return_batch(magazine, size_class, FP_THREAD_CACHE_BATCH_SIZE);
+	magazine->blocks[magazine->count++] = p;
+}
+
+/**
+* @brief Allocation function which keeps per-thread caches of recently freed blocks, follows the same semantics as FP_ALLOCATION_FUNCTION
+* @note Defining FP_ENABLE_THREAD_CACHE makes this the default FP_ALLOCATION_FUNCTION
+* @note Memory may be freed on a different thread from the one which allocated it
+* @note Reallocations which stay within the same size class are performed in place
+*/
+void* fp_thread_cache_allocate(void* p, size_t size) FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+	if(size == 0) {
+		if(p) __fp_thread_cache_release(p);
+		return NULL;
+	}
+	if(p == NULL) return __fp_thread_cache_acquire(size);
+
+	size_t old_class = *__fp_thread_cache_prefix(p);
+	size_t new_class = __fp_thread_cache_class_of(size);
+	if(old_class != FP_THREAD_CACHE_LARGE_CLASS && old_class == new_class)
+		return p;
+	if(old_class == FP_THREAD_CACHE_LARGE_CLASS && new_class == FP_THREAD_CACHE_LARGE_CLASS) {
+		uint8_t* out = (uint8_t*)realloc(__fp_thread_cache_prefix(p), FP_THREAD_CACHE_PREFIX_SIZE + size);
+		return out ? out + FP_THREAD_CACHE_PREFIX_SIZE : NULL;
+	}
+
+	void* out = __fp_thread_cache_acquire(size);
+	if(!out) return NULL;
+	// NOTE: Large blocks are bigger than every size class, so when shrinking out of one the new size bounds the copy
+	size_t old_size = old_class == FP_THREAD_CACHE_LARGE_CLASS ? size : __fp_thread_cache_class_size(old_class) - FP_THREAD_CACHE_PREFIX_SIZE;
+	memcpy(out, p, old_size < size ? old_size : size);
+	__fp_thread_cache_release(p);
+	return out;
+}
+#else
+;
+#endif
+
+// Hands every block cached by the calling thread back to the shared pool
+inline static void fp_thread_cache_flush() FP_NOEXCEPT {
+	__fp_thread_cache_flush(__fp_thread_cache());
+}
+
+// Returns every block held by the shared pool to the system (blocks still cached by other threads are unaffected)
+inline static void fp_thread_cache_trim() FP_NOEXCEPT {
+	for(size_t size_class = 0; size_class < FP_THREAD_CACHE_CLASS_COUNT; ++size_class) {
+		struct __FatThreadCachePool* pool = __fp_thread_cache_pools() + size_class;
+		fp_spinlock_lock(&pool->lock);
+		void* head = pool->head;
+		pool->head = NULL;
+		pool->count = 0;
+		fp_spinlock_unlock(&pool->lock);
+
+		while(head) {
+			void* next = *(void**)head;
+			free(__fp_thread_cache_prefix(head));
+			head = next;
+		}
+	}
+}
+
+// Counts the blocks of the size class which would serve an allocation of \p size bytes that are waiting in the shared pool
+inline static size_t fp_thread_cache_pool_count(size_t size) FP_NOEXCEPT {
+	size_t size_class = __fp_thread_cache_class_of(size);
+	if(size_class == FP_THREAD_CACHE_LARGE_CLASS) return 0;
+
+	struct __FatThreadCachePool* pool = __fp_thread_cache_pools() + size_class;
+	fp_spinlock_lock(&pool->lock);
+	size_t count = pool->count;
+	fp_spinlock_unlock(&pool->lock);
+	return count;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __LIB_FAT_POINTER_THREAD_CACHE_ALLOCATOR_H__
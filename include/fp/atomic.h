@@ -0,0 +1,60 @@
+#ifndef __LIB_FAT_POINTER_ATOMIC_H__
+#define __LIB_FAT_POINTER_ATOMIC_H__
+
+// Thin layer over C11 <stdatomic.h> and C++ <atomic> so that the same atomic code can be compiled as either language
+// NOTE: Only lock free integer and pointer types should be wrapped, so that structures keep the same layout in C and C++
+
+#ifdef __cplusplus
+	#include <atomic>
+	#define FP_ATOMIC(type) std::atomic<type>
+	#define FP_MEMORY_ORDER(order) std::memory_order_##order
+	#define __FP_ATOMIC_NAMESPACE std::
+#else
+	#include <stdatomic.h>
+	#define FP_ATOMIC(type) _Atomic(type)
+	#define FP_MEMORY_ORDER(order) memory_order_##order
+	#define __FP_ATOMIC_NAMESPACE
+#endif
+
+#define fp_atomic_init(p, value) __FP_ATOMIC_NAMESPACE atomic_init((p), (value))
+#define fp_atomic_load(p, order) __FP_ATOMIC_NAMESPACE atomic_load_explicit((p), FP_MEMORY_ORDER(order))
+#define fp_atomic_store(p, value, order) __FP_ATOMIC_NAMESPACE atomic_store_explicit((p), (value), FP_MEMORY_ORDER(order))
+#define fp_atomic_exchange(p, value, order) __FP_ATOMIC_NAMESPACE atomic_exchange_explicit((p), (value), FP_MEMORY_ORDER(order))
+#define fp_atomic_fetch_add(p, value, order) __FP_ATOMIC_NAMESPACE atomic_fetch_add_explicit((p), (value), FP_MEMORY_ORDER(order))
+#define fp_atomic_fetch_sub(p, value, order) __FP_ATOMIC_NAMESPACE atomic_fetch_sub_explicit((p), (value), FP_MEMORY_ORDER(order))
+#define fp_atomic_compare_exchange_weak(p, expected, desired, success, failure)\
+	__FP_ATOMIC_NAMESPACE atomic_compare_exchange_weak_explicit((p), (expected), (desired), FP_MEMORY_ORDER(success), FP_MEMORY_ORDER(failure))
+#define fp_atomic_compare_exchange_strong(p, expected, desired, success, failure)\
+	__FP_ATOMIC_NAMESPACE atomic_compare_exchange_strong_explicit((p), (expected), (desired), FP_MEMORY_ORDER(success), FP_MEMORY_ORDER(failure))
+
+#ifndef FP_CACHE_LINE_SIZE
+#define FP_CACHE_LINE_SIZE 64
+#endif
+// Aligns a variable to the start of a cache line
+#ifdef __cplusplus
+	#define FP_CACHE_LINE_ALIGNED alignas(FP_CACHE_LINE_SIZE)
+#else
+	#define FP_CACHE_LINE_ALIGNED _Alignas(FP_CACHE_LINE_SIZE)
+#endif
+
+#ifndef FP_NOEXCEPT
+	#ifdef __cplusplus
+		#define FP_NOEXCEPT noexcept
+	#else
+		#define FP_NOEXCEPT
+	#endif
+#endif
+
+// Minimal spinlock, only suitable for protecting a handful of instructions
+typedef FP_ATOMIC(int) fp_spinlock;
+
+inline static void fp_spinlock_lock(fp_spinlock* lock) FP_NOEXCEPT {
+	while(fp_atomic_exchange(lock, 1, acquire))
+		while(fp_atomic_load(lock, relaxed)); // Wait without hammering the cache line with writes
+}
+
+inline static void fp_spinlock_unlock(fp_spinlock* lock) FP_NOEXCEPT {
+	fp_atomic_store(lock, 0, release);
+}
+
+#endif // __LIB_FAT_POINTER_ATOMIC_H__
@@ -0,0 +1,317 @@
+#ifndef __LIB_FAT_POINTER_BITSET_H__
+#define __LIB_FAT_POINTER_BITSET_H__
+
+#include "dynarray.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// A bitset packs its bits into 64 bit words, the pointer points to the first word
+// Its header mirrors a dynarray's, but the size counts bits (the capacity counts words)
+// NOTE: The bits past the size in the last word are always kept clear, so whole words can be counted and combined
+#define fp_bitset uint64_t*
+
+#define FP_BITSET_WORD_BITS 64
+
+struct __FatBitsetHeader {
+	fp_header_size_t capacity; // In words, NOTE: Must directly precede the fat pointer header (like a dynarray's) so that is_fp works on bitsets
+	struct __FatPointerHeader h; // h.size is the number of bits
+};
+#ifndef __cplusplus
+	#define FP_BITSET_HEADER_SIZE sizeof(struct __FatBitsetHeader)
+#else
+	static constexpr size_t FP_BITSET_HEADER_SIZE = sizeof(__FatBitsetHeader) - detail::completed_sizeof_v<decltype(__FatPointerHeader{}.data)>;
+#endif
+
+inline static struct __FatBitsetHeader* __fp_bitset_header(const void* b) FP_NOEXCEPT {
+	assert(b);
+	return (struct __FatBitsetHeader*)(((uint8_t*)b) - FP_BITSET_HEADER_SIZE);
+}
+
+inline static bool is_fp_bitset(const void* b) FP_NOEXCEPT { return fp_magic_number(b) == FP_BITSET_MAGIC_NUMBER; }
+
+#define fp_bitset_size fp_size
+#define fp_bitset_length fp_length
+#define fp_bitset_empty fp_empty
+inline static size_t fp_bitset_word_count(const uint64_t* b) FP_NOEXCEPT { return (fp_size(b) + FP_BITSET_WORD_BITS - 1) / FP_BITSET_WORD_BITS; }
+// The number of bits the bitset can hold without reallocating
+inline static size_t fp_bitset_capacity(const uint64_t* b) FP_NOEXCEPT { return b ? __fp_bitset_header(b)->capacity * FP_BITSET_WORD_BITS : 0; }
+// The words backing the bitset, so they can be handed to view based (SIMD or parallel) loops
+#define fp_bitset_words(b) fp_view_literal(uint64_t, (b), fp_bitset_word_count(b))
+
+/**
+* @brief Makes sure the bitset can hold at least \p bits bits, creating it in \p allocator if it doesn't exist yet
+* @param exact_sizing when false the number of words is rounded up to a power of two (so repeated pushes are amortized O(1))
+* @note Words gained by growing are left uninitialized
+*/
+inline static struct __FatBitsetHeader* __fp_bitset_reserve_in(uint64_t** b, size_t bits, bool exact_sizing, fp_allocator_id allocator) FP_NOEXCEPT {
+	size_t words = (bits + FP_BITSET_WORD_BITS - 1) / FP_BITSET_WORD_BITS;
+	if(*b && words <= __fp_bitset_header(*b)->capacity) return __fp_bitset_header(*b);
+
+	size_t capacity = words ? words : 1;
+	if(!exact_sizing) capacity = fp_upper_power_of_two(capacity);
+	size_t bytes = FP_BITSET_HEADER_SIZE + sizeof(uint64_t) * capacity;
+	struct __FatBitsetHeader* h;
+	if(*b == NULL) {
+		h = (struct __FatBitsetHeader*)__fp_alloc_aligned_in(NULL, bytes, allocator, sizeof(uint64_t), FP_BITSET_HEADER_SIZE); // Compact headers would leave the words misaligned
+		h->h.magic = FP_BITSET_MAGIC_NUMBER;
+		h->h.allocator = allocator;
+		__fp_header_set_alignment(&h->h, 0, 0);
+		h->h.size = 0;
+	} else {
+		h = __fp_bitset_header(*b);
+#ifdef FP_ENABLE_PROFILING
+		size_t old_capacity = h->capacity;
+#endif
+		h = (struct __FatBitsetHeader*)__fp_alloc_aligned_in(h, bytes, FP_DEFAULT_ALLOCATOR, 0, FP_BITSET_HEADER_SIZE);
+		FP_PROFILE_REALLOCATED_EVENT(FP_PROFILE_GROW, h->h.data, sizeof(uint64_t) * capacity, sizeof(uint64_t) * old_capacity);
+	}
+	h->capacity = capacity;
+	*b = (uint64_t*)h->h.data;
+	return h;
+}
+#define fp_bitset_reserve(b, bits) ((void)FP_PROFILE_SCOPE(void*, __fp_bitset_reserve_in(&(b), (bits), true, FP_DEFAULT_ALLOCATOR)))
+#define fp_bitset_reserve_in(b, bits, allocator) ((void)FP_PROFILE_SCOPE(void*, __fp_bitset_reserve_in(&(b), (bits), true, (allocator))))
+
+// Clears the bits in the last word past the size
+inline static void __fp_bitset_clear_tail(uint64_t* b) FP_NOEXCEPT {
+	size_t used = fp_size(b) % FP_BITSET_WORD_BITS;
+	if(used) b[fp_size(b) / FP_BITSET_WORD_BITS] &= (((uint64_t)1) << used) - 1;
+}
+
+// Sets the number of bits, bits added to the end are set to \p value
+inline static uint64_t* __fp_bitset_resize(uint64_t** b, size_t bits, bool value) FP_NOEXCEPT {
+	if(*b == NULL && bits == 0) return NULL;
+	size_t old_size = fp_size(*b);
+	auto h = __fp_bitset_reserve_in(b, bits, false, FP_DEFAULT_ALLOCATOR);
+	if(bits > old_size) {
+		size_t first = (old_size + FP_BITSET_WORD_BITS - 1) / FP_BITSET_WORD_BITS; // First word which holds none of the old bits
+		size_t last = (bits + FP_BITSET_WORD_BITS - 1) / FP_BITSET_WORD_BITS;
+		if(value && old_size % FP_BITSET_WORD_BITS)
+			(*b)[old_size / FP_BITSET_WORD_BITS] |= ~((((uint64_t)1) << (old_size % FP_BITSET_WORD_BITS)) - 1);
+		memset(*b + first, value ? 0xFF : 0, sizeof(uint64_t) * (last - first));
+	}
+	h->h.size = bits;
+	__fp_bitset_clear_tail(*b);
+	return *b;
+}
+#define fp_bitset_resize(b, bits) FP_PROFILE_SCOPE(uint64_t*, __fp_bitset_resize(&(b), (bits), false))
+#define fp_bitset_resize_value(b, bits, value) FP_PROFILE_SCOPE(uint64_t*, __fp_bitset_resize(&(b), (bits), (value)))
+
+// Creates a bitset of \p bits clear bits
+inline static uint64_t* __fp_bitset_create_in(size_t bits, fp_allocator_id allocator) FP_NOEXCEPT {
+	uint64_t* b = NULL;
+	__fp_bitset_reserve_in(&b, bits, true, allocator);
+	return __fp_bitset_resize(&b, bits, false);
+}
+#define fp_bitset_create(bits) FP_PROFILE_SCOPE(uint64_t*, __fp_bitset_create_in((bits), FP_DEFAULT_ALLOCATOR))
+#define fp_bitset_create_in(bits, allocator) FP_PROFILE_SCOPE(uint64_t*, __fp_bitset_create_in((bits), (allocator)))
+
+inline static void fp_bitset_free(uint64_t* b) FP_NOEXCEPT {
+	if(b) __fp_alloc(__fp_bitset_header(b), 0);
+}
+#define fp_bitset_free_and_null(b) (FP_PROFILE_SCOPE_VOID(fp_bitset_free(b)), b = NULL)
+
+inline static uint64_t* __fp_bitset_clone(const uint64_t* b) FP_NOEXCEPT {
+	if(!b) return NULL;
+	uint64_t* out = __fp_bitset_create_in(fp_size(b), fp_allocator_of(b));
+	memcpy(out, b, sizeof(uint64_t) * fp_bitset_word_count(b));
+	return out;
+}
+#define fp_bitset_clone(b) FP_PROFILE_SCOPE(uint64_t*, __fp_bitset_clone(b))
+
+inline static bool fp_bitset_test(const uint64_t* b, size_t i) FP_NOEXCEPT {
+	assert(i < fp_size(b));
+	return (b[i / FP_BITSET_WORD_BITS] >> (i % FP_BITSET_WORD_BITS)) & 1;
+}
+inline static void fp_bitset_set(uint64_t* b, size_t i) FP_NOEXCEPT {
+	assert(i < fp_size(b));
+	b[i / FP_BITSET_WORD_BITS] |= ((uint64_t)1) << (i % FP_BITSET_WORD_BITS);
+}
+inline static void fp_bitset_clear(uint64_t* b, size_t i) FP_NOEXCEPT {
+	assert(i < fp_size(b));
+	b[i / FP_BITSET_WORD_BITS] &= ~(((uint64_t)1) << (i % FP_BITSET_WORD_BITS));
+}
+inline static void fp_bitset_flip(uint64_t* b, size_t i) FP_NOEXCEPT {
+	assert(i < fp_size(b));
+	b[i / FP_BITSET_WORD_BITS] ^= ((uint64_t)1) << (i % FP_BITSET_WORD_BITS);
+}
+inline static void fp_bitset_assign(uint64_t* b, size_t i, bool value) FP_NOEXCEPT {
+	if(value) fp_bitset_set(b, i);
+	else fp_bitset_clear(b, i);
+}
+
+inline static void __fp_bitset_push_back(uint64_t** b, bool value) FP_NOEXCEPT {
+	size_t i = fp_size(*b);
+	auto h = __fp_bitset_reserve_in(b, i + 1, false, FP_DEFAULT_ALLOCATOR);
+	if(i % FP_BITSET_WORD_BITS == 0) (*b)[i / FP_BITSET_WORD_BITS] = 0; // Starting a fresh word
+	h->h.size = i + 1;
+	if(value) fp_bitset_set(*b, i);
+}
+#define fp_bitset_push_back(b, value) FP_PROFILE_SCOPE_VOID(__fp_bitset_push_back(&(b), (value)))
+
+inline static void fp_bitset_set_all(uint64_t* b) FP_NOEXCEPT {
+	if(!b) return;
+	memset(b, 0xFF, sizeof(uint64_t) * fp_bitset_word_count(b));
+	__fp_bitset_clear_tail(b);
+}
+inline static void fp_bitset_clear_all(uint64_t* b) FP_NOEXCEPT {
+	if(b) memset(b, 0, sizeof(uint64_t) * fp_bitset_word_count(b));
+}
+
+// Combines \p src into \p dest (dest = dest op src) a vector at a time, NOTE: Both bitsets must be the same size
+inline static void fp_bitset_combine(uint64_t* dest, const uint64_t* src, enum fp_simd_bitwise_op op) FP_NOEXCEPT {
+	assert(fp_size(dest) == fp_size(src));
+	if(dest) fp_simd_bitwise(dest, src, sizeof(uint64_t) * fp_bitset_word_count(dest), op);
+}
+#define fp_bitset_and(dest, src) fp_bitset_combine((dest), (src), FP_SIMD_AND)
+#define fp_bitset_or(dest, src) fp_bitset_combine((dest), (src), FP_SIMD_OR)
+#define fp_bitset_xor(dest, src) fp_bitset_combine((dest), (src), FP_SIMD_XOR)
+#define fp_bitset_andnot(dest, src) fp_bitset_combine((dest), (src), FP_SIMD_ANDNOT)
+
+inline static bool fp_bitset_equal(const uint64_t* a, const uint64_t* b) FP_NOEXCEPT {
+	return fp_size(a) == fp_size(b) && fp_simd_equal(a, b, sizeof(uint64_t) * fp_bitset_word_count(a));
+}
+
+// Number of set bits
+inline static size_t fp_bitset_count(const uint64_t* b) FP_NOEXCEPT {
+	return b ? (size_t)fp_simd_popcount(b, sizeof(uint64_t) * fp_bitset_word_count(b)) : 0;
+}
+inline static bool fp_bitset_all(const uint64_t* b) FP_NOEXCEPT { return fp_bitset_count(b) == fp_size(b); }
+
+// Index of the first set bit at or after \p from, fp_bitset_size(b) if there are none
+inline static size_t fp_bitset_find_next_set(const uint64_t* b, size_t from) FP_NOEXCEPT {
+	size_t size = fp_size(b);
+	if(from >= size) return size;
+	size_t word = from / FP_BITSET_WORD_BITS, words = fp_bitset_word_count(b);
+	uint64_t bits = b[word] & (~(uint64_t)0 << (from % FP_BITSET_WORD_BITS));
+	while(!bits) {
+		if(++word == words) return size;
+		bits = b[word];
+	}
+	return word * FP_BITSET_WORD_BITS + fp_count_trailing_zeros64(bits);
+}
+inline static bool fp_bitset_any(const uint64_t* b) FP_NOEXCEPT { return fp_bitset_find_next_set(b, 0) < fp_size(b); }
+inline static bool fp_bitset_none(const uint64_t* b) FP_NOEXCEPT { return !fp_bitset_any(b); }
+
+// Loops over the indices of the set bits: fp_bitset_iterate(mask) printf("%zu\n", i);
+#define fp_bitset_iterate_named(b, iter) for(size_t iter = fp_bitset_find_next_set((b), 0); iter < fp_size(b); iter = fp_bitset_find_next_set((b), iter + 1))
+#define fp_bitset_iterate(b) fp_bitset_iterate_named((b), i)
+
+
+// Interop with views
+
+typedef bool(*fp_bitset_predicate_t)(const void* element, void* userdata) FP_NOEXCEPT;
+
+/**
+* @brief Creates a bitset with one bit for each of the \p count elements of \p data, set where \p predicate returns true
+* @note The bits are gathered into a word before it is stored, so building the mask doesn't read modify write memory per element
+*/
+inline static uint64_t* __fp_bitset_from_predicate(const void* data, size_t count, size_t type_size, fp_bitset_predicate_t predicate, void* userdata) FP_NOEXCEPT {
+	uint64_t* b = __fp_bitset_create_in(count, FP_DEFAULT_ALLOCATOR);
+	const uint8_t* element = (const uint8_t*)data;
+	for(size_t word = 0; word * FP_BITSET_WORD_BITS < count; ++word) {
+		size_t end = count - word * FP_BITSET_WORD_BITS < FP_BITSET_WORD_BITS ? count - word * FP_BITSET_WORD_BITS : FP_BITSET_WORD_BITS;
+		uint64_t bits = 0;
+		for(size_t i = 0; i < end; ++i, element += type_size)
+			bits |= ((uint64_t)(predicate(element, userdata) ? 1 : 0)) << i;
+		b[word] = bits;
+	}
+	return b;
+}
+#define fp_bitset_from_view(type, view, predicate, userdata) FP_PROFILE_SCOPE(uint64_t*, __fp_bitset_from_predicate(fp_view_data(type, view), fp_view_size(view), sizeof(type), (predicate), (userdata)))
+
+/**
+* @brief Copies the elements of \p src whose bit is set (src must have fp_bitset_size(b) elements) to the front of \p dest, keeping their order
+* @note \p dest must have room for fp_bitset_count(b) elements, it may be \p src (for filtering in place)
+* @return the number of elements copied
+*/
+inline static size_t __fp_bitset_compress(const uint64_t* b, const void* src, void* dest, size_t type_size) FP_NOEXCEPT {
+	size_t size = fp_size(b), written = 0;
+	for(size_t word = 0; word * FP_BITSET_WORD_BITS < size; ++word) {
+		size_t count = size - word * FP_BITSET_WORD_BITS < FP_BITSET_WORD_BITS ? size - word * FP_BITSET_WORD_BITS : FP_BITSET_WORD_BITS;
+		written += fp_simd_compress(((uint8_t*)dest) + written * type_size, ((const uint8_t*)src) + word * FP_BITSET_WORD_BITS * type_size, b[word], count, type_size);
+	}
+	return written;
+}
+#define fp_bitset_compress(type, b, src, dest) __fp_bitset_compress((b), (src), (dest), sizeof(type))
+
+
+// Rank/select index, NOTE: It must be rebuilt whenever the bitset changes
+
+// Bits covered by each entry of a rank index
+#define FP_BITSET_RANK_BLOCK_BITS 512
+#define __FP_BITSET_RANK_BLOCK_WORDS (FP_BITSET_RANK_BLOCK_BITS / FP_BITSET_WORD_BITS)
+
+/**
+* @brief Builds a rank index for the bitset: a dynarray holding the number of set bits before each block of
+*	FP_BITSET_RANK_BLOCK_BITS bits (and one final entry holding the total), one word per 512 bits
+*/
+inline static uint64_t* __fp_bitset_rank_index(const uint64_t* b) FP_NOEXCEPT {
+	size_t words = fp_bitset_word_count(b), blocks = (words + __FP_BITSET_RANK_BLOCK_WORDS - 1) / __FP_BITSET_RANK_BLOCK_WORDS;
+	uint64_t* index = NULL;
+	__fpda_maybe_grow((void**)&index, sizeof(uint64_t), blocks + 1, true, true);
+	uint64_t total = 0;
+	for(size_t block = 0; block < blocks; ++block) {
+		index[block] = total;
+		size_t start = block * __FP_BITSET_RANK_BLOCK_WORDS, end = start + __FP_BITSET_RANK_BLOCK_WORDS < words ? start + __FP_BITSET_RANK_BLOCK_WORDS : words;
+		for(size_t word = start; word < end; ++word)
+			total += fp_popcount64(b[word]);
+	}
+	index[blocks] = total;
+	return index;
+}
+#define fp_bitset_rank_index(b) FP_PROFILE_SCOPE(uint64_t*, __fp_bitset_rank_index(b))
+
+// Number of set bits before the \p i th bit, in O(1) (at most 8 word popcounts)
+inline static size_t fp_bitset_rank(const uint64_t* b, const uint64_t* index, size_t i) FP_NOEXCEPT {
+	assert(i <= fp_size(b));
+	size_t word = i / FP_BITSET_WORD_BITS;
+	size_t count = index[word / __FP_BITSET_RANK_BLOCK_WORDS];
+	for(size_t w = word / __FP_BITSET_RANK_BLOCK_WORDS * __FP_BITSET_RANK_BLOCK_WORDS; w < word; ++w)
+		count += fp_popcount64(b[w]);
+	if(i % FP_BITSET_WORD_BITS) count += fp_popcount64(b[word] & ((((uint64_t)1) << (i % FP_BITSET_WORD_BITS)) - 1));
+	return count;
+}
+
+// Position of the \p k th set bit of \p x (which must have more than k set bits)
+inline static size_t __fp_bitset_select_in_word(uint64_t x, size_t k) FP_NOEXCEPT {
+	// Running totals of the set bits in each byte (byte i holds the count for bytes 0 through i)
+	uint64_t counts = x - ((x >> 1) & 0x5555555555555555ull);
+	counts = (counts & 0x3333333333333333ull) + ((counts >> 2) & 0x3333333333333333ull);
+	counts = ((counts + (counts >> 4)) & 0x0F0F0F0F0F0F0F0Full) * 0x0101010101010101ull;
+	// The byte holding the bit is the first whose running total exceeds k, compare every byte at once (the totals never exceed 64 so no byte borrows)
+	size_t byte = fp_popcount64((((uint64_t)k * 0x0101010101010101ull | 0x8080808080808080ull) - counts) & 0x8080808080808080ull);
+	k -= ((counts << 8) >> (byte * 8)) & 0xFF;
+	uint64_t bits = (x >> (byte * 8)) & 0xFF;
+	for(; k; --k) bits &= bits - 1; // Drop the lower set bits
+	return byte * 8 + fp_count_trailing_zeros64(bits);
+}
+
+// Index of the \p k th (counting from 0) set bit, in O(log(blocks)), fp_bitset_size(b) if there are not that many set bits
+inline static size_t fp_bitset_select(const uint64_t* b, const uint64_t* index, size_t k) FP_NOEXCEPT {
+	size_t blocks = fpda_size(index) - 1;
+	if(k >= index[blocks]) return fp_size(b);
+
+	// Find the last block which has at most k set bits before it, the search is branchless since its branches would be unpredictable
+	const uint64_t* block = index;
+	for(size_t length = blocks; length > 1; ) {
+		size_t half = length / 2;
+		block = block[half] <= k ? block + half : block;
+		length -= half;
+	}
+	k -= *block;
+	for(size_t word = (block - index) * __FP_BITSET_RANK_BLOCK_WORDS; ; ++word) {
+		uint64_t bits = b[word];
+		size_t count = fp_popcount64(bits);
+		if(k < count) return word * FP_BITSET_WORD_BITS + __fp_bitset_select_in_word(bits, k);
+		k -= count;
+	}
+}
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // __LIB_FAT_POINTER_BITSET_H__
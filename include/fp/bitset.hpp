@@ -0,0 +1,160 @@
+#pragma once
+
+#include <algorithm>
+#include <iterator>
+
+#include "pointer.hpp"
+#include "dynarray.hpp"
+#include "bitset.h"
+
+namespace fp {
+
+	template<typename Derived>
+	struct bitset_crtp {
+		// Walks the indices of the set bits
+		struct iterator {
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = size_t;
+			using difference_type = std::ptrdiff_t;
+			using pointer = const size_t*;
+			using reference = size_t;
+
+			const uint64_t* bits;
+			size_t index;
+
+			inline size_t operator*() const { return index; }
+			inline iterator& operator++() { index = fp_bitset_find_next_set(bits, index + 1); return *this; }
+			inline iterator operator++(int) { auto out = *this; ++*this; return out; }
+			inline bool operator==(const iterator& o) const { return index == o.index; }
+		};
+
+		inline bool is_bitset() const { return is_fp_bitset(ptr()); }
+		inline size_t size() const { return fp_bitset_size(ptr()); }
+		inline size_t length() const { return fp_bitset_length(ptr()); }
+		inline bool empty() const { return fp_bitset_empty(ptr()); }
+		inline size_t capacity() const { return fp_bitset_capacity(ptr()); }
+		inline size_t word_count() const { return fp_bitset_word_count(ptr()); }
+		inline operator bool() const { return ptr() != nullptr; }
+
+		inline void free() { fp_bitset_free(ptr()); }
+		inline void free_and_null() { fp_bitset_free_and_null(ptr()); }
+
+		// NOTE: The allocator is only used if the bitset hasn't been allocated yet
+		inline Derived& reserve(size_t bits, fp_allocator_id allocator = FP_DEFAULT_ALLOCATOR) {
+			fp_bitset_reserve_in(ptr(), bits, allocator);
+			return *derived();
+		}
+		inline Derived& resize(size_t bits, bool value = false) {
+			fp_bitset_resize_value(ptr(), bits, value);
+			return *derived();
+		}
+		inline Derived& push_back(bool value) {
+			fp_bitset_push_back(ptr(), value);
+			return *derived();
+		}
+
+		inline bool test(size_t i) const { return fp_bitset_test(ptr(), i); }
+		inline bool operator[](size_t i) const { return test(i); }
+		inline Derived& set(size_t i, bool value = true) {
+			fp_bitset_assign(ptr(), i, value);
+			return *derived();
+		}
+		inline Derived& clear(size_t i) {
+			fp_bitset_clear(ptr(), i);
+			return *derived();
+		}
+		inline Derived& flip(size_t i) {
+			fp_bitset_flip(ptr(), i);
+			return *derived();
+		}
+		inline Derived& set_all() {
+			fp_bitset_set_all(ptr());
+			return *derived();
+		}
+		inline Derived& clear_all() {
+			fp_bitset_clear_all(ptr());
+			return *derived();
+		}
+
+		// NOTE: Both bitsets must be the same size
+		inline Derived& operator&=(const bitset_crtp& o) { fp_bitset_and(ptr(), o.ptr()); return *derived(); }
+		inline Derived& operator|=(const bitset_crtp& o) { fp_bitset_or(ptr(), o.ptr()); return *derived(); }
+		inline Derived& operator^=(const bitset_crtp& o) { fp_bitset_xor(ptr(), o.ptr()); return *derived(); }
+		inline Derived& and_not(const bitset_crtp& o) { fp_bitset_andnot(ptr(), o.ptr()); return *derived(); }
+		inline bool operator==(const bitset_crtp& o) const { return fp_bitset_equal(ptr(), o.ptr()); }
+
+		inline size_t count() const { return fp_bitset_count(ptr()); }
+		inline bool any() const { return fp_bitset_any(ptr()); }
+		inline bool none() const { return fp_bitset_none(ptr()); }
+		inline bool all() const { return fp_bitset_all(ptr()); }
+		inline size_t find_next_set(size_t from) const { return fp_bitset_find_next_set(ptr(), from); }
+
+		inline iterator begin() const { return {ptr(), find_next_set(0)}; }
+		inline iterator end() const { return {ptr(), size()}; }
+
+		inline view<uint64_t> words() { return {ptr(), word_count()}; }
+		inline view<const uint64_t> words() const { return {ptr(), word_count()}; }
+
+		// Copies the elements of src whose bit is set to the front of dest (which may be src), returns how many were copied
+		template<typename T>
+		inline size_t compress(view<const T> src, view<T> dest) const {
+			static_assert(std::is_trivially_copyable_v<T>, "Elements are copied bytewise");
+			assert(src.size() == size() && dest.size() >= count());
+			return fp_bitset_compress(T, ptr(), src.data(), dest.data());
+		}
+
+		// NOTE: The index must be rebuilt whenever the bitset changes
+		inline raii::dynarray<uint64_t> rank_index() const { return fp_bitset_rank_index(ptr()); }
+		inline size_t rank(const uint64_t* index, size_t i) const { return fp_bitset_rank(ptr(), index, i); }
+		inline size_t select(const uint64_t* index, size_t k) const { return fp_bitset_select(ptr(), index, k); }
+
+		inline Derived clone() const { return fp_bitset_clone(ptr()); }
+
+	protected:
+		inline Derived* derived() { return (Derived*)this; }
+		inline const Derived* derived() const { return (Derived*)this; }
+		inline uint64_t*& ptr() { return derived()->raw; }
+		inline uint64_t* const & ptr() const { return derived()->raw; }
+	};
+
+	// Packed array of bits, fp::raii::bitset::from(values, [](int v) { return v > 0; }) builds a mask over a view
+	struct bitset: public bitset_crtp<bitset> {
+		uint64_t* raw;
+
+		bitset(): raw(nullptr) {}
+		bitset(std::nullptr_t): raw(nullptr) {}
+		bitset(uint64_t* ptr): raw(ptr) { assert(ptr == nullptr || is_fp_bitset(ptr)); }
+	};
+
+	namespace raii {
+		struct bitset: public fp::bitset {
+			using super = fp::bitset;
+			using super::raw;
+
+			bitset(): super(nullptr) {}
+			bitset(uint64_t* ptr): super(ptr) {}
+			explicit bitset(size_t bits): super(fp_bitset_create(bits)) {}
+			bitset(const fp::bitset& o): super(o.clone()) {}
+			bitset(fp::bitset&& o): super(std::exchange(o.raw, nullptr)) {}
+			bitset(const bitset& o): super(o.clone()) {}
+			bitset(bitset&& o): super(std::exchange(o.raw, nullptr)) {}
+			bitset& operator=(const bitset& o) { if(this != &o) { super::free(); raw = o.clone().raw; } return *this; }
+			bitset& operator=(bitset&& o) { if(this != &o) { super::free(); raw = std::exchange(o.raw, nullptr); } return *this; }
+			~bitset() { super::free_and_null(); }
+
+			// One bit for each element of values, set where predicate returns true (gathered a word at a time)
+			template<typename T, typename F>
+			static bitset from(view<T> values, F&& predicate) {
+				bitset out(values.size());
+				for(size_t word = 0; word * FP_BITSET_WORD_BITS < values.size(); ++word) {
+					size_t start = word * FP_BITSET_WORD_BITS, end = std::min<size_t>(values.size() - start, FP_BITSET_WORD_BITS);
+					uint64_t bits = 0;
+					for(size_t i = 0; i < end; ++i)
+						bits |= uint64_t(bool(predicate(values[start + i]))) << i;
+					out.raw[word] = bits;
+				}
+				return out;
+			}
+		};
+	}
+}
@@ -0,0 +1,403 @@
+#ifndef __LIB_FAT_POINTER_COMPRESSED_H__
+#define __LIB_FAT_POINTER_COMPRESSED_H__
+
+// Compact storage for arrays of integers which need far fewer than 64 bits each
+// - Packed arrays store every value in the same (smallest sufficient) number of bits, with O(1) access
+// - Frame-of-reference arrays split the values into blocks which each store their values relative to a base, in just enough bits for that
+//	block, either as offsets from the block's minimum or (for sorted data) as gaps between neighbours, a block index keeps access O(block)
+// - Varints stream values into a byte dynarray using 7 bits per byte, small values (or the gaps of sorted ones) take a single byte
+// Packed values are stored back to back starting from the least significant bit of each word and unpacked with fp_simd_unpack_bits
+
+#include "dynarray.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Number of values in each frame-of-reference block
+#ifndef FP_FOR_BLOCK_SIZE
+#define FP_FOR_BLOCK_SIZE 128
+#endif
+
+// The number of bits needed to represent \p value (0 for 0)
+inline static unsigned fp_bits_required(uint64_t value) FP_NOEXCEPT { return value ? (unsigned)fp_floor_log2(value) + 1 : 0; }
+inline static uint64_t __fp_bits_mask(unsigned width) FP_NOEXCEPT { return width >= 64 ? ~(uint64_t)0 : (((uint64_t)1) << width) - 1; }
+
+// Words needed to hold \p count values of \p width bits
+inline static size_t fp_packed_words(size_t count, unsigned width) FP_NOEXCEPT { return (size_t)(((uint64_t)count * width + 63) / 64); }
+
+// Reads value \p index from a packed region
+// NOTE: Reads the word after the value's first word, so regions should end with a word of padding
+inline static uint64_t fp_packed_get(const uint64_t* packed, size_t index, unsigned width) FP_NOEXCEPT {
+	if(width == 0) return 0;
+	uint64_t bit = (uint64_t)index * width;
+	size_t word = (size_t)(bit >> 6);
+	unsigned shift = bit & 63;
+	return ((packed[word] >> shift) | ((packed[word + 1] << 1) << (63 - shift))) & __fp_bits_mask(width);
+}
+
+// Overwrites value \p index of a packed region
+inline static void fp_packed_set(uint64_t* packed, size_t index, unsigned width, uint64_t value) FP_NOEXCEPT {
+	uint64_t mask = __fp_bits_mask(width);
+	assert(value <= mask);
+	if(width == 0) return;
+	uint64_t bit = (uint64_t)index * width;
+	size_t word = (size_t)(bit >> 6);
+	unsigned shift = bit & 63;
+	packed[word] = (packed[word] & ~(mask << shift)) | (value << shift);
+	if(shift + width > 64) // The top of the value spills into the next word
+		packed[word + 1] = (packed[word + 1] & ~(mask >> (64 - shift))) | (value >> (64 - shift));
+}
+
+/**
+* @brief Packs \p count values (which must each fit in \p width bits) into fp_packed_words(count, width) words of \p packed,
+*	streaming each word out as soon as it fills
+*/
+inline static void fp_packed_pack(const uint64_t* values, size_t count, unsigned width, uint64_t* packed) FP_NOEXCEPT {
+	size_t words = fp_packed_words(count, width), written = 0;
+	uint64_t accumulator = 0;
+	unsigned filled = 0;
+	if(width > 0) for(size_t i = 0; i < count; ++i) {
+		uint64_t value = values[i];
+		assert(value <= __fp_bits_mask(width));
+		accumulator |= value << filled;
+		filled += width;
+		if(filled >= 64) {
+			packed[written++] = accumulator;
+			filled -= 64;
+			accumulator = filled ? value >> (width - filled) : 0;
+		}
+	}
+	if(written < words) packed[written] = accumulator;
+}
+
+
+
+// Array whose values are all stored in the same number of bits
+struct fp_packed_array {
+	fp_dynarray(uint64_t) words; // Always has a word of padding after the packed values
+	size_t size;
+	unsigned width;
+};
+
+inline static void fp_packed_array_init(struct fp_packed_array* a, unsigned width) FP_NOEXCEPT {
+	assert(width <= 64);
+	a->words = NULL;
+	a->size = 0;
+	a->width = width;
+}
+
+inline static void fp_packed_array_free(struct fp_packed_array* a) FP_NOEXCEPT {
+	fpda_free_and_null(a->words);
+	a->size = 0;
+}
+
+inline static size_t fp_packed_array_size(const struct fp_packed_array* a) FP_NOEXCEPT { return a->size; }
+inline static bool fp_packed_array_empty(const struct fp_packed_array* a) FP_NOEXCEPT { return a->size == 0; }
+inline static unsigned fp_packed_array_width(const struct fp_packed_array* a) FP_NOEXCEPT { return a->width; }
+// Bytes of storage the packed values take up
+inline static size_t fp_packed_array_bytes(const struct fp_packed_array* a) FP_NOEXCEPT { return fpda_size(a->words) * sizeof(uint64_t); }
+
+// Makes sure there are enough (zeroed) words for \p count values plus padding
+inline static void __fp_packed_array_grow_words(struct fp_packed_array* a, size_t count, bool exact) FP_NOEXCEPT {
+	size_t old = fpda_size(a->words), words = fp_packed_words(count, a->width) + 1;
+	if(words <= old) return;
+	__fpda_maybe_grow_short(a->words, words); // Amortized, like fpda_push_back
+	if(exact) fpda_shrink_to_fit(a->words);
+	memset(a->words + old, 0, (words - old) * sizeof(uint64_t));
+}
+
+/**
+* @brief Replaces the contents of \p a with \p count values, stored in the fewest bits which fit the largest of them
+*/
+inline static void fp_packed_array_assign(struct fp_packed_array* a, const uint64_t* values, size_t count) FP_NOEXCEPT {
+	uint64_t largest = 0;
+	for(size_t i = 0; i < count; ++i)
+		largest |= values[i];
+	fp_packed_array_free(a);
+	a->width = fp_bits_required(largest);
+	__fp_packed_array_grow_words(a, count, true);
+	fp_packed_pack(values, count, a->width, a->words);
+	a->size = count;
+}
+
+inline static uint64_t fp_packed_array_get(const struct fp_packed_array* a, size_t index) FP_NOEXCEPT {
+	assert(index < a->size);
+	return fp_packed_get(a->words, index, a->width);
+}
+// NOTE: \p value must fit in the array's width
+inline static void fp_packed_array_set(struct fp_packed_array* a, size_t index, uint64_t value) FP_NOEXCEPT {
+	assert(index < a->size);
+	fp_packed_set(a->words, index, a->width, value);
+}
+inline static void fp_packed_array_push_back(struct fp_packed_array* a, uint64_t value) FP_NOEXCEPT {
+	__fp_packed_array_grow_words(a, a->size + 1, false);
+	fp_packed_set(a->words, a->size++, a->width, value);
+}
+
+// Unpacks \p count values starting at \p first into \p out (using the vector unpack kernels where available)
+inline static void fp_packed_array_unpack(const struct fp_packed_array* a, size_t first, size_t count, uint64_t* out) FP_NOEXCEPT {
+	assert(first + count <= a->size);
+	if(count) fp_simd_unpack_bits(a->words, first, count, a->width, out);
+}
+
+
+
+// Header of each FP_FOR_BLOCK_SIZE values of a frame-of-reference array
+struct fp_for_block {
+	uint64_t base; // The block's smallest value (or its first value for delta arrays)
+	uint64_t gap; // Delta arrays only: the smallest gap between neighbouring values, subtracted from every stored gap
+	uint64_t offset; // First word of the block's packed values
+	uint64_t width;
+};
+
+// Frame-of-reference (optionally delta) encoded array, each block packs its values relative to the block's base in as few bits as they need
+// NOTE: Delta arrays must be sorted (non-decreasing), reading a value from them sums the gaps before it in its block
+struct fp_for_array {
+	fp_dynarray(struct fp_for_block) blocks;
+	fp_dynarray(uint64_t) words; // Every block's packed values, followed by a word of padding
+	size_t size;
+	bool delta;
+};
+
+inline static void fp_for_array_init(struct fp_for_array* a) FP_NOEXCEPT {
+	a->blocks = NULL;
+	a->words = NULL;
+	a->size = 0;
+	a->delta = false;
+}
+
+inline static void fp_for_array_free(struct fp_for_array* a) FP_NOEXCEPT {
+	fpda_free_and_null(a->blocks);
+	fpda_free_and_null(a->words);
+	a->size = 0;
+}
+
+inline static size_t fp_for_array_size(const struct fp_for_array* a) FP_NOEXCEPT { return a->size; }
+inline static bool fp_for_array_empty(const struct fp_for_array* a) FP_NOEXCEPT { return a->size == 0; }
+// Bytes of storage the packed values and block index take up
+inline static size_t fp_for_array_bytes(const struct fp_for_array* a) FP_NOEXCEPT {
+	return fpda_size(a->blocks) * sizeof(struct fp_for_block) + fpda_size(a->words) * sizeof(uint64_t);
+}
+
+/**
+* @brief Replaces the contents of \p a with \p count encoded values
+* @param delta whether to store the gaps between neighbouring values (which must then be sorted) instead of their offsets from each block's minimum
+*/
+inline static void fp_for_array_encode(struct fp_for_array* a, const uint64_t* values, size_t count, bool delta) FP_NOEXCEPT {
+	fp_for_array_free(a);
+	a->size = count;
+	a->delta = delta;
+	if(count == 0) return;
+
+	size_t block_count = (count + FP_FOR_BLOCK_SIZE - 1) / FP_FOR_BLOCK_SIZE;
+	fpda_reserve(a->blocks, block_count);
+	uint64_t residuals[FP_FOR_BLOCK_SIZE];
+	for(size_t start = 0; start < count; start += FP_FOR_BLOCK_SIZE) {
+		const uint64_t* v = values + start;
+		size_t n = FP_MIN(count - start, (size_t)FP_FOR_BLOCK_SIZE);
+		struct fp_for_block block = {v[0], 0, fpda_size(a->words), 0};
+		uint64_t largest = 0;
+		if(delta) {
+			block.gap = n > 1 ? ~(uint64_t)0 : 0;
+			for(size_t i = 1; i < n; ++i) {
+				assert(v[i] >= v[i - 1]); // Delta arrays must be sorted!
+				block.gap = FP_MIN(block.gap, v[i] - v[i - 1]);
+			}
+			residuals[0] = 0;
+			for(size_t i = 1; i < n; ++i)
+				largest |= residuals[i] = v[i] - v[i - 1] - block.gap;
+		} else {
+			for(size_t i = 1; i < n; ++i)
+				block.base = FP_MIN(block.base, v[i]);
+			for(size_t i = 0; i < n; ++i)
+				largest |= residuals[i] = v[i] - block.base;
+		}
+		block.width = fp_bits_required(largest);
+
+		size_t words = fp_packed_words(n, (unsigned)block.width);
+		if(words) fp_packed_pack(residuals, n, (unsigned)block.width, (uint64_t*)FP_PROFILE_SCOPE(void*, __fpda_maybe_grow((void**)&a->words, sizeof(uint64_t), block.offset + words, true, false)) - (words - 1));
+		*__fpda_maybe_grow_short(a->blocks, fpda_size(a->blocks) + 1) = block;
+	}
+	*__fpda_maybe_grow_short(a->words, fpda_size(a->words) + 1) = 0; // Padding
+	fpda_shrink_to_fit(a->words);
+}
+
+/**
+* @brief Decodes every value in block \p block_index into \p out
+* @return the number of values in the block
+*/
+inline static size_t fp_for_array_decode_block(const struct fp_for_array* a, size_t block_index, uint64_t* out) FP_NOEXCEPT {
+	assert(block_index < fpda_size(a->blocks));
+	const struct fp_for_block* block = a->blocks + block_index;
+	size_t n = FP_MIN(a->size - block_index * FP_FOR_BLOCK_SIZE, (size_t)FP_FOR_BLOCK_SIZE);
+	fp_simd_unpack_bits(a->words + block->offset, 0, n, (unsigned)block->width, out);
+	if(a->delta) {
+		uint64_t running = block->base;
+		out[0] = running;
+		for(size_t i = 1; i < n; ++i)
+			out[i] = running += out[i] + block->gap;
+	} else for(size_t i = 0; i < n; ++i)
+		out[i] += block->base;
+	return n;
+}
+
+// Decodes \p count values starting at \p first into \p out, whole blocks are decoded in place
+inline static void fp_for_array_decode(const struct fp_for_array* a, size_t first, size_t count, uint64_t* out) FP_NOEXCEPT {
+	assert(first + count <= a->size);
+	uint64_t scratch[FP_FOR_BLOCK_SIZE];
+	while(count) {
+		size_t block = first / FP_FOR_BLOCK_SIZE, offset = first % FP_FOR_BLOCK_SIZE;
+		size_t n = FP_MIN(a->size - block * FP_FOR_BLOCK_SIZE, (size_t)FP_FOR_BLOCK_SIZE) - offset;
+		if(n > count) n = count;
+		if(offset == 0 && n == FP_MIN(a->size - first, (size_t)FP_FOR_BLOCK_SIZE))
+			fp_for_array_decode_block(a, block, out);
+		else {
+			fp_for_array_decode_block(a, block, scratch);
+			memcpy(out, scratch + offset, n * sizeof(uint64_t));
+		}
+		out += n;
+		first += n;
+		count -= n;
+	}
+}
+
+// Reads the value at \p index, O(1) for frame-of-reference arrays and O(FP_FOR_BLOCK_SIZE) for delta arrays
+inline static uint64_t fp_for_array_get(const struct fp_for_array* a, size_t index) FP_NOEXCEPT {
+	assert(index < a->size);
+	const struct fp_for_block* block = a->blocks + index / FP_FOR_BLOCK_SIZE;
+	const uint64_t* packed = a->words + block->offset;
+	size_t offset = index % FP_FOR_BLOCK_SIZE;
+	if(!a->delta) return block->base + fp_packed_get(packed, offset, (unsigned)block->width);
+
+	uint64_t gaps[FP_FOR_BLOCK_SIZE], value = block->base + offset * block->gap;
+	fp_simd_unpack_bits(packed, 0, offset + 1, (unsigned)block->width, gaps);
+	for(size_t i = 1; i <= offset; ++i)
+		value += gaps[i];
+	return value;
+}
+
+// Index of the first value which isn't less than \p value (or the size if there are none)
+// NOTE: The array must be sorted, the search only decodes a single block
+inline static size_t fp_for_array_lower_bound(const struct fp_for_array* a, uint64_t value) FP_NOEXCEPT {
+	size_t low = 0, high = fpda_size(a->blocks); // Find the first block starting at or after value, earlier occurrences can only be in the block before it
+	while(low < high) {
+		size_t mid = low + (high - low) / 2;
+		if(a->blocks[mid].base < value) low = mid + 1;
+		else high = mid;
+	}
+	if(low == 0) return 0;
+
+	uint64_t scratch[FP_FOR_BLOCK_SIZE];
+	size_t n = fp_for_array_decode_block(a, low - 1, scratch);
+	for(size_t i = 0; i < n; ++i)
+		if(scratch[i] >= value) return (low - 1) * FP_FOR_BLOCK_SIZE + i;
+	return FP_MIN(low * FP_FOR_BLOCK_SIZE, a->size);
+}
+
+
+
+// Maps signed values onto unsigned ones so small negative numbers also encode into few bytes (0, -1, 1, -2... become 0, 1, 2, 3...)
+inline static uint64_t fp_zigzag_encode(int64_t value) FP_NOEXCEPT { return (((uint64_t)value) << 1) ^ (uint64_t)(value >> 63); }
+inline static int64_t fp_zigzag_decode(uint64_t value) FP_NOEXCEPT { return (int64_t)(value >> 1) ^ -(int64_t)(value & 1); }
+
+// Number of bytes the varint encoding of \p value takes up (1 to 10)
+inline static size_t fp_varint_size(uint64_t value) FP_NOEXCEPT { return value ? fp_floor_log2(value) / 7 + 1 : 1; }
+
+// Writes the varint encoding of \p value (7 bits per byte, least significant first, the high bit set on every byte but the last) to \p out
+inline static size_t fp_varint_write(uint8_t* out, uint64_t value) FP_NOEXCEPT {
+	size_t written = 0;
+	for(; value >= 0x80; value >>= 7)
+		out[written++] = (uint8_t)(value | 0x80);
+	out[written++] = (uint8_t)value;
+	return written;
+}
+
+/**
+* @brief Reads a single varint
+* @return a pointer just after the value, or NULL if \p end (or 10 bytes) came before its last byte
+*/
+inline static const uint8_t* fp_varint_read(const uint8_t* cursor, const uint8_t* end, uint64_t* value) FP_NOEXCEPT {
+	uint64_t result = 0;
+	for(unsigned shift = 0; shift < 64 && cursor < end; shift += 7) {
+		uint8_t byte = *cursor++;
+		result |= ((uint64_t)(byte & 0x7F)) << shift;
+		if(!(byte & 0x80)) {
+			*value = result;
+			return cursor;
+		}
+	}
+	return NULL;
+}
+
+inline static uint8_t* __fp_varint_encode(void** bytes, const uint64_t* values, size_t count, bool delta) FP_NOEXCEPT {
+	size_t encoded = 0;
+	uint64_t previous = 0;
+	for(size_t i = 0; i < count; previous = values[i++])
+		encoded += fp_varint_size(values[i] - (delta ? previous : 0));
+	size_t start = fpda_size(*bytes);
+	if(encoded == 0) return (uint8_t*)*bytes;
+	uint8_t* out = (uint8_t*)__fpda_maybe_grow(bytes, 1, start + encoded, true, false) - (encoded - 1);
+	previous = 0;
+	for(size_t i = 0; i < count; previous = values[i++]) {
+		assert(!delta || values[i] >= previous); // Delta encoded values must be sorted!
+		out += fp_varint_write(out, values[i] - (delta ? previous : 0));
+	}
+	return (uint8_t*)*bytes;
+}
+// Appends the varint encoding of \p count values to the fp_dynarray(uint8_t) \p bytes
+#define fp_varint_encode(bytes, values, count) FP_PROFILE_SCOPE(uint8_t*, __fp_varint_encode((void**)&bytes, (values), (count), false))
+// Appends the varint encoding of the gaps between \p count sorted values (the first relative to 0) to the fp_dynarray(uint8_t) \p bytes
+#define fp_varint_encode_delta(bytes, values, count) FP_PROFILE_SCOPE(uint8_t*, __fp_varint_encode((void**)&bytes, (values), (count), true))
+
+// Number of values encoded in \p byte_count bytes (the number of bytes without their high bit set), counted a word at a time
+inline static size_t fp_varint_count(const uint8_t* bytes, size_t byte_count) FP_NOEXCEPT {
+	size_t count = 0, i = 0;
+	for(; i + sizeof(uint64_t) <= byte_count; i += sizeof(uint64_t)) {
+		uint64_t x;
+		memcpy(&x, bytes + i, sizeof(x));
+		count += fp_popcount64(~x & 0x8080808080808080ull);
+	}
+	for(; i < byte_count; ++i)
+		count += !(bytes[i] & 0x80);
+	return count;
+}
+
+/**
+* @brief Decodes up to \p count values from \p byte_count bytes into \p out
+* @note Runs of 8 single byte values are decoded together
+* @param delta whether the values were encoded with fp_varint_encode_delta
+* @return the number of values decoded
+*/
+inline static size_t fp_varint_decode(const uint8_t* bytes, size_t byte_count, uint64_t* out, size_t count, bool delta) FP_NOEXCEPT {
+	const uint8_t* cursor = bytes, *end = bytes + byte_count;
+	uint64_t previous = 0;
+	size_t decoded = 0;
+	while(decoded < count) {
+		if(end - cursor >= 8 && count - decoded >= 8) {
+			uint64_t x;
+			memcpy(&x, cursor, sizeof(x));
+			if(!(x & 0x8080808080808080ull)) {
+				for(size_t i = 0; i < 8; ++i) {
+					uint64_t value = (x >> (8 * i)) & 0xFF;
+					out[decoded++] = delta ? (previous += value) : value;
+				}
+				cursor += 8;
+				continue;
+			}
+		}
+
+		uint64_t value;
+		const uint8_t* next = fp_varint_read(cursor, end, &value);
+		if(!next) break;
+		cursor = next;
+		out[decoded++] = delta ? (previous += value) : value;
+	}
+	return decoded;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __LIB_FAT_POINTER_COMPRESSED_H__
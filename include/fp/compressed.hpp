@@ -0,0 +1,108 @@
+#pragma once
+
+#include <utility>
+
+#include "dynarray.hpp"
+#include "compressed.h"
+
+namespace fp {
+
+	// Array of unsigned integers which all share the same bit width
+	struct packed_array {
+		explicit packed_array(unsigned width = 0) { fp_packed_array_init(&a, width); }
+		// Stores values in the fewest bits which fit the largest of them
+		explicit packed_array(view<const uint64_t> values) : packed_array() { fp_packed_array_assign(&a, values.data(), values.size()); }
+		packed_array(const packed_array& o) : packed_array(o.width()) { *this = o; }
+		packed_array(packed_array&& o) : packed_array() { std::swap(a, o.a); }
+		packed_array& operator=(const packed_array& o) {
+			if(this == &o) return *this;
+			fp_packed_array_free(&a);
+			a.width = o.a.width;
+			a.size = o.a.size;
+			if(o.a.words) a.words = fpda_clone(o.a.words);
+			return *this;
+		}
+		packed_array& operator=(packed_array&& o) { if(this != &o) std::swap(a, o.a); return *this; }
+		~packed_array() { fp_packed_array_free(&a); }
+
+		inline size_t size() const { return fp_packed_array_size(&a); }
+		inline bool empty() const { return fp_packed_array_empty(&a); }
+		inline unsigned width() const { return fp_packed_array_width(&a); }
+		inline size_t bytes() const { return fp_packed_array_bytes(&a); }
+
+		inline uint64_t get(size_t i) const { return fp_packed_array_get(&a, i); }
+		inline uint64_t operator[](size_t i) const { return get(i); }
+		// NOTE: value must fit in width() bits
+		inline packed_array& set(size_t i, uint64_t value) { fp_packed_array_set(&a, i, value); return *this; }
+		inline packed_array& push_back(uint64_t value) { fp_packed_array_push_back(&a, value); return *this; }
+
+		inline void unpack(size_t first, view<uint64_t> out) const { fp_packed_array_unpack(&a, first, out.size(), out.data()); }
+		inline raii::dynarray<uint64_t> unpack() const {
+			raii::dynarray<uint64_t> out;
+			out.resize(size());
+			unpack(0, out.full_view());
+			return out;
+		}
+
+	protected:
+		fp_packed_array a;
+	};
+
+	// Frame-of-reference encoded array, optionally storing the gaps between (sorted) values
+	struct for_array {
+		for_array() { fp_for_array_init(&a); }
+		explicit for_array(view<const uint64_t> values, bool delta = false) : for_array() { fp_for_array_encode(&a, values.data(), values.size(), delta); }
+		for_array(const for_array& o) : for_array() { *this = o; }
+		for_array(for_array&& o) : for_array() { std::swap(a, o.a); }
+		for_array& operator=(const for_array& o) {
+			if(this == &o) return *this;
+			fp_for_array_free(&a);
+			a.size = o.a.size;
+			a.delta = o.a.delta;
+			if(o.a.blocks) a.blocks = fpda_clone(o.a.blocks);
+			if(o.a.words) a.words = fpda_clone(o.a.words);
+			return *this;
+		}
+		for_array& operator=(for_array&& o) { if(this != &o) std::swap(a, o.a); return *this; }
+		~for_array() { fp_for_array_free(&a); }
+
+		inline size_t size() const { return fp_for_array_size(&a); }
+		inline bool empty() const { return fp_for_array_empty(&a); }
+		inline bool is_delta() const { return a.delta; }
+		inline size_t bytes() const { return fp_for_array_bytes(&a); }
+
+		inline uint64_t get(size_t i) const { return fp_for_array_get(&a, i); }
+		inline uint64_t operator[](size_t i) const { return get(i); }
+		// NOTE: The array must be sorted
+		inline size_t lower_bound(uint64_t value) const { return fp_for_array_lower_bound(&a, value); }
+
+		inline void decode(size_t first, view<uint64_t> out) const { fp_for_array_decode(&a, first, out.size(), out.data()); }
+		inline raii::dynarray<uint64_t> decode() const {
+			raii::dynarray<uint64_t> out;
+			out.resize(size());
+			decode(0, out.full_view());
+			return out;
+		}
+
+	protected:
+		fp_for_array a;
+	};
+
+	// Varint encodes values (or the gaps between sorted values when delta is set) onto the end of bytes
+	inline void varint_encode(raii::dynarray<uint8_t>& bytes, view<const uint64_t> values, bool delta = false) {
+		if(delta) fp_varint_encode_delta(bytes.raw, values.data(), values.size());
+		else fp_varint_encode(bytes.raw, values.data(), values.size());
+	}
+	inline raii::dynarray<uint8_t> varint_encode(view<const uint64_t> values, bool delta = false) {
+		raii::dynarray<uint8_t> out;
+		varint_encode(out, values, delta);
+		return out;
+	}
+	// Decodes every value in bytes
+	inline raii::dynarray<uint64_t> varint_decode(view<const uint8_t> bytes, bool delta = false) {
+		raii::dynarray<uint64_t> out;
+		out.resize(fp_varint_count(bytes.data(), bytes.size()));
+		fp_varint_decode(bytes.data(), bytes.size(), out.data(), out.size(), delta);
+		return out;
+	}
+}
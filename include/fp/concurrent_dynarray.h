@@ -0,0 +1,177 @@
+#ifndef __LIB_FAT_POINTER_CONCURRENT_DYNARRAY_H__
+#define __LIB_FAT_POINTER_CONCURRENT_DYNARRAY_H__
+
+// Append-only array which many threads can write into at once
+// Writers reserve ranges of indices with a single atomic add, and the storage grows in chunks which never move,
+// so elements can be written (and pointed to) while other threads keep appending
+// Once every writer is done the array is frozen into a regular (contiguous) dynarray
+
+#include "dynarray.h"
+#include "atomic.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Chunk k holds (first chunk size) << k elements, so this many chunks are enough for any realistic array
+#ifndef FP_CONCURRENT_DYNARRAY_MAX_CHUNKS
+#define FP_CONCURRENT_DYNARRAY_MAX_CHUNKS 40
+#endif
+
+struct fp_concurrent_dynarray {
+	size_t element_size;
+	size_t first_chunk_shift; // Log2 of the number of elements in the first chunk
+	fp_allocator_id allocator;
+	FP_ATOMIC(uint8_t*) chunks[FP_CONCURRENT_DYNARRAY_MAX_CHUNKS]; // The first chunk is a dynarray (which becomes the frozen array), the rest are fat pointers
+	uint8_t padding0[FP_CACHE_LINE_SIZE];
+
+	FP_ATOMIC(size_t) reserved; // Number of indices handed out to writers
+	uint8_t padding1[FP_CACHE_LINE_SIZE - sizeof(size_t)];
+
+	FP_ATOMIC(size_t) committed; // Number of elements writers have finished writing
+	uint8_t padding2[FP_CACHE_LINE_SIZE - sizeof(size_t)];
+};
+
+/**
+* @brief Creates an empty array of elements \p element_size bytes large
+* @param expected_size how many elements the array is expected to hold (rounded up to a power of two), arrays which stay
+*	within it are frozen without copying any elements
+*/
+inline static void fp_concurrent_dynarray_init_in(struct fp_concurrent_dynarray* a, size_t element_size, size_t expected_size, fp_allocator_id allocator) FP_NOEXCEPT {
+	assert(element_size > 0);
+	a->element_size = element_size;
+	a->first_chunk_shift = fp_floor_log2(fp_upper_power_of_two(expected_size ? expected_size : 1));
+	a->allocator = allocator;
+	for(size_t i = 0; i < FP_CONCURRENT_DYNARRAY_MAX_CHUNKS; ++i)
+		fp_atomic_store(a->chunks + i, NULL, relaxed);
+	fp_atomic_store(&a->reserved, 0, relaxed);
+	fp_atomic_store(&a->committed, 0, relaxed);
+}
+#define fp_concurrent_dynarray_init(a, element_size, expected_size) fp_concurrent_dynarray_init_in((a), (element_size), (expected_size), FP_DEFAULT_ALLOCATOR)
+
+inline static size_t __fp_concurrent_dynarray_chunk_size(const struct fp_concurrent_dynarray* a, size_t chunk) FP_NOEXCEPT {
+	return ((size_t)1) << (a->first_chunk_shift + chunk);
+}
+
+// Finds which chunk the element at \p index lives in and where in that chunk it is
+inline static size_t __fp_concurrent_dynarray_locate(const struct fp_concurrent_dynarray* a, size_t index, size_t* offset) FP_NOEXCEPT {
+	size_t chunk = fp_floor_log2((index >> a->first_chunk_shift) + 1);
+	assert(chunk < FP_CONCURRENT_DYNARRAY_MAX_CHUNKS);
+	*offset = index - ((((size_t)1) << chunk) - 1) * (((size_t)1) << a->first_chunk_shift);
+	return chunk;
+}
+
+// Returns the chunk, allocating it if no other thread has yet (if two threads race the loser frees its copy)
+inline static uint8_t* __fp_concurrent_dynarray_chunk(struct fp_concurrent_dynarray* a, size_t chunk) FP_NOEXCEPT {
+	uint8_t* existing = fp_atomic_load(a->chunks + chunk, acquire);
+	if(existing) return existing;
+
+	void* fresh = NULL;
+	size_t size = __fp_concurrent_dynarray_chunk_size(a, chunk);
+	if(chunk == 0) __fpda_maybe_grow_in(&fresh, a->element_size, size, false, true, a->allocator);
+	else fresh = __fp_malloc_in(a->element_size, size, a->allocator);
+	if(fp_atomic_compare_exchange_strong(a->chunks + chunk, &existing, (uint8_t*)fresh, acq_rel, acquire))
+		return (uint8_t*)fresh;
+
+	if(chunk == 0) fpda_free(fresh);
+	else fp_free(fresh);
+	return existing;
+}
+
+/**
+* @brief Reserves \p count consecutive indices for the calling thread to write
+* @note The elements must be written (through fp_concurrent_dynarray_get) and then committed before the array is frozen
+* @return the index of the first reserved element
+*/
+inline static size_t fp_concurrent_dynarray_reserve(struct fp_concurrent_dynarray* a, size_t count) FP_NOEXCEPT {
+	return fp_atomic_fetch_add(&a->reserved, count, relaxed);
+}
+// Marks \p count reserved elements as written, makes the writes visible to whoever freezes the array
+inline static void fp_concurrent_dynarray_commit(struct fp_concurrent_dynarray* a, size_t count) FP_NOEXCEPT {
+	fp_atomic_fetch_add(&a->committed, count, release);
+}
+
+// Address of the element at \p index, which never changes until the array is frozen (or freed)
+inline static void* fp_concurrent_dynarray_get(struct fp_concurrent_dynarray* a, size_t index) FP_NOEXCEPT {
+	size_t offset, chunk = __fp_concurrent_dynarray_locate(a, index, &offset);
+	return __fp_concurrent_dynarray_chunk(a, chunk) + offset * a->element_size;
+}
+#define fp_concurrent_dynarray_get_typed(type, a, index) ((type*)fp_concurrent_dynarray_get((a), (index)))
+
+// Copies \p count elements into the array starting at (the already reserved) index \p start and commits them
+inline static void fp_concurrent_dynarray_write(struct fp_concurrent_dynarray* a, size_t start, const void* data, size_t count) FP_NOEXCEPT {
+	const uint8_t* source = (const uint8_t*)data;
+	for(size_t remaining = count; remaining; ) {
+		size_t offset, chunk = __fp_concurrent_dynarray_locate(a, start, &offset);
+		size_t run = __fp_concurrent_dynarray_chunk_size(a, chunk) - offset;
+		if(run > remaining) run = remaining;
+		memcpy(__fp_concurrent_dynarray_chunk(a, chunk) + offset * a->element_size, source, run * a->element_size);
+		source += run * a->element_size;
+		start += run;
+		remaining -= run;
+	}
+	fp_concurrent_dynarray_commit(a, count);
+}
+
+// Reserves room for and writes \p count elements, returns the index of the first one
+inline static size_t fp_concurrent_dynarray_append(struct fp_concurrent_dynarray* a, const void* data, size_t count) FP_NOEXCEPT {
+	size_t start = fp_concurrent_dynarray_reserve(a, count);
+	fp_concurrent_dynarray_write(a, start, data, count);
+	return start;
+}
+#define fp_concurrent_dynarray_push_back(a, value_pointer) fp_concurrent_dynarray_append((a), (value_pointer), 1)
+
+// NOTE: Includes elements which are reserved but might not have been written yet
+inline static size_t fp_concurrent_dynarray_size(struct fp_concurrent_dynarray* a) FP_NOEXCEPT {
+	return fp_atomic_load(&a->reserved, acquire);
+}
+
+/**
+* @brief Moves every element into a single dynarray and leaves the array empty (ready to be reused)
+* @note Must only be called once all writers are done, and every reserved element has been committed
+* @note The first chunk is reallocated to the final size (usually in place) so its elements are never copied
+*/
+inline static void* fp_concurrent_dynarray_freeze(struct fp_concurrent_dynarray* a) FP_NOEXCEPT {
+	size_t size = fp_atomic_load(&a->reserved, acquire);
+	assert(fp_atomic_load(&a->committed, acquire) == size); // Some reserved elements were never written!
+	if(size == 0) {
+		fpda_free(fp_atomic_exchange(a->chunks, NULL, relaxed));
+		return NULL;
+	}
+
+	void* out = __fp_concurrent_dynarray_chunk(a, 0);
+	// The first chunk was filled without updating its size, mark its elements live so they survive a copying reallocation (like moving into a mapping)
+	size_t first_size = __fp_concurrent_dynarray_chunk_size(a, 0);
+	__fpda_header(out)->h.size = size < first_size ? size : first_size;
+	__fpda_maybe_grow(&out, a->element_size, size, true, true);
+	fp_atomic_store(a->chunks, NULL, relaxed);
+	for(size_t chunk = 1; chunk < FP_CONCURRENT_DYNARRAY_MAX_CHUNKS; ++chunk) {
+		uint8_t* p = fp_atomic_exchange(a->chunks + chunk, NULL, relaxed);
+		if(!p) continue;
+		size_t start = ((((size_t)1) << chunk) - 1) << a->first_chunk_shift; // Index of the chunk's first element
+		if(start < size) {
+			size_t run = __fp_concurrent_dynarray_chunk_size(a, chunk);
+			if(run > size - start) run = size - start;
+			memcpy(((uint8_t*)out) + start * a->element_size, p, run * a->element_size);
+		}
+		fp_free(p);
+	}
+	fp_atomic_store(&a->reserved, 0, relaxed);
+	fp_atomic_store(&a->committed, 0, relaxed);
+	return out;
+}
+#define fp_concurrent_dynarray_freeze_typed(type, a) ((fp_dynarray(type))fp_concurrent_dynarray_freeze(a))
+
+inline static void fp_concurrent_dynarray_free(struct fp_concurrent_dynarray* a) FP_NOEXCEPT {
+	fpda_free(fp_atomic_exchange(a->chunks, NULL, relaxed));
+	for(size_t chunk = 1; chunk < FP_CONCURRENT_DYNARRAY_MAX_CHUNKS; ++chunk)
+		fp_free(fp_atomic_exchange(a->chunks + chunk, NULL, relaxed));
+	fp_atomic_store(&a->reserved, 0, relaxed);
+	fp_atomic_store(&a->committed, 0, relaxed);
+}
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // __LIB_FAT_POINTER_CONCURRENT_DYNARRAY_H__
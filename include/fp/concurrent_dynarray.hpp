@@ -0,0 +1,43 @@
+#pragma once
+
+#include <type_traits>
+
+#include "dynarray.hpp"
+#include "concurrent_dynarray.h"
+
+namespace fp {
+
+	// Append-only array any number of threads can push into at once, elements never move until the array is frozen
+	// NOTE: Elements are copied bytewise into the array, so they must be trivially copyable
+	template<typename T>
+	struct concurrent_dynarray {
+		static_assert(std::is_trivially_copyable_v<T>, "Concurrent dynarray elements are copied bytewise");
+
+		explicit concurrent_dynarray(size_t expected_size = 0, fp_allocator_id allocator = FP_DEFAULT_ALLOCATOR) {
+			fp_concurrent_dynarray_init_in(&a, sizeof(T), expected_size, allocator);
+		}
+		concurrent_dynarray(const concurrent_dynarray&) = delete;
+		concurrent_dynarray& operator=(const concurrent_dynarray&) = delete;
+		~concurrent_dynarray() { fp_concurrent_dynarray_free(&a); }
+
+		// NOTE: Includes elements other threads have reserved but not yet written
+		inline size_t size() { return fp_concurrent_dynarray_size(&a); }
+
+		// Both return the index of the (first) new element
+		inline size_t push_back(const T& value) { return fp_concurrent_dynarray_push_back(&a, &value); }
+		inline size_t append_range(view<const T> values) { return fp_concurrent_dynarray_append(&a, values.data(), values.size()); }
+
+		// Reserve then commit, for callers which want to construct their elements in place
+		inline size_t reserve(size_t count) { return fp_concurrent_dynarray_reserve(&a, count); }
+		inline void commit(size_t count) { fp_concurrent_dynarray_commit(&a, count); }
+
+		// NOTE: The reference stays valid until the array is frozen
+		inline T& operator[](size_t i) { return *fp_concurrent_dynarray_get_typed(T, &a, i); }
+
+		// Moves every element into a regular dynarray, must only be called once all writers are done
+		inline raii::dynarray<T> freeze() { return fp_concurrent_dynarray_freeze_typed(T, &a); }
+
+	protected:
+		fp_concurrent_dynarray a;
+	};
+}
@@ -0,0 +1,212 @@
+#ifndef __LIB_FAT_POINTER_DEQUE_H__
+#define __LIB_FAT_POINTER_DEQUE_H__
+
+#include "dynarray.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// A deque is a ring buffer of elements, the pointer points to the start of the buffer (not the front element!)
+// NOTE: Elements should be accessed through fp_deque_get or the views returned by fp_deque_segment, since the front element can live anywhere in the buffer
+#define fp_deque(type) type*
+
+struct __FatDequeHeader {
+	fp_header_size_t head; // Index (into the buffer) of the front element
+	fp_header_size_t capacity; // Always a power of two, NOTE: Must directly precede the fat pointer header (like a dynarray's) so that is_fp works on deques
+	struct __FatPointerHeader h; // h.size is the number of elements in the deque
+};
+#ifndef __cplusplus
+	#define FP_DEQUE_HEADER_SIZE sizeof(struct __FatDequeHeader)
+#else
+	static constexpr size_t FP_DEQUE_HEADER_SIZE = sizeof(__FatDequeHeader) - detail::completed_sizeof_v<decltype(__FatPointerHeader{}.data)>;
+#endif
+
+inline static struct __FatDequeHeader* __fp_deque_header(const void* q) FP_NOEXCEPT {
+	assert(q);
+	return (struct __FatDequeHeader*)(((uint8_t*)q) - FP_DEQUE_HEADER_SIZE);
+}
+
+inline static bool is_fp_deque(const void* q) FP_NOEXCEPT { return fp_magic_number(q) == FP_DEQUE_MAGIC_NUMBER; }
+
+#define fp_deque_size fp_size
+#define fp_deque_length fp_length
+#define fp_deque_empty fp_empty
+inline static size_t fp_deque_capacity(const void* q) FP_NOEXCEPT { return q ? __fp_deque_header(q)->capacity : 0; }
+
+// Maps the \p index th element of the deque (counting from the front) to its index in the buffer
+inline static size_t __fp_deque_index(const void* q, size_t index) FP_NOEXCEPT {
+	assert(index < fp_size(q));
+	auto h = __fp_deque_header(q);
+	return (h->head + index) & (h->capacity - 1);
+}
+#define fp_deque_get(q, index) ((q)[__fp_deque_index((q), (index))])
+#define fp_deque_front(q) ((q) + __fp_deque_index((q), 0))
+#define fp_deque_back(q) ((q) + __fp_deque_index((q), fp_size(q) - 1))
+
+/**
+* @brief Makes sure the deque can hold at least \p required elements, creating it in \p allocator if it doesn't exist yet
+* @note The buffer is reallocated (giving the allocator a chance to resize it in place), and then whichever part of a
+*	wrapped around deque is shorter is moved so that the deque is contiguous (modulo the new capacity) again
+*/
+inline static struct __FatDequeHeader* __fp_deque_reserve_in(void** q, size_t type_size, size_t required, fp_allocator_id allocator) FP_NOEXCEPT {
+	if(*q && required <= __fp_deque_header(*q)->capacity) return __fp_deque_header(*q);
+
+	size_t minimum = FPDA_DEFAULT_SIZE_BYTES / type_size;
+	size_t capacity = fp_upper_power_of_two(required > minimum ? required : minimum);
+	size_t bytes = FP_DEQUE_HEADER_SIZE + type_size * capacity;
+	struct __FatDequeHeader* h;
+	if(*q == NULL) {
+		h = (struct __FatDequeHeader*)__fp_alloc_aligned_in(NULL, bytes, allocator, 0, FP_DEQUE_HEADER_SIZE);
+		h->head = 0;
+		h->h.magic = FP_DEQUE_MAGIC_NUMBER;
+		h->h.allocator = allocator;
+		__fp_header_set_alignment(&h->h, 0, 0);
+		h->h.size = 0;
+	} else {
+		h = __fp_deque_header(*q);
+		size_t old_capacity = h->capacity;
+#ifdef FP_ENABLE_PROFILING
+		__fp_header(h)->size = FP_DEQUE_HEADER_SIZE + type_size * h->h.size; // Let the reallocation event see how many bytes are live
+#endif
+		h = (struct __FatDequeHeader*)__fp_alloc_aligned_in(h, bytes, FP_DEFAULT_ALLOCATOR, 0, FP_DEQUE_HEADER_SIZE);
+		FP_PROFILE_REALLOCATED_EVENT(FP_PROFILE_GROW, h->h.data, type_size * capacity, type_size * old_capacity);
+
+		size_t size = h->h.size, front = old_capacity - h->head; // Elements between the head and the end of the old buffer
+		if(size > front) { // Wrapped around
+			size_t wrapped = size - front;
+			if(wrapped <= front) // Move the wrapped elements after the old end
+				memcpy(h->h.data + type_size * old_capacity, h->h.data, type_size * wrapped);
+			else { // Move the front elements to the end of the new buffer
+				memcpy(h->h.data + type_size * (capacity - front), h->h.data + type_size * h->head, type_size * front);
+				h->head = capacity - front;
+			}
+		}
+	}
+	h->capacity = capacity;
+	*q = h->h.data;
+	return h;
+}
+#define fp_deque_reserve(q, _size) ((void)FP_PROFILE_SCOPE(void*, __fp_deque_reserve_in((void**)&q, sizeof(*q), (_size), FP_DEFAULT_ALLOCATOR)))
+#define fp_deque_reserve_in(q, _size, allocator) ((void)FP_PROFILE_SCOPE(void*, __fp_deque_reserve_in((void**)&q, sizeof(*q), (_size), (allocator))))
+
+inline static void fp_deque_free(void* q) FP_NOEXCEPT {
+	if(q) __fp_alloc(__fp_deque_header(q), 0);
+}
+#define fp_deque_free_and_null(q) (FP_PROFILE_SCOPE_VOID(fp_deque_free(q)), q = NULL)
+
+inline static void fp_deque_clear(void* q) FP_NOEXCEPT {
+	if(!q) return;
+	auto h = __fp_deque_header(q);
+	h->head = 0;
+	h->h.size = 0;
+}
+
+// NOTE: The push functions return a pointer to the (uninitialized) slot for the new element
+inline static void* __fp_deque_push_back(void** q, size_t type_size) FP_NOEXCEPT {
+	auto h = __fp_deque_reserve_in(q, type_size, fp_size(*q) + 1, FP_DEFAULT_ALLOCATOR);
+	size_t index = (h->head + h->h.size++) & (h->capacity - 1);
+	return h->h.data + type_size * index;
+}
+inline static void* __fp_deque_push_front(void** q, size_t type_size) FP_NOEXCEPT {
+	auto h = __fp_deque_reserve_in(q, type_size, fp_size(*q) + 1, FP_DEFAULT_ALLOCATOR);
+	h->head = (h->head - 1) & (h->capacity - 1);
+	++h->h.size;
+	return h->h.data + type_size * h->head;
+}
+#define fp_deque_push_back(q, value) (*FP_PROFILE_SCOPE(FP_TYPE_OF(*q)*, __fp_deque_push_back((void**)&q, sizeof(*q))) = (value))
+#define fp_deque_push_front(q, value) (*FP_PROFILE_SCOPE(FP_TYPE_OF(*q)*, __fp_deque_push_front((void**)&q, sizeof(*q))) = (value))
+
+// NOTE: The pop functions return the buffer index of the removed element, its value stays valid until the next push
+inline static size_t __fp_deque_pop_front(void* q) FP_NOEXCEPT {
+	assert(fp_size(q) > 0);
+	auto h = __fp_deque_header(q);
+	size_t index = h->head;
+	h->head = (h->head + 1) & (h->capacity - 1);
+	--h->h.size;
+	return index;
+}
+inline static size_t __fp_deque_pop_back(void* q) FP_NOEXCEPT {
+	assert(fp_size(q) > 0);
+	auto h = __fp_deque_header(q);
+	return (h->head + --h->h.size) & (h->capacity - 1);
+}
+// NOTE: The pop macros evaluate to the removed element, use fp_deque_drop_front/back to discard elements (or cast to void)
+#define fp_deque_pop_front(q) ((q)[__fp_deque_pop_front(q)])
+#define fp_deque_pop_back(q) ((q)[__fp_deque_pop_back(q)])
+
+// Removes \p count elements from the front (or back) of the deque without looking at them
+inline static void fp_deque_drop_front(void* q, size_t count) FP_NOEXCEPT {
+	if(count == 0) return;
+	assert(count <= fp_size(q));
+	auto h = __fp_deque_header(q);
+	h->head = (h->head + count) & (h->capacity - 1);
+	h->h.size -= count;
+}
+inline static void fp_deque_drop_back(void* q, size_t count) FP_NOEXCEPT {
+	if(count == 0) return;
+	assert(count <= fp_size(q));
+	__fp_deque_header(q)->h.size -= count;
+}
+
+/**
+* @brief Views one of the (at most two) contiguous runs of elements which make up the deque
+* @param second false for the run starting with the front element, true for the run (possibly empty) which wrapped around to the start of the buffer
+*/
+inline static fp_void_view __fp_deque_segment(const void* q, size_t type_size, bool second) FP_NOEXCEPT {
+	size_t size = fp_size(q);
+	if(size == 0) return fp_void_view_literal(q, 0);
+	auto h = __fp_deque_header(q);
+	size_t front = h->capacity - h->head;
+	if(front > size) front = size;
+	if(second) return fp_void_view_literal(h->h.data, size - front);
+	return fp_void_view_literal(h->h.data + type_size * h->head, front);
+}
+#define fp_deque_segment(type, q, second) ((fp_view(type))__fp_deque_segment((q), sizeof(type), (second)))
+
+// Appends \p count elements to the back of the deque, copying them in (at most) two chunks
+inline static void* __fp_deque_append_n(void** q, size_t type_size, const void* data, size_t count) FP_NOEXCEPT {
+	if(count == 0) return *q;
+	auto h = __fp_deque_reserve_in(q, type_size, fp_size(*q) + count, FP_DEFAULT_ALLOCATOR);
+	size_t tail = (h->head + h->h.size) & (h->capacity - 1);
+	size_t first = h->capacity - tail < count ? h->capacity - tail : count;
+	memcpy(h->h.data + type_size * tail, data, type_size * first);
+	memcpy(h->h.data, ((const uint8_t*)data) + type_size * first, type_size * (count - first));
+	h->h.size += count;
+	return *q;
+}
+#define fp_deque_append_n(q, data, count) ((void)FP_PROFILE_SCOPE(void*, __fp_deque_append_n((void**)&q, sizeof(*q), (data), (count))))
+#define fp_deque_append_view(q, view) ((void)FP_PROFILE_SCOPE(void*, __fp_deque_append_n((void**)&q, sizeof(*q), fp_view_data_void(view), fp_view_size(view))))
+
+// Copies up to \p count elements from the front of the deque into \p dest and removes them, returns how many were copied
+inline static size_t __fp_deque_pop_front_n(void* q, size_t type_size, void* dest, size_t count) FP_NOEXCEPT {
+	size_t size = fp_size(q);
+	if(count > size) count = size;
+	if(count == 0) return 0;
+	auto first = __fp_deque_segment(q, type_size, false);
+	size_t from_first = fp_view_size(first) < count ? fp_view_size(first) : count;
+	memcpy(dest, fp_view_data_void(first), type_size * from_first);
+	memcpy(((uint8_t*)dest) + type_size * from_first, q, type_size * (count - from_first));
+	fp_deque_drop_front(q, count);
+	return count;
+}
+#define fp_deque_pop_front_n(q, dest, count) __fp_deque_pop_front_n((q), sizeof(*(q)), (dest), (count))
+
+// Copies the deque into a new buffer (in the same allocator), the copy's front element is at the start of its buffer
+inline static void* __fp_deque_clone(const void* q, size_t type_size) FP_NOEXCEPT {
+	if(!q) return NULL;
+	void* out = NULL;
+	__fp_deque_reserve_in(&out, type_size, __fp_deque_header(q)->capacity, fp_allocator_of(q));
+	auto first = __fp_deque_segment(q, type_size, false);
+	auto second = __fp_deque_segment(q, type_size, true);
+	__fp_deque_append_n(&out, type_size, fp_view_data_void(first), fp_view_size(first));
+	__fp_deque_append_n(&out, type_size, fp_view_data_void(second), fp_view_size(second));
+	return out;
+}
+#define fp_deque_clone(q) FP_PROFILE_SCOPE(FP_TYPE_OF(*q)*, __fp_deque_clone((q), sizeof(*(q))))
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // __LIB_FAT_POINTER_DEQUE_H__
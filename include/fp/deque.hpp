@@ -0,0 +1,121 @@
+#pragma once
+
+#include <initializer_list>
+#include <iterator>
+
+#include "pointer.hpp"
+#include "deque.h"
+
+namespace fp {
+
+	template<typename T, typename Derived>
+	struct deque_crtp {
+		struct iterator {
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = T;
+			using difference_type = std::ptrdiff_t;
+			using pointer = T*;
+			using reference = T&;
+
+			T* buffer;
+			size_t index; // Counted from the front of the deque
+
+			inline T& operator*() const { return fp_deque_get(buffer, index); }
+			inline T* operator->() const { return &fp_deque_get(buffer, index); }
+			inline iterator& operator++() { ++index; return *this; }
+			inline iterator operator++(int) { auto out = *this; ++index; return out; }
+			inline bool operator==(const iterator& o) const { return index == o.index; }
+		};
+
+		inline bool is_deque() const { return is_fp_deque(ptr()); }
+		inline size_t size() const { return fp_deque_size(ptr()); }
+		inline size_t length() const { return fp_deque_length(ptr()); }
+		inline bool empty() const { return fp_deque_empty(ptr()); }
+		inline size_t capacity() const { return fp_deque_capacity(ptr()); }
+		inline operator bool() const { return ptr() != nullptr; }
+
+		inline void free() { fp_deque_free(ptr()); }
+		inline void free_and_null() { fp_deque_free_and_null(ptr()); }
+
+		// NOTE: The allocator is only used if the deque hasn't been allocated yet
+		inline Derived& reserve(size_t size, fp_allocator_id allocator = FP_DEFAULT_ALLOCATOR) {
+			fp_deque_reserve_in(ptr(), size, allocator);
+			return *derived();
+		}
+
+		inline T& push_back(const T& value) { return fp_deque_push_back(ptr(), value); }
+		inline T& push_front(const T& value) { return fp_deque_push_front(ptr(), value); }
+		// NOTE: The popped element stays valid until the next push
+		inline T& pop_front() { return fp_deque_pop_front(ptr()); }
+		inline T& pop_back() { return fp_deque_pop_back(ptr()); }
+
+		inline Derived& drop_front(size_t count) {
+			fp_deque_drop_front(ptr(), count);
+			return *derived();
+		}
+		inline Derived& drop_back(size_t count) {
+			fp_deque_drop_back(ptr(), count);
+			return *derived();
+		}
+		inline Derived& clear() {
+			fp_deque_clear(ptr());
+			return *derived();
+		}
+
+		inline Derived& append_range(view<const T> range) {
+			fp_deque_append_n(ptr(), range.data(), range.size());
+			return *derived();
+		}
+		inline Derived& append_range(std::initializer_list<T> range) { return append_range(view<const T>{range.begin(), range.size()}); }
+		// Copies up to dest.size() elements from the front of the deque into dest and removes them, returns how many were copied
+		inline size_t pop_front_range(view<T> dest) { return fp_deque_pop_front_n(ptr(), dest.data(), dest.size()); }
+
+		// The elements starting with the front one, and the elements (possibly none) which wrapped around to the start of the buffer
+		inline view<T> first_segment() { return {fp_deque_segment(T, ptr(), false)}; }
+		inline view<T> second_segment() { return {fp_deque_segment(T, ptr(), true)}; }
+
+		inline T& operator[](size_t i) { return fp_deque_get(ptr(), i); }
+		inline const T& operator[](size_t i) const { return fp_deque_get(ptr(), i); }
+		inline T& front() { return *fp_deque_front(ptr()); }
+		inline T& back() { return *fp_deque_back(ptr()); }
+
+		inline iterator begin() { return {ptr(), 0}; }
+		inline iterator end() { return {ptr(), size()}; }
+
+		inline Derived clone() const { return fp_deque_clone(ptr()); }
+
+	protected:
+		inline Derived* derived() { return (Derived*)this; }
+		inline const Derived* derived() const { return (Derived*)this; }
+		inline T*& ptr() { return derived()->raw; }
+		inline T* const & ptr() const { return derived()->raw; }
+	};
+
+	// Ring buffer with O(1) pushes and pops at both ends, elements are copied bytewise when it grows (like a dynarray's)
+	template<typename T>
+	struct deque: public deque_crtp<T, deque<T>> {
+		T* raw;
+
+		deque(): raw(nullptr) {}
+		deque(std::nullptr_t): raw(nullptr) {}
+		deque(T* ptr): raw(ptr) { assert(ptr == nullptr || is_fp_deque(ptr)); }
+	};
+
+	namespace raii {
+		template<typename T>
+		struct deque: public fp::deque<T> {
+			using super = fp::deque<T>;
+			using super::raw;
+
+			deque(): super(nullptr) {}
+			deque(T* ptr): super(ptr) {}
+			deque(const fp::deque<T>& o): super(o.clone()) {}
+			deque(fp::deque<T>&& o): super(std::exchange(o.raw, nullptr)) {}
+			deque(const deque& o): super(o.clone()) {}
+			deque(deque&& o): super(std::exchange(o.raw, nullptr)) {}
+			deque& operator=(const deque& o) { if(this != &o) { super::free(); raw = o.clone().raw; } return *this; }
+			deque& operator=(deque&& o) { if(this != &o) { super::free(); raw = std::exchange(o.raw, nullptr); } return *this; }
+			~deque() { super::free_and_null(); }
+		};
+	}
+}
@@ -26,8 +26,123 @@ FP_CONSTEXPR inline static uint64_t fp_upper_power_of_two(uint64_t v) FP_NOEXCEP
 	return v;
 }
 
+// Index of the highest set bit of \p v (which must not be zero)
+FP_CONSTEXPR inline static size_t fp_floor_log2(uint64_t v) FP_NOEXCEPT {
+	assert(v);
+#if defined(__GNUC__) || defined(__clang__)
+	return 63 - __builtin_clzll(v);
+#else
+	size_t log = 0;
+	while(v >>= 1) ++log;
+	return log;
+#endif
+}
+
+/**
+* @brief Decides how much room a dynarray should have once it needs more than its current capacity
+* @param userdata the userdata pointer the policy was registered with
+* @param capacity the current capacity (in elements) of the array
+* @param required the number of elements the array must be able to hold, always larger than \p capacity
+* @return the new capacity (in elements), must be at least \p required
+*/
+typedef size_t(*fp_growth_function_t)(void* userdata, size_t capacity, size_t required) FP_NOEXCEPT;
+
+struct fp_growth_policy {
+	fp_growth_function_t grow;
+	void* userdata;
+	float shrink_below; // Once deleting elements leaves the array less than this fraction full, it is shrunk back to where it would grow to from its size (0 to never shrink)
+};
+
+// Index into the growth policy registry, every dynarray remembers the id of the policy it grows by
+typedef uint16_t fp_growth_policy_id;
+#define FP_GROWTH_POWER_OF_TWO ((fp_growth_policy_id)0) // Rounds capacities up to the next power of two and never shrinks (the default)
+#define FP_GROWTH_DOUBLE ((fp_growth_policy_id)1) // Doubles the capacity and shrinks once less than a quarter full
+#define FP_GROWTH_ONE_AND_A_HALF ((fp_growth_policy_id)2) // Grows the capacity by half and shrinks once less than a third full
+#define __FP_BUILTIN_GROWTH_POLICIES 3
+
+#ifndef FP_MAX_GROWTH_POLICIES
+#define FP_MAX_GROWTH_POLICIES 16 // NOTE: Must not exceed 128 when FP_COMPACT_HEADERS is defined
+#endif
+
+inline static size_t fp_growth_power_of_two(void* userdata, size_t capacity, size_t required) FP_NOEXCEPT {
+	(void)userdata; (void)capacity;
+	return fp_upper_power_of_two(required);
+}
+inline static size_t fp_growth_double(void* userdata, size_t capacity, size_t required) FP_NOEXCEPT {
+	(void)userdata;
+	return capacity * 2 > required ? capacity * 2 : required;
+}
+inline static size_t fp_growth_one_and_a_half(void* userdata, size_t capacity, size_t required) FP_NOEXCEPT {
+	(void)userdata;
+	size_t grown = capacity + (capacity + 1) / 2;
+	return grown > required ? grown : required;
+}
+// Grows in steps of a fixed number of elements, userdata holds the number of elements per chunk (cast to a pointer)
+inline static size_t fp_growth_fixed_chunk(void* userdata, size_t capacity, size_t required) FP_NOEXCEPT {
+	(void)capacity;
+	size_t chunk = (size_t)(uintptr_t)userdata;
+	assert(chunk > 0);
+	return (required + chunk - 1) / chunk * chunk;
+}
+
+struct fp_growth_policy* __fp_growth_policy_registry() FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+	static struct fp_growth_policy registry[FP_MAX_GROWTH_POLICIES] = {
+		{fp_growth_power_of_two, NULL, 0},
+		{fp_growth_double, NULL, .25f},
+		{fp_growth_one_and_a_half, NULL, 1 / 3.f},
+	};
+	return registry;
+}
+#else
+;
+#endif
+
+/**
+* @brief Registers a runtime growth policy which dynarrays can then be switched to with fpda_set_growth_policy
+* @note Registration is not thread safe, policies should be registered before they are shared between threads
+* @return the id of the policy, or FP_GROWTH_POWER_OF_TWO if the registry is full
+*/
+fp_growth_policy_id fp_growth_policy_register(struct fp_growth_policy policy) FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+	assert(policy.grow);
+	struct fp_growth_policy* registry = __fp_growth_policy_registry();
+	for(fp_growth_policy_id id = __FP_BUILTIN_GROWTH_POLICIES; id < FP_MAX_GROWTH_POLICIES; ++id)
+		if(registry[id].grow == NULL) {
+			registry[id] = policy;
+			return id;
+		}
+	return FP_GROWTH_POWER_OF_TWO;
+}
+#else
+;
+#endif
+
+/**
+* @brief Removes a growth policy from the registry
+* @note No living dynarray may still be using the policy
+*/
+inline static void fp_growth_policy_unregister(fp_growth_policy_id id) FP_NOEXCEPT {
+	if(id < __FP_BUILTIN_GROWTH_POLICIES || id >= FP_MAX_GROWTH_POLICIES) return;
+	__fp_growth_policy_registry()[id].grow = NULL;
+	__fp_growth_policy_registry()[id].userdata = NULL;
+	__fp_growth_policy_registry()[id].shrink_below = 0;
+}
+
+inline static const struct fp_growth_policy* __fp_growth_policy(fp_growth_policy_id id) FP_NOEXCEPT {
+	assert(id < FP_MAX_GROWTH_POLICIES);
+	const struct fp_growth_policy* policy = __fp_growth_policy_registry() + id;
+	assert(policy->grow); // Policy was unregistered while an array still used it!
+	return policy;
+}
+
 struct __FatDynamicArrayHeader {
-	size_t capacity;
+#ifdef FP_COMPACT_HEADERS
+	uint32_t padding; // Keeps the elements 8 byte aligned
+#endif
+	fp_header_size_t capacity;
 	struct __FatPointerHeader h;
 };
 #ifndef __cplusplus
@@ -60,17 +175,40 @@ inline static struct __FatDynamicArrayHeader* __fpda_header(const void* da) FP_N
 	return (struct __FatDynamicArrayHeader*)p;
 }
 
-void* __fpda_malloc(size_t _size) FP_NOEXCEPT
+// NOTE: The outer header holds the real alignment offset of a dynarray's allocation, so the inner header's copy is free to store the array's growth policy
+inline static fp_growth_policy_id __fpda_header_growth_policy(const struct __FatDynamicArrayHeader* h) FP_NOEXCEPT { return h->h.alignment_offset; }
+inline static void __fpda_header_set_growth_policy(struct __FatDynamicArrayHeader* h, fp_growth_policy_id policy) FP_NOEXCEPT {
+	assert(policy < FP_MAX_GROWTH_POLICIES);
+	h->h.alignment_offset = policy;
+}
+
+// Determines the capacity an array must grow to in order to hold \p required elements
+inline static size_t __fpda_grown_capacity(const struct __FatDynamicArrayHeader* h, size_t required) FP_NOEXCEPT {
+	fp_growth_policy_id id = __fpda_header_growth_policy(h);
+	if(id == FP_GROWTH_POWER_OF_TWO) return fp_upper_power_of_two(required);
+
+	const struct fp_growth_policy* policy = __fp_growth_policy(id);
+	size_t capacity = policy->grow(policy->userdata, h->capacity, required);
+	assert(capacity >= required);
+	return capacity;
+}
+
+/**
+* @param alignment the alignment (a power of two, 0 for none) the first element should have
+*/
+void* __fpda_malloc_aligned_in(size_t _size, fp_allocator_id allocator, size_t alignment) FP_NOEXCEPT
 #ifdef FP_IMPLEMENTATION
 {
 	assert(_size > 0);
 	size_t size = FPDA_HEADER_SIZE + _size + 1;
-	uint8_t* p = (uint8_t*)__fp_alloc(NULL, size);
-	p += FPDA_HEADER_SIZE;
+	uint8_t* p = (uint8_t*)__fp_alloc_aligned_in(NULL, size, allocator, alignment, FPDA_HEADER_SIZE);
 	if(!p) return 0;
+	p += FPDA_HEADER_SIZE;
 	auto h = __fpda_header(p);
 	h->capacity = _size;
 	h->h.magic = FP_DYNARRAY_MAGIC_NUMBER;
+	h->h.allocator = allocator;
+	__fp_header_set_alignment(&h->h, alignment, 0); // NOTE: Mirrored from the outer header so that fp_alignment works on dynarrays
 	h->h.size = 0;
 	h->h.data[_size] = 0;
 	return p;
@@ -78,6 +216,8 @@ void* __fpda_malloc(size_t _size) FP_NOEXCEPT
 #else
 ;
 #endif
+inline static void* __fpda_malloc_in(size_t _size, fp_allocator_id allocator) FP_NOEXCEPT { return __fpda_malloc_aligned_in(_size, allocator, 0); }
+inline static void* __fpda_malloc(size_t _size) FP_NOEXCEPT { return __fpda_malloc_in(_size, FP_DEFAULT_ALLOCATOR); }
 
 #define fpda_malloc(type, _size) ((type*)((uint8_t*)(*__fpda_header(__fpda_malloc(nullptr, sizeof(type) * (_size))) = (struct __FatDynamicArrayHeader){\
 	.utilized_size = 0,\
@@ -90,20 +230,62 @@ void* __fpda_malloc(size_t _size) FP_NOEXCEPT
 #ifdef __GNUC__
 __attribute__((no_sanitize_address)) // Don't let this function which routinely peaks out of valid bounds trigger the address sanitizer
 #endif
-inline static bool is_fpda(const void* da) FP_NOEXCEPT { return __fpda_header(da)->h.magic == FP_DYNARRAY_MAGIC_NUMBER; }
+inline static bool is_fpda(const void* da) FP_NOEXCEPT {
+	auto magic = __fpda_header(da)->h.magic;
+	return magic == FP_DYNARRAY_MAGIC_NUMBER || magic == FP_SMALL_DYNARRAY_MAGIC_NUMBER;
+}
+
+// Determines if a dynarray still lives in the (stack or caller provided) storage it was created in
+#ifdef __GNUC__
+__attribute__((no_sanitize_address)) // Don't let this function which routinely peaks out of valid bounds trigger the address sanitizer
+#endif
+inline static bool fpda_is_small(const void* da) FP_NOEXCEPT { return da && __fpda_header(da)->h.magic == FP_SMALL_DYNARRAY_MAGIC_NUMBER; }
 
 void fpda_free(void* da) FP_NOEXCEPT
 #ifdef FP_IMPLEMENTATION
 {
 	auto h = __fpda_header(da);
-	if(h != __fpda_header_null_ref())
+	if(h != __fpda_header_null_ref() && h->h.magic != FP_SMALL_DYNARRAY_MAGIC_NUMBER) // Small arrays don't own their storage
 		__fp_alloc(h, 0);
 }
 #else
 ;
 #endif
 
-#define fpda_free_and_null(da) (fpda_free(da), da = NULL)
+#ifndef FPDA_SMALL_ALIGNMENT
+#define FPDA_SMALL_ALIGNMENT 16 // The alignment of the first element of small arrays which don't request one
+#endif
+
+/**
+* @brief Creates a small dynarray inside of \p buffer, it behaves like any other dynarray but only moves to the heap once it outgrows the buffer
+* @note The buffer must outlive the array (until it is moved to the heap), freeing the array while it is still small does nothing
+* @param alignment the alignment (a power of two, 0 for the default) of the first element, kept if the array moves to the heap
+*/
+inline static void* __fpda_from_buffer(void* buffer, size_t buffer_size, size_t type_size, size_t alignment) FP_NOEXCEPT {
+	size_t align = alignment ? alignment : FPDA_SMALL_ALIGNMENT;
+	uintptr_t start = (uintptr_t)buffer, end = start + buffer_size;
+	uintptr_t data = (start + FPDA_HEADER_SIZE + align - 1) & ~(uintptr_t)(align - 1);
+	assert(data + 1 <= end);
+
+	auto h = __fpda_header((void*)data);
+	h->capacity = (end - data - 1) / type_size; // Leave room for the null terminator
+	h->h.magic = FP_SMALL_DYNARRAY_MAGIC_NUMBER;
+	h->h.allocator = FP_DEFAULT_ALLOCATOR;
+	__fp_header_set_alignment(&h->h, alignment, 0);
+	h->h.size = 0;
+	h->h.data[0] = 0;
+	return (void*)data;
+}
+// How large a buffer must be to hold a small dynarray of \p capacity elements
+#define FPDA_SMALL_BUFFER_SIZE(type, capacity) (FPDA_HEADER_SIZE + FPDA_SMALL_ALIGNMENT - 1 + sizeof(type) * (capacity) + 1)
+#define fpda_from_buffer(type, buffer, buffer_size) ((type*)__fpda_from_buffer((buffer), (buffer_size), sizeof(type), 0))
+#ifdef _WIN32
+	#define fpda_alloca(type, capacity) fpda_from_buffer(type, _alloca(FPDA_SMALL_BUFFER_SIZE(type, capacity)), FPDA_SMALL_BUFFER_SIZE(type, capacity))
+#else
+	#define fpda_alloca(type, capacity) fpda_from_buffer(type, alloca(FPDA_SMALL_BUFFER_SIZE(type, capacity)), FPDA_SMALL_BUFFER_SIZE(type, capacity))
+#endif
+
+#define fpda_free_and_null(da) (FP_PROFILE_SCOPE_VOID(fpda_free(da)), da = NULL)
 
 #define fpda_length fp_length
 #define fpda_size fp_size
@@ -123,14 +305,70 @@ inline static size_t fpda_capacity(const void* da) FP_NOEXCEPT {
 	return __fpda_header(da)->capacity;
 }
 
-inline static void* __fpda_maybe_grow(void** da, size_t type_size, size_t new_size, bool update_utilized, bool exact_sizing) FP_NOEXCEPT {
+/**
+* @brief Resizes the storage of an array to hold exactly \p capacity elements (elements past the new capacity are dropped)
+* @note Heap arrays are reallocated, giving the allocator a chance to resize them in place; small arrays are copied to the heap
+* @note The array keeps its allocator, alignment, and growth policy
+* @return the header of the array in its new storage
+*/
+inline static struct __FatDynamicArrayHeader* __fpda_reallocate(void** da, size_t type_size, size_t capacity) FP_NOEXCEPT {
+	auto h = __fpda_header(*da);
+	size_t size = h->h.size < capacity ? h->h.size : capacity;
+	if(capacity == 0) capacity = 1; // Allocations can't be empty
+	size_t bytes = FPDA_HEADER_SIZE + type_size * capacity + 1;
+#ifdef FP_ENABLE_PROFILING
+	auto type = capacity > h->capacity ? FP_PROFILE_GROW : FP_PROFILE_SHRINK;
+	size_t old_capacity = h->capacity;
+#endif
+
+	bool copy = h->h.magic == FP_SMALL_DYNARRAY_MAGIC_NUMBER;
+#ifdef FP_MMAP_ALLOCATOR
+	// Arrays which cross the mapping threshold are copied so that they move into (or out of) a mapping
+	size_t threshold = fp_mmap_options()->threshold;
+	if(!copy && threshold) {
+		fp_allocator_id backing = __fp_header(h)->allocator;
+		size_t requested = __fp_allocation_size(bytes, __fp_header_alignment(__fp_header(h))); // Matches the size __fp_alloc_aligned_in routes new allocations on
+		copy = (backing == FP_DEFAULT_ALLOCATOR && requested >= threshold) || (backing == FP_MMAP_ALLOCATOR && capacity < h->capacity && requested < threshold);
+	}
+#endif
+	if(copy) {
+		void* new_ = __fpda_malloc_aligned_in(type_size * capacity, h->h.allocator, __fp_header_alignment(&h->h));
+		auto newH = __fpda_header(new_);
+		newH->h.magic = FP_DYNARRAY_MAGIC_NUMBER;
+		__fpda_header_set_growth_policy(newH, __fpda_header_growth_policy(h));
+		memcpy(newH->h.data, h->h.data, type_size * size);
+		FP_PROFILE_EVENT(type, new_, type_size * capacity, type_size * old_capacity, type_size * size);
+		fpda_free(*da);
+		h = newH;
+	} else {
+#ifdef FP_ENABLE_PROFILING
+		__fp_header(h)->size = FPDA_HEADER_SIZE + type_size * size; // Let the reallocation event see how many bytes are live
+#endif
+		// NOTE: The inner header lives inside the outer allocation, so it travels with the data
+		h = (struct __FatDynamicArrayHeader*)__fp_alloc_aligned_in(h, bytes, FP_DEFAULT_ALLOCATOR, 0, FPDA_HEADER_SIZE);
+		FP_PROFILE_REALLOCATED_EVENT(type, h->h.data, type_size * capacity, type_size * old_capacity);
+	}
+
+	h->h.size = size;
+	h->capacity = capacity;
+	h->h.data[type_size * capacity] = 0;
+	*da = h->h.data;
+	return h;
+}
+
+/**
+* @param allocator the allocator to create the array in if \p da is null, otherwise the array keeps growing in the allocator that created it
+* @param alignment the alignment to create the array with if \p da is null, otherwise the array keeps the alignment it was created with
+*/
+inline static void* __fpda_maybe_grow_aligned_in(void** da, size_t type_size, size_t new_size, bool update_utilized, bool exact_sizing, fp_allocator_id allocator, size_t alignment) FP_NOEXCEPT {
 	if(*da == NULL) {
 		size_t initial_size = exact_sizing ? new_size : FPDA_DEFAULT_SIZE_BYTES / type_size;
 		if(initial_size == 0) initial_size++; // If the size would wind up being 0, make sure the initial size is 1
-		*da = __fpda_malloc(initial_size * type_size);
+		*da = __fpda_malloc_aligned_in(initial_size * type_size, allocator, alignment);
 		auto h = __fpda_header(*da);
 		h->capacity /= type_size;
 		h->h.size = 0;
+		FP_PROFILE_EVENT(FP_PROFILE_GROW, *da, initial_size * type_size, 0, 0);
 	}
 
 	auto h = __fpda_header(*da);
@@ -139,23 +377,27 @@ inline static void* __fpda_maybe_grow(void** da, size_t type_size, size_t new_si
 		return h->h.data + (type_size * (new_size - 1));
 	}
 
-	size_t size2 = exact_sizing ? new_size : fp_upper_power_of_two(new_size);
-	void* new_ = __fpda_malloc(type_size * size2);
-	auto newH = __fpda_header(new_);
-	if(update_utilized)
-		newH->h.size = h->h.size > new_size ? h->h.size : new_size;
-	newH->capacity = size2;
-	memcpy(newH->h.data, h->h.data, type_size * h->h.size);
-
-	fpda_free(*da);
-	*da = new_;
-	return newH->h.data + (type_size * (new_size - 1));
+	h = __fpda_reallocate(da, type_size, exact_sizing ? new_size : __fpda_grown_capacity(h, new_size));
+	if(update_utilized) h->h.size = h->h.size > new_size ? h->h.size : new_size;
+	return h->h.data + (type_size * (new_size - 1));
 }
-#define __fpda_maybe_grow_short(a, _size) ((FP_TYPE_OF_REMOVE_POINTER(a)*)__fpda_maybe_grow((void**)&a, sizeof(*a), (_size), true, false))
-
-#define fpda_reserve(a, _size) ((FP_TYPE_OF_REMOVE_POINTER(a)*)__fpda_maybe_grow((void**)&a, sizeof(*a), (_size), false, true))
-#define fpda_reserve_void_pointer(a, type_size, _size) (__fpda_maybe_grow((void**)&a, type_size, (_size), false, true))
-#define fpda_grow_to_size(a, _size) ((FP_TYPE_OF_REMOVE_POINTER(a)*)__fpda_maybe_grow((void**)&a, sizeof(*a), (_size), true, true))
+inline static void* __fpda_maybe_grow_in(void** da, size_t type_size, size_t new_size, bool update_utilized, bool exact_sizing, fp_allocator_id allocator) FP_NOEXCEPT {
+	return __fpda_maybe_grow_aligned_in(da, type_size, new_size, update_utilized, exact_sizing, allocator, 0);
+}
+inline static void* __fpda_maybe_grow(void** da, size_t type_size, size_t new_size, bool update_utilized, bool exact_sizing) FP_NOEXCEPT {
+	return __fpda_maybe_grow_in(da, type_size, new_size, update_utilized, exact_sizing, FP_DEFAULT_ALLOCATOR);
+}
+#define __fpda_maybe_grow_short(a, _size) FP_PROFILE_SCOPE(FP_TYPE_OF_REMOVE_POINTER(a)*, __fpda_maybe_grow((void**)&a, sizeof(*a), (_size), true, false))
+
+#define fpda_reserve(a, _size) FP_PROFILE_SCOPE(FP_TYPE_OF_REMOVE_POINTER(a)*, __fpda_maybe_grow((void**)&a, sizeof(*a), (_size), false, true))
+#define fpda_reserve_void_pointer(a, type_size, _size) FP_PROFILE_SCOPE(void*, __fpda_maybe_grow((void**)&a, type_size, (_size), false, true))
+#define fpda_grow_to_size(a, _size) FP_PROFILE_SCOPE(FP_TYPE_OF_REMOVE_POINTER(a)*, __fpda_maybe_grow((void**)&a, sizeof(*a), (_size), true, true))
+// Variants which create the array in the provided allocator if it doesn't exist yet (existing arrays always stay in the allocator they were created in)
+#define fpda_reserve_in(a, _size, allocator) FP_PROFILE_SCOPE(FP_TYPE_OF_REMOVE_POINTER(a)*, __fpda_maybe_grow_in((void**)&a, sizeof(*a), (_size), false, true, (allocator)))
+#define fpda_grow_to_size_in(a, _size, allocator) FP_PROFILE_SCOPE(FP_TYPE_OF_REMOVE_POINTER(a)*, __fpda_maybe_grow_in((void**)&a, sizeof(*a), (_size), true, true, (allocator)))
+// Variants which create the array with its first element aligned to \p alignment bytes (a power of two) if it doesn't exist yet, the alignment is kept as the array grows
+#define fpda_reserve_aligned(a, _size, alignment) FP_PROFILE_SCOPE(FP_TYPE_OF_REMOVE_POINTER(a)*, __fpda_maybe_grow_aligned_in((void**)&a, sizeof(*a), (_size), false, true, FP_DEFAULT_ALLOCATOR, (alignment)))
+#define fpda_reserve_aligned_in(a, _size, alignment, allocator) FP_PROFILE_SCOPE(FP_TYPE_OF_REMOVE_POINTER(a)*, __fpda_maybe_grow_aligned_in((void**)&a, sizeof(*a), (_size), false, true, (allocator), (alignment)))
 #define fpda_grow(a, _to_add) (__fpda_maybe_grow_short(a, __fpda_header(a)->h.size + _to_add))
 #define fpda_push_back(a, _value) (*__fpda_maybe_grow_short(a, __fpda_header(a)->h.size + 1) = (_value))
 
@@ -191,13 +433,93 @@ inline static void* __fpda_maybe_grow_insert(void** da, size_t type_size, size_t
 	return oldStart;
 }
 
-#define fpda_insert(a, _pos, _val) ((*(FP_TYPE_OF(*a)*)__fpda_maybe_grow_insert((void**)&a, sizeof(*a), (_pos), 1, false)) = _val)
+#define fpda_insert(a, _pos, _val) ((*FP_PROFILE_SCOPE(FP_TYPE_OF(*a)*, __fpda_maybe_grow_insert((void**)&a, sizeof(*a), (_pos), 1, false))) = _val)
 #define fpda_push_front(a, _val) fpda_insert(a, 0, _val)
 
 // Returns a pointer to the first uninitialized element
-#define fpda_insert_uninitialized(a, _pos, _count) ((FP_TYPE_OF(*a)*)__fpda_maybe_grow_insert((void**)&a, sizeof(*a), (_pos), (_count), false))
+#define fpda_insert_uninitialized(a, _pos, _count) FP_PROFILE_SCOPE(FP_TYPE_OF(*a)*, __fpda_maybe_grow_insert((void**)&a, sizeof(*a), (_pos), (_count), false))
+
+/**
+* @brief Appends copies of \p count elements, growing the array at most once
+* @note \p data may point into the array itself
+* @return a pointer to the first appended element
+*/
+inline static void* __fpda_append_n(void** da, size_t type_size, const void* data, size_t count) FP_NOEXCEPT {
+	size_t size = fpda_size(*da);
+	if(count == 0) return *da ? (uint8_t*)*da + size * type_size : NULL;
+
+	uint8_t* raw = (uint8_t*)*da;
+	bool aliased = raw && (const uint8_t*)data >= raw && (const uint8_t*)data < raw + size * type_size;
+	size_t offset = aliased ? (const uint8_t*)data - raw : 0;
+	__fpda_maybe_grow(da, type_size, size + count, /*update_utilized*/true, false);
+	raw = (uint8_t*)*da;
+	if(aliased) data = raw + offset; // Growing may have moved the source
+
+	memcpy(raw + size * type_size, data, count * type_size);
+	return raw + size * type_size;
+}
+#define fpda_append_n(a, _data, _count) FP_PROFILE_SCOPE(FP_TYPE_OF(*a)*, __fpda_append_n((void**)&a, sizeof(*a), (_data), (_count)))
+#define fpda_append_view(a, view) FP_PROFILE_SCOPE(FP_TYPE_OF(*a)*, __fpda_append_view((void**)&a, sizeof(*a), (fp_void_view)(view)))
+inline static void* __fpda_append_view(void** da, size_t type_size, fp_void_view view) FP_NOEXCEPT { return __fpda_append_n(da, type_size, view.data, view.size); }
+
+// A block of elements to insert with fpda_insert_views
+struct fpda_insertion {
+	size_t position; // Index (into the array as it was before any insertion) the elements are inserted in front of
+	fp_void_view view;
+};
+
+/**
+* @brief Inserts several blocks of elements at once, growing the array at most once and moving each existing element at most once
+* @note \p insertions must be sorted by position, blocks which share a position are inserted in order
+* @note The inserted views must not point into the array
+* @return a pointer to the first element of the array
+*/
+inline static void* __fpda_insert_views(void** da, size_t type_size, const struct fpda_insertion* insertions, size_t count) FP_NOEXCEPT {
+	size_t size = fpda_size(*da), total = 0;
+	for(size_t i = 0; i < count; ++i) {
+		assert(insertions[i].position <= size);
+		assert(i == 0 || insertions[i - 1].position <= insertions[i].position);
+		total += insertions[i].view.size;
+	}
+	if(total == 0) return *da;
+	__fpda_maybe_grow(da, type_size, size + total, /*update_utilized*/true, false);
+
+	// Working right to left, every gap is opened by shifting the elements after it straight into their final place
+	uint8_t* raw = (uint8_t*)*da;
+	size_t end = size, write = size + total;
+	for(size_t i = count; i--; ) {
+		size_t position = insertions[i].position, length = insertions[i].view.size;
+		write -= end - position;
+		memmove(raw + write * type_size, raw + position * type_size, (end - position) * type_size);
+		end = position;
+
+		write -= length;
+		memcpy(raw + write * type_size, insertions[i].view.data, length * type_size);
+	}
+	assert(write == end);
+	return raw;
+}
+#define fpda_insert_views(a, insertions, _count) FP_PROFILE_SCOPE(FP_TYPE_OF(*a)*, __fpda_insert_views((void**)&a, sizeof(*a), (insertions), (_count)))
+// Inserts copies of the elements in \p view in front of \p pos, returns a pointer to the first inserted element
+inline static void* __fpda_insert_view(void** da, size_t type_size, size_t pos, fp_void_view view) FP_NOEXCEPT {
+	struct fpda_insertion insertion = {pos, view};
+	__fpda_insert_views(da, type_size, &insertion, 1);
+	return *da ? (uint8_t*)*da + pos * type_size : NULL;
+}
+#define fpda_insert_view(a, _pos, view) FP_PROFILE_SCOPE(FP_TYPE_OF(*a)*, __fpda_insert_view((void**)&a, sizeof(*a), (_pos), (fp_void_view)(view)))
 
 
+// Shrinks an array whose growth policy asks for it once it has emptied out enough, the new capacity is where the policy would grow to from its size
+inline static void __fpda_maybe_shrink(void** da, size_t type_size) FP_NOEXCEPT {
+	auto h = __fpda_header(*da);
+	if(h->h.magic == FP_SMALL_DYNARRAY_MAGIC_NUMBER || __fpda_header_growth_policy(h) == FP_GROWTH_POWER_OF_TWO) return;
+	const struct fp_growth_policy* policy = __fp_growth_policy(__fpda_header_growth_policy(h));
+	if(policy->shrink_below <= 0 || h->h.size >= h->capacity * policy->shrink_below) return;
+
+	size_t capacity = policy->grow(policy->userdata, h->h.size, h->h.size + 1);
+	if(capacity < h->capacity) __fpda_reallocate(da, type_size, capacity);
+}
+
 inline static void* __fpda_delete(void** da, size_t type_size, size_t start, size_t count, bool make_size_match_capacity) FP_NOEXCEPT {
 	assert(start + count <= fpda_size(*da));
 
@@ -206,28 +528,19 @@ inline static void* __fpda_delete(void** da, size_t type_size, size_t start, siz
 	uint8_t* oldStart = newStart + count * type_size;
 	size_t length = (raw + fpda_size(raw) * type_size) - oldStart;
 
-	if(make_size_match_capacity) {
-		fp_dynarray(uint8_t) new_ = nullptr;
-		size_t newLength = fpda_size(raw) - count;
-		fpda_grow_to_size(new_, newLength * type_size);
-		__fpda_header(new_)->h.size = newLength;
-		__fpda_header(new_)->capacity = newLength;
-
-		newStart = new_ + start * type_size;
-		if(oldStart != raw) memcpy(new_, raw, newStart - new_);
-		memcpy(newStart, oldStart, length);
-
-		fpda_free(*da);
-		*da = new_;
-
-	} else if(count > 0) {
+	if(count > 0) {
 		__fpda_header(*da)->h.size -= count;
 		memmove(newStart, oldStart, length);
 	}
 
-	return newStart;
+	if(make_size_match_capacity) {
+		if(!fpda_is_small(raw)) // Small arrays can't give back any of their storage
+			__fpda_reallocate(da, type_size, fpda_size(raw));
+	} else if(count > 0) __fpda_maybe_shrink(da, type_size);
+
+	return (uint8_t*)*da + start * type_size;
 }
-#define __fpda_delete_impl(a, _pos, _count, _match_size) ((FP_TYPE_OF(*a)*)__fpda_delete((void**)&a, sizeof(*a), (_pos), (_count), (_match_size)))
+#define __fpda_delete_impl(a, _pos, _count, _match_size) FP_PROFILE_SCOPE(FP_TYPE_OF(*a)*, __fpda_delete((void**)&a, sizeof(*a), (_pos), (_count), (_match_size)))
 
 #define fpda_delete_range(a, _pos, _count) __fpda_delete_impl(a, _pos, _count, false)
 #define fpda_delete(a, _pos) fpda_delete_range(a, _pos, 1)
@@ -237,6 +550,90 @@ inline static void* __fpda_delete(void** da, size_t type_size, size_t start, siz
 #define fpda_shrink_delete(a, _pos) fpda_shrink_delete_range(a, _pos, 1)
 #define fpda_shrink_delete_start_end(a, _start, _end) fpda_shrink_delete_range(a, _start, ((_end) - (_start) + 1))
 
+// Returns a mask with the bits of the \p count (at most 64) elements starting at \p index which should be kept set
+typedef uint64_t(*__fpda_keep_mask_t)(void* userdata, const uint8_t* elements, size_t index, size_t count, size_t type_size) FP_NOEXCEPT;
+
+// Removes every element its keep mask doesn't keep in a single stable pass, 64 elements at a time (the masks are always built from the original elements)
+inline static size_t __fpda_compact(void** da, size_t type_size, __fpda_keep_mask_t keep, void* userdata) FP_NOEXCEPT {
+	uint8_t* raw = (uint8_t*)*da;
+	size_t size = fpda_size(raw), write = 0;
+	for(size_t read = 0; read < size; read += 64) {
+		size_t count = size - read < 64 ? size - read : 64;
+		uint64_t mask = keep(userdata, raw + read * type_size, read, count, type_size);
+		uint64_t all = count == 64 ? ~(uint64_t)0 : ((uint64_t)1 << count) - 1;
+		if(write == read && (mask & all) == all) write += count; // Nothing has been removed yet
+		else write += fp_simd_compress(raw + write * type_size, raw + read * type_size, mask, count, type_size);
+	}
+	if(write == size) return 0;
+
+	__fpda_header(raw)->h.size = write;
+	__fpda_maybe_shrink(da, type_size);
+	return size - write;
+}
+
+// Decides whether an element should be removed
+typedef bool(*fpda_predicate_t)(void* userdata, const void* element) FP_NOEXCEPT;
+struct __fpda_predicate_state { fpda_predicate_t predicate; void* userdata; };
+inline static uint64_t __fpda_predicate_keep_mask(void* userdata, const uint8_t* elements, size_t index, size_t count, size_t type_size) FP_NOEXCEPT {
+	(void)index;
+	auto state = (struct __fpda_predicate_state*)userdata;
+	uint64_t mask = 0;
+	for(size_t i = 0; i < count; ++i)
+		mask |= (uint64_t)!state->predicate(state->userdata, elements + i * type_size) << i;
+	return mask;
+}
+
+/**
+* @brief Removes every element \p predicate returns true for, the remaining elements keep their order
+* @note Every element is moved at most once (vectorized for 4 and 8 byte elements where supported)
+* @return the number of elements removed
+*/
+inline static size_t __fpda_remove_if(void** da, size_t type_size, fpda_predicate_t predicate, void* userdata) FP_NOEXCEPT {
+	struct __fpda_predicate_state state = {predicate, userdata};
+	return __fpda_compact(da, type_size, __fpda_predicate_keep_mask, &state);
+}
+#define fpda_remove_if(a, predicate, userdata) __fpda_remove_if((void**)&a, sizeof(*a), (predicate), (userdata))
+#define fpda_erase_if(a, predicate, userdata) fpda_remove_if(a, predicate, userdata)
+
+// Decides whether two elements are equal
+typedef bool(*fpda_equal_t)(void* userdata, const void* a, const void* b) FP_NOEXCEPT;
+struct __fpda_equal_state { fpda_equal_t equal; void* userdata; };
+inline static uint64_t __fpda_unique_keep_mask(void* userdata, const uint8_t* elements, size_t index, size_t count, size_t type_size) FP_NOEXCEPT {
+	auto state = (struct __fpda_equal_state*)userdata;
+	uint64_t mask = index == 0; // The first element is always kept
+	for(size_t i = index == 0; i < count; ++i) { // NOTE: The element before the block is still in place, since nothing is written past the last kept element
+		const uint8_t* element = elements + i * type_size;
+		bool equal = state->equal ? state->equal(state->userdata, element - type_size, element) : memcmp(element - type_size, element, type_size) == 0;
+		mask |= (uint64_t)!equal << i;
+	}
+	return mask;
+}
+
+/**
+* @brief Removes every element which is equal to the one before it (so sorted arrays are left with only unique elements)
+* @param equal compares elements, if null their bytes are compared
+* @return the number of elements removed
+*/
+inline static size_t __fpda_unique(void** da, size_t type_size, fpda_equal_t equal, void* userdata) FP_NOEXCEPT {
+	struct __fpda_equal_state state = {equal, userdata};
+	return __fpda_compact(da, type_size, __fpda_unique_keep_mask, &state);
+}
+#define fpda_unique(a) __fpda_unique((void**)&a, sizeof(*a), NULL, NULL)
+#define fpda_unique_by(a, equal, userdata) __fpda_unique((void**)&a, sizeof(*a), (equal), (userdata))
+
+/**
+* @brief Switches the policy an array grows (and possibly shrinks) by, creating the array if it doesn't exist yet
+* @note The policy sticks with the array as it is reallocated and cloned
+*/
+inline static void* __fpda_set_growth_policy(void** da, size_t type_size, fp_growth_policy_id policy) FP_NOEXCEPT {
+	assert(policy < FP_MAX_GROWTH_POLICIES && __fp_growth_policy_registry()[policy].grow);
+	if(*da == NULL) __fpda_maybe_grow(da, type_size, 1, false, false);
+	__fpda_header_set_growth_policy(__fpda_header(*da), policy);
+	return *da;
+}
+#define fpda_set_growth_policy(a, policy) ((FP_TYPE_OF(*a)*)__fpda_set_growth_policy((void**)&a, sizeof(*a), (policy)))
+inline static fp_growth_policy_id fpda_growth_policy(const void* da) FP_NOEXCEPT { return da ? __fpda_header_growth_policy(__fpda_header(da)) : FP_GROWTH_POWER_OF_TWO; }
+
 #define fpda_resize(a, _size) do { auto __fp_size = (_size);\
 		if((size_t)__fp_size > fpda_capacity(a)) fpda_grow_to_size(a, __fp_size);\
 		else { auto __fp_count = fpda_size(a) - __fp_size; fpda_shrink_delete_range(a, fpda_size(a) - __fp_count, __fp_count); }\
@@ -294,18 +691,25 @@ inline static void* __fpda_pop_front(void* _da, size_t type_size) FP_NOEXCEPT {
 
 inline static void __fpda_clone_to(void** dest, const void* src, size_t type_size, bool shrink_to_fit) FP_NOEXCEPT {
 	uint8_t* rawDest = (uint8_t*)*dest;
+	if(fpda_is_small(rawDest) && fpda_size(src) <= fpda_capacity(rawDest)) { // Stays in its buffer
+		memcpy(rawDest, src, fpda_size(src) * type_size);
+		__fpda_header(rawDest)->h.size = fpda_size(src);
+		return;
+	}
 	size_t newCapacity = shrink_to_fit ? fpda_size(src) : fpda_capacity(src);
-	fpda_grow_to_size(rawDest, newCapacity * type_size);
+	bool fresh = rawDest == NULL;
+	__fpda_maybe_grow_aligned_in((void**)&rawDest, 1, newCapacity * type_size, true, true, fp_allocator_of(src), fp_alignment(src));
 	memcpy(rawDest, src, fpda_size(rawDest));
 	auto h = __fpda_header(rawDest);
 	h->capacity = newCapacity;
 	h->h.size = fpda_size(src);
+	if(fresh) __fpda_header_set_growth_policy(h, fpda_growth_policy(src)); // New copies grow the same way as the original
 	*dest = rawDest;
 }
 
-#define fpda_clone_to(dest, src) __fpda_clone_to((void**)&dest, (src), sizeof(*dest), false)
+#define fpda_clone_to(dest, src) FP_PROFILE_SCOPE_VOID(__fpda_clone_to((void**)&dest, (src), sizeof(*dest), false))
 #define fpda_assign(dest, src) fpda_clone_to(dest, src)
-#define fpda_clone_to_shrink(dest, src) __fpda_clone_to((void**)&dest, (src), sizeof(*dest), true)
+#define fpda_clone_to_shrink(dest, src) FP_PROFILE_SCOPE_VOID(__fpda_clone_to((void**)&dest, (src), sizeof(*dest), true))
 
 inline static void* __fpda_clone(const void* src, size_t type_size) FP_NOEXCEPT {
 	void* out = NULL;
@@ -313,7 +717,7 @@ inline static void* __fpda_clone(const void* src, size_t type_size) FP_NOEXCEPT
 	return out;
 }
 
-#define fpda_clone(src) ((FP_TYPE_OF(*src)*)__fpda_clone((src), sizeof(*src)))
+#define fpda_clone(src) FP_PROFILE_SCOPE(FP_TYPE_OF(*src)*, __fpda_clone((src), sizeof(*src)))
 #define fpda_copy(src) fpda_clone(src)
 
 #define fpda_clear(a) __fpda_header(a)->h.size = 0
@@ -1,33 +1,40 @@
 #pragma once
 
+#include <initializer_list>
+#include <memory>
+
 #include "pointer.hpp"
 #include "dynarray.h"
 
 namespace fp {
 
-	template<typename T, typename Derived>
+	// NOTE: When Alignment is non-zero the first element of the array is always aligned to (at least) that many bytes
+	template<typename T, typename Derived, size_t Alignment = 0>
 	struct dynarray_crtp {
+		static_assert((Alignment & (Alignment - 1)) == 0 && Alignment <= FP_MAX_ALIGNMENT, "Alignment must be a power of two");
+
 		inline bool is_dynarray() const { return is_fpda(ptr()); }
 		inline size_t capacity() const { return fpda_capacity(ptr()); }
 
 		inline void free() { fpda_free(ptr()); }
 		inline void free_and_null() { fpda_free_and_null(ptr()); }
 
-		inline Derived& reserve(size_t size) {
-			fpda_reserve(ptr(), size);
+		// NOTE: The allocator is only used if the array hasn't been allocated yet
+		inline Derived& reserve(size_t size, fp_allocator_id allocator = FP_DEFAULT_ALLOCATOR) {
+			fpda_reserve_aligned_in(ptr(), size, Alignment, allocator);
 			return *derived();
 		}
 		inline Derived& grow(size_t to_add, const T& value = {}) {
-			fpda_grow_and_initialize(ptr(), to_add, value);
+			fpda_grow_and_initialize(aligned_ptr(), to_add, value);
 			return *derived();
 		}
 		inline Derived& grow_to_size(size_t size, const T& value = {}) {
-			fpda_grow_to_size_and_initialize(ptr(), size, value);
+			fpda_grow_to_size_and_initialize(aligned_ptr(), size, value);
 			return *derived();
 		}
 
 		inline T& push_back(const T& value) {
-			return fpda_push_back(ptr(), value);
+			return fpda_push_back(aligned_ptr(), value);
 		}
 
 		inline T& pop_back_n(size_t count) {
@@ -42,16 +49,45 @@ namespace fp {
 		}
 
 		inline T& insert(size_t pos, const T& value = {}) {
-			return fpda_insert(ptr(), pos, value);
+			return fpda_insert(aligned_ptr(), pos, value);
 		}
 		inline T& push_front(const T& value = {}) {
-			return fpda_push_front(ptr(), value);
+			return fpda_push_front(aligned_ptr(), value);
 		}
 		inline view<T> insert_uninitialized(size_t pos, size_t count = 1) {
-			fpda_insert_uninitialized(ptr(), pos, count);
+			fpda_insert_uninitialized(aligned_ptr(), pos, count);
 			return derived()->view(pos, count);
 		}
 
+		// Appends copies of every element in range, growing the array at most once
+		inline view<T> append_range(view<const T> range) {
+			size_t start = fpda_size(ptr());
+			if constexpr(std::is_trivially_copyable_v<T>)
+				fpda_append_view(aligned_ptr(), range);
+			else if(!range.empty()) {
+				const T* data = ptr();
+				bool aliased = data && range.data() >= data && range.data() < data + start;
+				size_t offset = aliased ? range.data() - data : 0;
+				fpda_grow(aligned_ptr(), range.size());
+				const T* source = aliased ? ptr() + offset : range.data(); // Growing may have moved the source
+				std::uninitialized_copy(source, source + range.size(), ptr() + start);
+			}
+			return derived()->view(start, range.size());
+		}
+		inline view<T> append_range(std::initializer_list<T> range) { return append_range(view<const T>{range.begin(), range.size()}); }
+		// Inserts copies of every element in range in front of pos
+		// NOTE: range must not point into the array
+		inline view<T> insert_range(size_t pos, view<const T> range) {
+			if constexpr(std::is_trivially_copyable_v<T>)
+				fpda_insert_view(aligned_ptr(), pos, range);
+			else if(!range.empty()) {
+				fpda_insert_uninitialized(aligned_ptr(), pos, range.size());
+				std::uninitialized_copy(range.begin(), range.end(), ptr() + pos);
+			}
+			return derived()->view(pos, range.size());
+		}
+		inline view<T> insert_range(size_t pos, std::initializer_list<T> range) { return insert_range(pos, view<const T>{range.begin(), range.size()}); }
+
 		inline Derived& delete_range(size_t pos, size_t count) {
 			fpda_delete_range(ptr(), pos, count);
 			return *derived();
@@ -88,6 +124,13 @@ namespace fp {
 			return *derived();
 		}
 
+		inline fp_growth_policy_id growth_policy() const { return fpda_growth_policy(ptr()); }
+		inline Derived& set_growth_policy(fp_growth_policy_id policy) {
+			if(!ptr()) reserve(1); // Makes sure the array is created with the right alignment
+			fpda_set_growth_policy(ptr(), policy);
+			return *derived();
+		}
+
 		inline Derived& swap_range(size_t start1, size_t start2, size_t count) {
 			fpda_swap_range(ptr(), start1, start2, count);
 			return *derived();
@@ -114,6 +157,22 @@ namespace fp {
 			return *fpda_pop_front(ptr());
 		}
 
+		// Removes every element predicate returns true for in a single stable pass, returns how many were removed
+		template<typename F>
+		inline size_t remove_if(F&& predicate) {
+			return fpda_remove_if(ptr(), [](void* userdata, const void* element) noexcept -> bool {
+				return (*(std::remove_reference_t<F>*)userdata)(*(const T*)element);
+			}, (void*)&predicate);
+		}
+		template<typename F>
+		inline size_t erase_if(F&& predicate) { return remove_if(std::forward<F>(predicate)); }
+		// Removes every element which compares equal to the one before it, returns how many were removed
+		inline size_t unique() {
+			return fpda_unique_by(ptr(), [](void*, const void* a, const void* b) noexcept -> bool {
+				return *(const T*)a == *(const T*)b;
+			}, nullptr);
+		}
+
 		inline Derived clone() const {
 			return (T*)fpda_clone(ptr());
 		}
@@ -128,45 +187,98 @@ namespace fp {
 		inline const Derived* derived() const { return (Derived*)this; }
 		inline T*& ptr() { return derived()->ptr(); }
 		inline const T* const & ptr() const { return derived()->ptr(); }
+		// Makes sure arrays which are about to be created by a growth operation are created with the requested alignment (existing arrays keep theirs)
+		inline T*& aligned_ptr() {
+			if constexpr(Alignment > 0) if(ptr() == nullptr)
+				fpda_reserve_aligned(ptr(), std::max<size_t>(FPDA_DEFAULT_SIZE_BYTES / sizeof(T), 1), Alignment);
+			return ptr();
+		}
 	};
 
-	template<typename T>
-	struct dynarray: public pointer<T>, public dynarray_crtp<T, dynarray<T>> {
+	template<typename T, size_t Alignment = 0>
+	struct dynarray: public pointer<T>, public dynarray_crtp<T, dynarray<T, Alignment>, Alignment> {
 		using super = pointer<T>;
 		using super::super;
 		// using super::operator=;
 		using super::ptr;
 
-		using crtp = dynarray_crtp<T, dynarray<T>>;
+		using crtp = dynarray_crtp<T, dynarray<T, Alignment>, Alignment>;
 		using crtp::free;
 		using crtp::free_and_null;
 		using crtp::clone;
 
-		inline operator dynarray<std::add_const_t<T>>() const { return *(dynarray<std::add_const_t<T>>*)this; }
+		inline operator dynarray<std::add_const_t<T>, Alignment>() const { return *(dynarray<std::add_const_t<T>, Alignment>*)this; }
+	};
+
+	// Dynarray which keeps up to N elements inside of itself and only moves to the heap once it outgrows them
+	// NOTE: Always owns its elements (like raii::dynarray), moving or copying an array which still fits copies its elements
+	template<typename T, size_t N, size_t Alignment = 0>
+	struct small_dynarray: public pointer_crtp<T, small_dynarray<T, N, Alignment>>, public dynarray_crtp<T, small_dynarray<T, N, Alignment>, Alignment> {
+		using crtp = dynarray_crtp<T, small_dynarray<T, N, Alignment>, Alignment>;
+		static constexpr size_t buffer_alignment = std::max<size_t>(Alignment, FPDA_SMALL_ALIGNMENT);
+
+		T* raw;
+		alignas(buffer_alignment) uint8_t buffer[FPDA_HEADER_SIZE + buffer_alignment - 1 + sizeof(T) * N + 1];
+
+		small_dynarray(): raw(make_small()) {}
+		small_dynarray(const small_dynarray& o): small_dynarray() { fpda_clone_to(raw, o.raw); }
+		small_dynarray(small_dynarray&& o): small_dynarray() { *this = std::move(o); }
+		small_dynarray& operator=(const small_dynarray& o) {
+			if(this != &o) fpda_clone_to(raw, o.raw);
+			return *this;
+		}
+		small_dynarray& operator=(small_dynarray&& o) {
+			if(this == &o) return *this;
+			if(!o.is_small()) { // Steal the heap allocation
+				crtp::free();
+				raw = std::exchange(o.raw, o.make_small());
+			} else {
+				fpda_clone_to(raw, o.raw);
+				fpda_clear(o.raw);
+			}
+			return *this;
+		}
+		~small_dynarray() { crtp::free(); }
+
+		// Determines if the elements still live inside of the array
+		inline bool is_small() const { return fpda_is_small(raw); }
+		// Frees any heap storage and empties the array
+		inline void free() {
+			crtp::free();
+			raw = make_small();
+		}
+		inline void free_and_null() { free(); } // NOTE: The array is never null
+
+	protected:
+		friend pointer_crtp<T, small_dynarray<T, N, Alignment>>;
+		friend crtp;
+		inline T*& ptr() { return raw; }
+		inline const T* const & ptr() const { return raw; }
+		inline T* make_small() { return (T*)__fpda_from_buffer(buffer, sizeof(buffer), sizeof(T), Alignment); }
 	};
 
 	namespace raii {
-		template<typename T>
-		struct dynarray: public raii::pointer<T>, public dynarray_crtp<T, raii::dynarray<T>> {
+		template<typename T, size_t Alignment = 0>
+		struct dynarray: public raii::pointer<T>, public dynarray_crtp<T, raii::dynarray<T, Alignment>, Alignment> {
 			using super = raii::pointer<T>;
 			using super::ptr;
 
-			using crtp = dynarray_crtp<T, raii::dynarray<T>>;
+			using crtp = dynarray_crtp<T, raii::dynarray<T, Alignment>, Alignment>;
 			using crtp::free;
 			using crtp::free_and_null;
 			using crtp::clone;
 
 			dynarray(): super(nullptr) {}
 			dynarray(T* ptr): super(ptr) {}
-			dynarray(const fp::dynarray<T>& o): super(std::move(o.clone())) {}
-			dynarray(fp::dynarray<T>&& o): super(std::exchange(o.raw, nullptr)) {}
+			dynarray(const fp::dynarray<T, Alignment>& o): super(std::move(o.clone())) {}
+			dynarray(fp::dynarray<T, Alignment>&& o): super(std::exchange(o.raw, nullptr)) {}
 			dynarray(const dynarray& o): super(std::move(o.clone())) {}
 			dynarray(dynarray&& o): super(std::exchange(o.raw, nullptr)) {}
 			dynarray& operator=(const dynarray& o) { if(super::raw) crtp::free(); super::raw = o.clone(); return *this;}
 			dynarray& operator=(dynarray&& o) { if(super::raw) crtp::free(); super::raw = std::exchange(o.raw, nullptr); return *this; }
 			~dynarray() { if(super::raw) crtp::free_and_null(); }
 
-			inline operator dynarray<std::add_const_t<T>>() const { return *(dynarray<std::add_const_t<T>>*)this; }
+			inline operator dynarray<std::add_const_t<T>, Alignment>() const { return *(dynarray<std::add_const_t<T>, Alignment>*)this; }
 		};
 	}
 }
\ No newline at end of file
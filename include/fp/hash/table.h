@@ -250,7 +250,9 @@ void __fp_hash_ensure_extra_information_size(void* table, size_t new_size, bool
 #ifdef FP_IMPLEMENTATION
 {
 	struct __FatHashTableHeader* h = __fp_hash_header(table);
+	fp_allocator_id allocator = fp_allocator_of(table); // Side structures live in the same allocator as the table
 	uint32_t* hops = nullptr;
+	fpda_reserve_in(hops, new_size + fp_hash_infos_to_skip(), allocator);
 	fpda_grow_to_size_and_initialize(hops, new_size + fp_hash_infos_to_skip(), 0);
 	if(!initializing) {
 		memcpy(hops, h, fpda_size(h) * sizeof(uint32_t));
@@ -260,14 +262,17 @@ void __fp_hash_ensure_extra_information_size(void* table, size_t new_size, bool
 
 	h = __fp_hash_header(table);
 	if(initializing) h->hashes = nullptr;
-	if(store_hashes_while_initializing || h->hashes) fpda_grow_to_size(h->hashes, new_size);
+	if(store_hashes_while_initializing || h->hashes) fpda_grow_to_size_in(h->hashes, new_size, allocator);
 }
 #else
 ;
 #endif
 #define fp_hash_ensure_extra_information_size(table, new_size, store_hashes_while_initializing) __fp_hash_ensure_extra_information_size((table), (new_size), (store_hashes_while_initializing))
 
-void __fp_hash_double_size(void** table, bool store_hashes_while_initializing, size_t type_size) FP_NOEXCEPT
+/**
+* @param allocator the allocator to create the table in if \p table is null
+*/
+void __fp_hash_double_size_in(void** table, bool store_hashes_while_initializing, size_t type_size, fp_allocator_id allocator) FP_NOEXCEPT
 #ifdef FP_IMPLEMENTATION
 {
 	size_t size = fpda_size(*table);
@@ -279,7 +284,7 @@ void __fp_hash_double_size(void** table, bool store_hashes_while_initializing, s
 	if(newSize < FP_HASH_NEIGHBORHOOD_SIZE) newSize = FP_HASH_NEIGHBORHOOD_SIZE;
 
 	char* p = (char*)*table;
-	__fpda_maybe_grow((void**)&p, type_size, newSize + __fp_hash_elements_to_skip(type_size), true, true);
+	__fpda_maybe_grow_in((void**)&p, type_size, newSize + __fp_hash_elements_to_skip(type_size), true, true, allocator);
 	// fpda_grow_to_size(p, (newSize + __fp_hash_elements_to_skip(type_size)) * type_size);
 	{
 		auto h = __fpda_header(p);
@@ -288,13 +293,18 @@ void __fp_hash_double_size(void** table, bool store_hashes_while_initializing, s
 		h->h.magic = FP_HASH_MAGIC_NUMBER;
 	}
 	*table = p;
+	FP_PROFILE_EVENT(FP_PROFILE_HASH_RESIZE, p, (newSize + __fp_hash_elements_to_skip(type_size)) * type_size, initalizing ? 0 : (size + __fp_hash_elements_to_skip(type_size)) * type_size, 0);
 
 	__fp_hash_ensure_extra_information_size(*table, newSize, store_hashes_while_initializing, initalizing);
 }
 #else
 ;
 #endif
-#define fp_hash_create_empty_table(type, table, store_hashes_while_initializing) __fp_hash_double_size((void**)&table, store_hashes_while_initializing, sizeof(type))
+inline static void __fp_hash_double_size(void** table, bool store_hashes_while_initializing, size_t type_size) FP_NOEXCEPT {
+	__fp_hash_double_size_in(table, store_hashes_while_initializing, type_size, FP_DEFAULT_ALLOCATOR);
+}
+#define fp_hash_create_empty_table(type, table, store_hashes_while_initializing) FP_PROFILE_SCOPE_VOID(__fp_hash_double_size((void**)&table, store_hashes_while_initializing, sizeof(type)))
+#define fp_hash_create_empty_table_in(type, table, store_hashes_while_initializing, allocator) FP_PROFILE_SCOPE_VOID(__fp_hash_double_size_in((void**)&table, store_hashes_while_initializing, sizeof(type), (allocator)))
 
 
 inline static bool __fp_hash_double_size_and_rehash(void** table, bool store_hashes_while_initializing, size_t retries /*= 0*/, size_t type_size) FP_NOEXCEPT;
@@ -393,7 +403,7 @@ inline static void* __fp_hash_insert(void** table, void* key, bool store_hashes_
 	*__fp_hash_entry_hop_info(*table, hash + infoOffset) |= (1 << distance);
 	return result;
 }
-#define fp_hash_insert_store_hashes(type, table, key, store_hashes_while_initializing) ((type*)__fp_hash_insert((void**)&table, &key, (store_hashes_while_initializing), sizeof(type), 0))
+#define fp_hash_insert_store_hashes(type, table, key, store_hashes_while_initializing) FP_PROFILE_SCOPE(type*, __fp_hash_insert((void**)&table, &key, (store_hashes_while_initializing), sizeof(type), 0))
 #define fp_hash_insert(type, table, key) fp_hash_insert_store_hashes(type, table, key, false)
 
 inline static void* __fp_hash_find(void* table, const void* key, size_t type_size) FP_NOEXCEPT {
@@ -419,7 +429,7 @@ inline static void* __fp_hash_insert_or_replace(void** table, void* key, size_t
 	__fp_hash_copy(*table, res, key, type_size);
 	return res;
 }
-#define fp_hash_insert_or_replace(type, table, key) ((type*)__fp_hash_insert_or_replace((void**)&table, &key, sizeof(type)))
+#define fp_hash_insert_or_replace(type, table, key) FP_PROFILE_SCOPE(type*, __fp_hash_insert_or_replace((void**)&table, &key, sizeof(type)))
 
 inline static void* __fp_hash_convert_array(void* a, size_t starting_offset, bool store_hashes_while_initializing, bool free_original, bool type_size_considered_by_array, size_t type_size, void* table /*= nullptr*/) {
 	if(!is_fp(a)) return nullptr;
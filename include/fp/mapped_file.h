@@ -0,0 +1,82 @@
+#ifndef __LIB_FAT_POINTER_MAPPED_FILE_H__
+#define __LIB_FAT_POINTER_MAPPED_FILE_H__
+
+#include "pointer.h"
+
+#ifndef FP_HAS_MMAP
+	#error "Mapped files require mmap support"
+#endif
+
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Mappings are laid out as [page holding the header][file contents][zeroed bytes out to the next page (at least one, for the null terminator)]
+inline static size_t __fp_mmap_file_data_length(size_t size) FP_NOEXCEPT { return __fp_mmap_round_to_pages(size + 1); }
+
+/**
+* @brief Maps a file into memory, the result is a fat pointer (of chars) whose length is the size of the file
+* @note Must be released with fp_munmap_file (or fp_string_free)
+* @param copy_on_write if true, the contents can be modified without the changes being written back to the file, otherwise they are read only
+* @return the mapped file, or null if it couldn't be opened or mapped
+*/
+char* fp_mmap_file(const char* path, bool copy_on_write) FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+	int fd = open(path, O_RDONLY);
+	if(fd < 0) return NULL;
+	struct stat info;
+	if(fstat(fd, &info) < 0 || !S_ISREG(info.st_mode) || (uint64_t)info.st_size > (fp_header_size_t)-1) {
+		close(fd);
+		return NULL;
+	}
+
+	size_t size = (size_t)info.st_size;
+	size_t page = (size_t)sysconf(_SC_PAGESIZE);
+	size_t data_length = __fp_mmap_file_data_length(size);
+	uint8_t* base = (uint8_t*)mmap(NULL, page + data_length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if(base == (uint8_t*)MAP_FAILED) {
+		close(fd);
+		return NULL;
+	}
+	// The file is mapped over the reserved range, whatever it doesn't cover stays zeroed
+	int protection = copy_on_write ? PROT_READ | PROT_WRITE : PROT_READ;
+	if(size > 0 && mmap(base + page, size, protection, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+		munmap(base, page + data_length);
+		close(fd);
+		return NULL;
+	}
+	close(fd);
+
+	uint8_t* p = base + page;
+	auto h = __fp_header(p);
+	h->magic = FP_MAPPED_MAGIC_NUMBER;
+	h->allocator = FP_DEFAULT_ALLOCATOR;
+	__fp_header_set_alignment(h, 0, 0);
+	h->size = size;
+	*(fp_header_size_t*)(((uint8_t*)h) - sizeof(fp_header_size_t)) = data_length - 1; // Stored where is_fp expects a capacity, so empty files are still fat pointers
+	return (char*)p;
+}
+#else
+;
+#endif
+
+FP_CONSTEXPR inline static bool fp_is_mapped_file(const void* p) FP_NOEXCEPT { return fp_magic_number(p) == FP_MAPPED_MAGIC_NUMBER; }
+
+// Unmaps a file mapped by fp_mmap_file
+inline static void fp_munmap_file(void* p) FP_NOEXCEPT {
+	if(p == NULL) return;
+	assert(fp_is_mapped_file(p));
+	size_t page = (size_t)sysconf(_SC_PAGESIZE);
+	munmap(((uint8_t*)p) - page, page + __fp_mmap_file_data_length(__fp_header(p)->size));
+}
+#define fp_munmap_file_and_null(p) (fp_munmap_file(p), p = NULL)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __LIB_FAT_POINTER_MAPPED_FILE_H__
@@ -0,0 +1,340 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "sort.hpp"
+
+// Ranges with fewer elements than this are processed on the calling thread
+#ifndef FP_PARALLEL_SEQUENTIAL_THRESHOLD
+#define FP_PARALLEL_SEQUENTIAL_THRESHOLD 32768
+#endif
+
+// How many chunks (per thread) for_each and transform split their range into, so that uneven work can still be balanced
+#ifndef FP_PARALLEL_CHUNKS_PER_THREAD
+#define FP_PARALLEL_CHUNKS_PER_THREAD 4
+#endif
+
+namespace fp {
+
+	// Fixed set of worker threads which cooperatively execute batches of indexed tasks
+	// NOTE: The thread calling run always participates, so a pool with N workers runs N + 1 tasks at once
+	// NOTE: Tasks must not throw, and a batch submitted from inside a task (of the same pool) is run sequentially
+	struct thread_pool {
+		static size_t default_workers() {
+			size_t hardware = std::thread::hardware_concurrency();
+			return hardware > 1 ? hardware - 1 : 0;
+		}
+
+		explicit thread_pool(size_t workers = default_workers()) { start(workers); }
+		~thread_pool() { stop(); }
+		thread_pool(const thread_pool&) = delete;
+		thread_pool& operator=(const thread_pool&) = delete;
+
+		// Shared pool used by the parallel algorithms when no other pool is provided
+		static thread_pool& global() {
+			static thread_pool pool;
+			return pool;
+		}
+
+		inline size_t workers() const { return threads.size(); }
+		inline size_t concurrency() const { return threads.size() + 1; }
+
+		// Replaces the worker threads (waits for any running batch to finish first, so must not be called from a task)
+		void resize(size_t workers) {
+			std::lock_guard guard(submit);
+			stop();
+			start(workers);
+		}
+
+		// Calls task(i) for every i in [0, count) and returns once they have all finished
+		template<typename F>
+		void run(size_t count, F&& task) {
+			if(count == 0) return;
+			if(count == 1 || threads.empty() || inside == this) {
+				for(size_t i = 0; i < count; ++i)
+					task(i);
+				return;
+			}
+			dispatch(count, [](void* task, size_t i) { (*(std::remove_reference_t<F>*)task)(i); }, &task);
+		}
+
+	protected:
+		struct batch {
+			void(*invoke)(void* task, size_t i);
+			void* task;
+			size_t count;
+			std::atomic<size_t> next = 0;
+		};
+
+		std::vector<std::thread> threads;
+		std::mutex submit; // Only one batch runs at a time
+		std::mutex lock;
+		std::condition_variable wake, finished;
+		batch* current = nullptr;
+		size_t generation = 0;
+		size_t active = 0; // Workers currently executing tasks from current
+		bool stopping = false;
+
+		static inline thread_local const thread_pool* inside = nullptr; // The pool whose tasks this thread is executing
+
+		void start(size_t workers) {
+			stopping = false;
+			threads.reserve(workers);
+			for(size_t i = 0; i < workers; ++i)
+				threads.emplace_back([this] { work(); });
+		}
+
+		void stop() {
+			{
+				std::lock_guard guard(lock);
+				stopping = true;
+			}
+			wake.notify_all();
+			for(auto& thread: threads)
+				thread.join();
+			threads.clear();
+		}
+
+		static void execute(batch& b) {
+			for(size_t i = b.next.fetch_add(1, std::memory_order_relaxed); i < b.count; i = b.next.fetch_add(1, std::memory_order_relaxed))
+				b.invoke(b.task, i);
+		}
+
+		void work() {
+			inside = this;
+			size_t seen = 0;
+			while(true) {
+				batch* b;
+				{
+					std::unique_lock guard(lock);
+					wake.wait(guard, [&] { return stopping || generation != seen; });
+					if(stopping) return;
+					seen = generation;
+					if(!(b = current)) continue; // The batch finished before this worker woke up
+					++active;
+				}
+
+				execute(*b);
+
+				std::lock_guard guard(lock);
+				if(--active == 0) finished.notify_all();
+			}
+		}
+
+		void dispatch(size_t count, void(*invoke)(void*, size_t), void* task) {
+			std::lock_guard submitting(submit);
+			batch b{invoke, task, count};
+			{
+				std::lock_guard guard(lock);
+				current = &b;
+				++generation;
+			}
+			wake.notify_all();
+
+			auto outer = std::exchange(inside, this);
+			execute(b);
+			inside = outer;
+
+			// Once every index has been claimed only workers which are still executing can touch the batch
+			std::unique_lock guard(lock);
+			finished.wait(guard, [&] { return active == 0; });
+			current = nullptr;
+		}
+	};
+
+	namespace parallel {
+
+		struct options {
+			thread_pool* pool = nullptr; // Defaults to thread_pool::global()
+			size_t sequential_threshold = FP_PARALLEL_SEQUENTIAL_THRESHOLD;
+		};
+
+		namespace detail {
+			inline thread_pool& pool(const options& opts) { return opts.pool ? *opts.pool : thread_pool::global(); }
+
+			// How many chunks a range of size elements should be split into (1 means it should be processed sequentially)
+			inline size_t chunk_count(size_t size, const options& opts, thread_pool& pool, size_t per_thread = 1) {
+				if(size < 2 || size < opts.sequential_threshold || pool.concurrency() == 1) return 1;
+				return std::min(size, pool.concurrency() * per_thread);
+			}
+
+			inline size_t chunk_start(size_t size, size_t chunks, size_t chunk) { return size * chunk / chunks; }
+
+			// Finds how many elements of a (the rest come from b) make up the first diagonal elements of their stable merge
+			template<typename T, typename Less>
+			size_t merge_path(const T* a, size_t a_size, const T* b, size_t b_size, size_t diagonal, Less& less) {
+				size_t low = diagonal > b_size ? diagonal - b_size : 0, high = std::min(diagonal, a_size);
+				while(low < high) {
+					size_t middle = (low + high) / 2;
+					if(less(b[diagonal - middle - 1], a[middle])) high = middle;
+					else low = middle + 1;
+				}
+				return low;
+			}
+		}
+
+		// Calls f on every element of the range
+		template<typename T, typename F>
+		void for_each(view<T> range, F f, const options& opts = {}) {
+			auto& pool = detail::pool(opts);
+			size_t size = range.size(), chunks = detail::chunk_count(size, opts, pool, FP_PARALLEL_CHUNKS_PER_THREAD);
+			T* data = range.data();
+			pool.run(chunks, [&](size_t chunk) {
+				for(size_t i = detail::chunk_start(size, chunks, chunk), end = detail::chunk_start(size, chunks, chunk + 1); i < end; ++i)
+					f(data[i]);
+			});
+		}
+
+		// Stores f(in[i]) in out[i], out must be at least as large as in (and may be the same range)
+		template<typename T, typename U, typename F>
+		void transform(view<T> in, view<U> out, F f, const options& opts = {}) {
+			assert(out.size() >= in.size());
+			auto& pool = detail::pool(opts);
+			size_t size = in.size(), chunks = detail::chunk_count(size, opts, pool, FP_PARALLEL_CHUNKS_PER_THREAD);
+			T* source = in.data();
+			U* dest = out.data();
+			pool.run(chunks, [&](size_t chunk) {
+				for(size_t i = detail::chunk_start(size, chunks, chunk), end = detail::chunk_start(size, chunks, chunk + 1); i < end; ++i)
+					dest[i] = f(source[i]);
+			});
+		}
+
+		// Assigns value to every element of the range
+		template<typename T>
+		void fill(view<T> range, const std::type_identity_t<T>& value, const options& opts = {}) {
+			auto& pool = detail::pool(opts);
+			size_t size = range.size(), chunks = detail::chunk_count(size, opts, pool);
+			T* data = range.data();
+			pool.run(chunks, [&](size_t chunk) {
+				std::fill(data + detail::chunk_start(size, chunks, chunk), data + detail::chunk_start(size, chunks, chunk + 1), value);
+			});
+		}
+
+		// Folds the range into init, op must be associative (the order elements are combined in is unspecified)
+		template<typename T, typename R, typename Op = std::plus<>>
+		R reduce(view<T> range, R init, Op op = {}, const options& opts = {}) {
+			auto& pool = detail::pool(opts);
+			size_t size = range.size(), chunks = detail::chunk_count(size, opts, pool);
+			T* data = range.data();
+			if(chunks == 1) {
+				for(size_t i = 0; i < size; ++i)
+					init = op(std::move(init), data[i]);
+				return init;
+			}
+
+			std::unique_ptr<std::optional<R>[]> partials(new std::optional<R>[chunks]);
+			pool.run(chunks, [&](size_t chunk) {
+				size_t i = detail::chunk_start(size, chunks, chunk), end = detail::chunk_start(size, chunks, chunk + 1);
+				R sum = data[i];
+				for(++i; i < end; ++i)
+					sum = op(std::move(sum), data[i]);
+				partials[chunk].emplace(std::move(sum));
+			});
+			for(size_t chunk = 0; chunk < chunks; ++chunk)
+				init = op(std::move(init), std::move(*partials[chunk]));
+			return init;
+		}
+
+		// Stores op(in[0], ..., in[i]) in out[i], out must be at least as large as in (and may be the same range)
+		// NOTE: op must be associative, the input is read twice (once to sum each chunk and once to scan it)
+		template<typename T, typename U, typename Op = std::plus<>>
+		void inclusive_scan(view<T> in, view<U> out, Op op = {}, const options& opts = {}) {
+			assert(out.size() >= in.size());
+			auto& pool = detail::pool(opts);
+			size_t size = in.size(), chunks = detail::chunk_count(size, opts, pool);
+			T* source = in.data();
+			U* dest = out.data();
+			auto scan = [&](size_t start, size_t end, std::optional<U> carry) {
+				for(size_t i = start; i < end; ++i) {
+					carry = carry ? op(std::move(*carry), source[i]) : U(source[i]);
+					dest[i] = *carry;
+				}
+			};
+			if(chunks == 1) return scan(0, size, std::nullopt);
+
+			// Sum each chunk (but the last), turn the sums into the running total before each chunk, then scan the chunks from there
+			std::unique_ptr<std::optional<U>[]> carries(new std::optional<U>[chunks]);
+			pool.run(chunks - 1, [&](size_t chunk) {
+				size_t i = detail::chunk_start(size, chunks, chunk), end = detail::chunk_start(size, chunks, chunk + 1);
+				U sum = source[i];
+				for(++i; i < end; ++i)
+					sum = op(std::move(sum), source[i]);
+				carries[chunk + 1].emplace(std::move(sum));
+			});
+			for(size_t chunk = 2; chunk < chunks; ++chunk)
+				carries[chunk] = op(*carries[chunk - 1], std::move(*carries[chunk])); // The previous carry still seeds its own chunk's scan, so it can't be moved from
+			pool.run(chunks, [&](size_t chunk) {
+				scan(detail::chunk_start(size, chunks, chunk), detail::chunk_start(size, chunks, chunk + 1), std::move(carries[chunk]));
+			});
+		}
+
+		// Sorts the range (not stable) by sorting one chunk per thread and then merging the chunks in parallel
+		// NOTE: Needs temporary storage for a second copy of the range
+		template<typename T, typename Less = std::less<>>
+		void sort(view<T> range, Less less = {}, const options& opts = {}) {
+			auto& pool = detail::pool(opts);
+			size_t size = range.size(), chunks = detail::chunk_count(size, opts, pool);
+			if(chunks == 1) return fp::sort(range, less);
+
+			T* data = range.data();
+			std::allocator<T> allocator;
+			T* buffer = allocator.allocate(size);
+			pool.run(chunks, [&](size_t chunk) {
+				size_t start = detail::chunk_start(size, chunks, chunk), end = detail::chunk_start(size, chunks, chunk + 1);
+				fp::sort(range.subview(start, end - start), less);
+				std::uninitialized_move(data + start, data + end, buffer + start);
+			});
+
+			// Each round merges pairs of neighbouring runs (width chunks wide) from source into dest
+			// Every thread produces one chunk of the output, starting where a binary search along the merge path says its inputs start
+			// NOTE: The searches all happen before any merging, since merging moves elements out of source
+			std::unique_ptr<size_t[]> splits(new size_t[chunks]);
+			T* source = buffer, *dest = data;
+			for(size_t width = 1; width < chunks; width *= 2) {
+				auto pair_bounds = [&](size_t chunk) {
+					size_t pair = chunk - chunk % (2 * width);
+					return std::array<size_t, 3>{
+						detail::chunk_start(size, chunks, pair),
+						detail::chunk_start(size, chunks, std::min(pair + width, chunks)),
+						detail::chunk_start(size, chunks, std::min(pair + 2 * width, chunks))
+					};
+				};
+				for(size_t chunk = 0; chunk < chunks; ++chunk) {
+					auto [start, middle, end] = pair_bounds(chunk);
+					splits[chunk] = detail::merge_path(source + start, middle - start, source + middle, end - middle, detail::chunk_start(size, chunks, chunk) - start, less);
+				}
+
+				pool.run(chunks, [&](size_t chunk) {
+					auto [start, middle, end] = pair_bounds(chunk);
+					size_t first = detail::chunk_start(size, chunks, chunk) - start, last = detail::chunk_start(size, chunks, chunk + 1) - start;
+					size_t a_first = splits[chunk], a_last = last == end - start ? middle - start : splits[chunk + 1];
+					std::merge(
+						std::make_move_iterator(source + start + a_first), std::make_move_iterator(source + start + a_last),
+						std::make_move_iterator(source + middle + (first - a_first)), std::make_move_iterator(source + middle + (last - a_last)),
+						dest + start + first, less
+					);
+				});
+				std::swap(source, dest);
+			}
+
+			pool.run(chunks, [&](size_t chunk) {
+				size_t start = detail::chunk_start(size, chunks, chunk), end = detail::chunk_start(size, chunks, chunk + 1);
+				if(source != data) std::move(buffer + start, buffer + end, data + start);
+				std::destroy(buffer + start, buffer + end);
+			});
+			allocator.deallocate(buffer, size);
+		}
+	}
+}
@@ -35,6 +35,17 @@
 	#define FP_TYPE_OF_REMOVE_POINTER(x) fp_type_of_remove_pointer_t<decltype(x)>
 #endif
 
+// NOTE: Included before any extern "C" block is opened since it may pull in C++ headers
+#if defined(FP_ENABLE_THREAD_CACHE) && !defined(FP_ALLOCATION_FUNCTION)
+	#include "allocator/thread_cache.h"
+	#define FP_ALLOCATION_FUNCTION fp_thread_cache_allocate
+#endif
+#if (defined(__unix__) || defined(__APPLE__)) && !defined(FP_DISABLE_MMAP)
+	#include "allocator/mmap.h"
+#endif
+#include "profile.h"
+#include "simd.h"
+
 #ifdef __cplusplus
 #include <bit>
 #include <type_traits>
@@ -119,21 +130,145 @@ extern "C" {
 #define FP_ALLOCATION_FUNCTION __fp_alloc_default_impl
 #endif
 
+/**
+* @brief Function used by a runtime allocator to allocate memory
+* @note Follows the same semantics as FP_ALLOCATION_FUNCTION
+* @param userdata the userdata pointer the allocator was registered with
+* @param p pointer to reallocate
+* @param size the size in raw bytes to allocate
+* @return a pointer to the new allocation or null if the allocation was freed
+*/
+typedef void*(*fp_allocator_function_t)(void* userdata, void* p, size_t size) FP_NOEXCEPT;
+
+struct fp_allocator {
+	fp_allocator_function_t allocate;
+	void* userdata;
+};
+
+// Index into the allocator registry, every heap allocation remembers the id of the allocator which created it
+typedef uint16_t fp_allocator_id;
+#define FP_DEFAULT_ALLOCATOR ((fp_allocator_id)0) // Always refers to FP_ALLOCATION_FUNCTION
+
+#ifndef FP_MAX_ALLOCATORS
+#define FP_MAX_ALLOCATORS 64
+#endif
+
+#ifdef FP_HAS_MMAP
+	// Reserved id which refers to anonymous memory mappings, large allocations from the default allocator are automatically moved here (see fp_mmap_options)
+	#define FP_MMAP_ALLOCATOR ((fp_allocator_id)(FP_MAX_ALLOCATORS - 1))
+#endif
+
+struct fp_allocator* __fp_allocator_registry() FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+	static struct fp_allocator registry[FP_MAX_ALLOCATORS] = {};
+	return registry;
+}
+#else
+;
+#endif
+
+/**
+* @brief Registers a runtime allocator which fat pointers can then be allocated in
+* @note Registration is not thread safe, allocators should be registered before they are shared between threads
+* @return the id of the allocator, or FP_DEFAULT_ALLOCATOR if the registry is full
+*/
+fp_allocator_id fp_allocator_register(struct fp_allocator allocator) FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+	assert(allocator.allocate);
+	struct fp_allocator* registry = __fp_allocator_registry();
+	for(fp_allocator_id id = FP_DEFAULT_ALLOCATOR + 1; id < FP_MAX_ALLOCATORS; ++id) {
+#ifdef FP_MMAP_ALLOCATOR
+		if(id == FP_MMAP_ALLOCATOR) continue;
+#endif
+		if(registry[id].allocate == NULL) {
+			registry[id] = allocator;
+			return id;
+		}
+	}
+	return FP_DEFAULT_ALLOCATOR;
+}
+#else
+;
+#endif
+
+/**
+* @brief Removes an allocator from the registry
+* @note Every allocation made by the allocator must have been freed before it is unregistered
+*/
+inline static void fp_allocator_unregister(fp_allocator_id id) FP_NOEXCEPT {
+	if(id == FP_DEFAULT_ALLOCATOR || id >= FP_MAX_ALLOCATORS) return;
+#ifdef FP_MMAP_ALLOCATOR
+	if(id == FP_MMAP_ALLOCATOR) return;
+#endif
+	__fp_allocator_registry()[id].allocate = NULL;
+	__fp_allocator_registry()[id].userdata = NULL;
+}
+
+inline static void* __fp_allocator_allocate(fp_allocator_id id, void* p, size_t size) FP_NOEXCEPT {
+	if(id == FP_DEFAULT_ALLOCATOR) return FP_ALLOCATION_FUNCTION(p, size);
+#ifdef FP_MMAP_ALLOCATOR
+	if(id == FP_MMAP_ALLOCATOR) return __fp_mmap_allocate(NULL, p, size);
+#endif
+
+	assert(id < FP_MAX_ALLOCATORS);
+	struct fp_allocator* allocator = __fp_allocator_registry() + id;
+	assert(allocator->allocate); // Allocator was unregistered while it still owned memory!
+	return allocator->allocate(allocator->userdata, p, size);
+}
+
 enum FP_MagicNumbers {
 	FP_MAGIC_NUMBER = 0xFE00,
 	FP_HEAP_MAGIC_NUMBER = 0xFEFE,
 	FP_STACK_MAGIC_NUMBER = 0xFEFF,
 	FP_DYNARRAY_MAGIC_NUMBER = 0xFEFD,
 	FP_HASH_MAGIC_NUMBER = 0xFEFC,
+	FP_MAPPED_MAGIC_NUMBER = 0xFEFB,
+	FP_SMALL_DYNARRAY_MAGIC_NUMBER = 0xFEFA,
+	FP_DEQUE_MAGIC_NUMBER = 0xFEF9,
+	FP_SOA_DYNARRAY_MAGIC_NUMBER = 0xFEF8,
+	FP_BITSET_MAGIC_NUMBER = 0xFEF7,
 };
 
+// Defining FP_COMPACT_HEADERS shrinks headers to 8 bytes (from 16) by limiting sizes and capacities to 32 bits,
+// alignments to 128 bytes, and the allocator registry to 64 entries
+#ifdef FP_COMPACT_HEADERS
+	typedef uint32_t fp_header_size_t;
+	#define FP_MAX_ALIGNMENT 128 // Largest alignment which can be stored in a header
+	#if FP_MAX_ALLOCATORS > 64
+		#error "Compact headers only have room for 64 allocators"
+	#endif
+#else
+	typedef size_t fp_header_size_t;
+	#define FP_MAX_ALIGNMENT 0x8000 // Largest alignment which can be stored in a header
+#endif
+
 struct __FatPointerHeaderTruncated { // TODO: Make sure to keep this struct in sync with the following one
 	uint16_t magic;
-	size_t size;
+#ifndef FP_COMPACT_HEADERS
+	fp_allocator_id allocator;
+	uint16_t alignment;
+	uint16_t alignment_offset;
+#else
+	fp_allocator_id allocator: 6;
+	uint16_t alignment_shift: 3;
+	uint16_t alignment_offset: 7;
+#endif
+	fp_header_size_t size;
 };
 struct __FatPointerHeader {
 	uint16_t magic;
-	size_t size;
+#ifndef FP_COMPACT_HEADERS
+	fp_allocator_id allocator; // NOTE: Lives in what would otherwise be padding
+	uint16_t alignment; // Alignment (in bytes) requested for the data, 0 if none was requested
+	uint16_t alignment_offset; // Number of bytes between the start of the underlying allocation and the header
+#else
+	fp_allocator_id allocator: 6;
+	uint16_t alignment_shift: 3; // Log2 of the alignment requested for the data, 0 if none was requested
+	uint16_t alignment_offset: 7; // Number of bytes between the start of the underlying allocation and the header
+#endif
+	fp_header_size_t size;
 #ifndef __cplusplus
 	uint8_t data[];
 #else
@@ -179,21 +314,21 @@ static thread_local struct __FatPointerHeader* __fp_global_header;
 #define fp_alloca_void(_typesize, _size) (__fp_global_header = (struct __FatPointerHeader*)alloca(FP_HEADER_SIZE + _typesize * _size + 1),\
 	*__fp_global_header = (struct __FatPointerHeader) {\
 		.magic = FP_STACK_MAGIC_NUMBER,\
-		.size = (_size),\
+		.size = (fp_header_size_t)(_size),\
 	}, (void*)(((uint8_t*)__fp_global_header) + FP_HEADER_SIZE))
 #elif defined(_WIN32)
 #include <malloc.h>
 #define fp_alloca_void(_typesize, _size) ((void*)(((uint8_t*)&((*(__FatPointerHeader*)_alloca(FP_HEADER_SIZE + _typesize * FP_MAX(_size, 8) + 1)) = \
 	__FatPointerHeader {\
 		.magic = FP_STACK_MAGIC_NUMBER,\
-		.size = (_size),\
+		.size = (fp_header_size_t)(_size),\
 	})) + FP_HEADER_SIZE))
 #else
 #include <alloca.h>
 #define fp_alloca_void(_typesize, _size) ((void*)(((uint8_t*)&((*(__FatPointerHeader*)alloca(FP_HEADER_SIZE + _typesize * FP_MAX(_size, 8) + 1)) = \
 	__FatPointerHeader {\
 		.magic = FP_STACK_MAGIC_NUMBER,\
-		.size = (_size),\
+		.size = (fp_header_size_t)(_size),\
 	})) + FP_HEADER_SIZE))
 #endif
 #define fp_alloca(type, _size) ((type*)fp_alloca_void(sizeof(type), _size))
@@ -208,53 +343,124 @@ FP_CONSTEXPR inline static struct __FatPointerHeader* __fp_header(const void* _p
 #endif
 }
 
+FP_CONSTEXPR inline static size_t __fp_header_alignment(const struct __FatPointerHeader* h) FP_NOEXCEPT {
+#ifndef FP_COMPACT_HEADERS
+	return h->alignment;
+#else
+	return h->alignment_shift ? ((size_t)1) << h->alignment_shift : 0;
+#endif
+}
 
-void* __fp_alloc(void* _p, size_t _size) FP_NOEXCEPT
+inline static void __fp_header_set_alignment(struct __FatPointerHeader* h, size_t alignment, size_t offset) FP_NOEXCEPT {
+#ifndef FP_COMPACT_HEADERS
+	h->alignment = (uint16_t)alignment;
+#else
+	uint16_t shift = 0;
+	while(((size_t)2 << shift) <= alignment) ++shift;
+	h->alignment_shift = shift;
+#endif
+	h->alignment_offset = (uint16_t)offset;
+}
+
+// Bytes requested from the allocator for a fat pointer holding \p size bytes aligned to \p alignment (what the mapping threshold is checked against)
+inline static size_t __fp_allocation_size(size_t size, size_t alignment) FP_NOEXCEPT { return (alignment > 1 ? alignment - 1 : 0) + FP_HEADER_SIZE + size + 1; }
+
+/**
+* @brief Allocates, reallocates, or frees (\p _size == 0) a heap fat pointer
+* @param allocator the allocator to use if \p _p is null
+* @param alignment the alignment (a power of two, 0 for none) to use if \p _p is null
+* @param bias how far past the start of the data the aligned address should be (used by dynarrays to align their elements instead of their header)
+* @note if \p _p is not null it is always sent back to the allocator which originally allocated it, and keeps its original alignment
+*/
+void* __fp_alloc_aligned_in(void* _p, size_t _size, fp_allocator_id allocator, size_t alignment, size_t bias) FP_NOEXCEPT
 #ifdef FP_IMPLEMENTATION
 {
 	if(_p == NULL && _size == 0) return NULL;
-	if(_size == 0)
-		return FP_ALLOCATION_FUNCTION(__fp_header(_p), 0);
+	size_t old_offset = 0;
+#ifdef FP_ENABLE_PROFILING
+	void* old_p = _p;
+	size_t old_size = _p ? __fp_header(_p)->size : 0;
+#endif
+	if(_p) {
+		auto old = __fp_header(_p);
+		allocator = old->allocator;
+		alignment = __fp_header_alignment(old);
+		old_offset = old->alignment_offset;
+		_p = ((uint8_t*)old) - old_offset;
+	}
+	if(_size == 0) {
+		FP_PROFILE_EVENT(FP_PROFILE_FREE, old_p, 0, old_size, 0);
+		return __fp_allocator_allocate(allocator, _p, 0);
+	}
 
-	_p = _p == NULL ? _p : __fp_header(_p);
+	assert(alignment <= FP_MAX_ALIGNMENT && (alignment & (alignment - 1)) == 0);
 #ifdef __cplusplus
 	_size = FP_MAX(_size, 8); // Since the C++ header assumes the buffer is 8 elements large, it will overwrite memory out to 8 bytes... thus we must reserve at least that much memory
 #endif
-	size_t size = FP_HEADER_SIZE + _size + 1;
-	uint8_t* p = (uint8_t*)FP_ALLOCATION_FUNCTION(_p, size);
-	p += FP_HEADER_SIZE;
+	assert(_size <= (fp_header_size_t)-1); // Only possible to fail with compact headers
+	size_t padding = alignment > 1 ? alignment - 1 : 0;
+	size_t size = __fp_allocation_size(_size, alignment);
+#ifdef FP_MMAP_ALLOCATOR
+	size_t threshold = fp_mmap_options()->threshold;
+	if(_p == NULL && allocator == FP_DEFAULT_ALLOCATOR && threshold && size >= threshold)
+		allocator = FP_MMAP_ALLOCATOR;
+#endif
+	uint8_t* p = (uint8_t*)__fp_allocator_allocate(allocator, _p, size);
 	if(!p) return 0;
+
+	size_t offset = 0;
+	if(padding) {
+		offset = (alignment - ((uintptr_t)(p + FP_HEADER_SIZE + bias) & padding)) & padding;
+		if(_p && offset != old_offset) // The reallocation landed on a differently aligned address, shift everything into place (both offsets are within the padding so this stays in bounds)
+			memmove(p + offset, p + old_offset, FP_HEADER_SIZE + _size + 1);
+	}
+	p += offset + FP_HEADER_SIZE;
 	auto h = __fp_header(p);
 	h->magic = FP_HEAP_MAGIC_NUMBER;
+	h->allocator = allocator;
+	__fp_header_set_alignment(h, alignment, offset);
 	h->size = _size;
 	h->data[_size] = 0;
+#ifdef FP_ENABLE_PROFILING
+	if(!_p) FP_PROFILE_EVENT(FP_PROFILE_ALLOCATE, p, _size, 0, 0);
+	else FP_PROFILE_EVENT(FP_PROFILE_REALLOCATE, p, _size, old_size, p != old_p || offset != old_offset ? FP_MIN(old_size, _size) : 0); // NOTE: Assumes the allocator copied if the block moved
+#endif
 	return p;
 }
 #else
 ;
 #endif
 
-inline static void* __fp_malloc(size_t type_size, size_t count) FP_NOEXCEPT { 
-	auto out = __fp_alloc(NULL, type_size * count);
+inline static void* __fp_alloc_in(void* _p, size_t _size, fp_allocator_id allocator) FP_NOEXCEPT { return __fp_alloc_aligned_in(_p, _size, allocator, 0, 0); }
+inline static void* __fp_alloc(void* _p, size_t _size) FP_NOEXCEPT { return __fp_alloc_in(_p, _size, FP_DEFAULT_ALLOCATOR); }
+
+inline static void* __fp_malloc_aligned_in(size_t type_size, size_t count, size_t alignment, fp_allocator_id allocator) FP_NOEXCEPT {
+	auto out = __fp_alloc_aligned_in(NULL, type_size * count, allocator, alignment, 0);
 	auto h = __fp_header(out);
 	h->magic = FP_HEAP_MAGIC_NUMBER;
 	h->size = count;
 	return out;
 }
-
-#define fp_malloc(type, _size) ((type*)__fp_malloc(sizeof(type), (_size)))
-
-#ifndef __cplusplus
-	#define fp_realloc(type, p, _size) ((type*)((uint8_t*)(*__fp_header(__fp_alloc((p), sizeof(type) * (_size))) = (struct __FatPointerHeader){\
-		.magic = FP_HEAP_MAGIC_NUMBER,\
-		.size = (_size),\
-	}).data))
-#else
-	#define fp_realloc(type, p, _size) ((type*)((uint8_t*)(*__fp_header(__fp_alloc((p), sizeof(type) * (_size))) = __FatPointerHeader{\
-		.magic = FP_HEAP_MAGIC_NUMBER,\
-		.size = (_size),\
-	}).data))
+inline static void* __fp_malloc_in(size_t type_size, size_t count, fp_allocator_id allocator) FP_NOEXCEPT { return __fp_malloc_aligned_in(type_size, count, 0, allocator); }
+inline static void* __fp_malloc(size_t type_size, size_t count) FP_NOEXCEPT { return __fp_malloc_in(type_size, count, FP_DEFAULT_ALLOCATOR); }
+
+#define fp_malloc(type, _size) FP_PROFILE_SCOPE(type*, __fp_malloc(sizeof(type), (_size)))
+#define fp_malloc_in(type, _size, allocator) FP_PROFILE_SCOPE(type*, __fp_malloc_in(sizeof(type), (_size), (allocator)))
+// Variants which guarantee that the first element is aligned to \p alignment bytes (a power of two), the alignment is kept by fp_realloc
+#define fp_malloc_aligned(type, _size, alignment) FP_PROFILE_SCOPE(type*, __fp_malloc_aligned_in(sizeof(type), (_size), (alignment), FP_DEFAULT_ALLOCATOR))
+#define fp_malloc_aligned_in(type, _size, alignment, allocator) FP_PROFILE_SCOPE(type*, __fp_malloc_aligned_in(sizeof(type), (_size), (alignment), (allocator)))
+
+inline static void* __fp_realloc(void* p, size_t type_size, size_t count) FP_NOEXCEPT {
+#ifdef FP_ENABLE_PROFILING
+	if(p) __fp_header(p)->size *= type_size; // Let the reallocation event see the old size in bytes
 #endif
+	auto out = __fp_alloc(p, type_size * count);
+	auto h = __fp_header(out);
+	h->magic = FP_HEAP_MAGIC_NUMBER;
+	h->size = count;
+	return out;
+}
+#define fp_realloc(type, p, _size) FP_PROFILE_SCOPE(type*, __fp_realloc((p), sizeof(type), (_size)))
 
 #ifdef __GNUC__
 __attribute__((no_sanitize_address)) // Don't let this function which routinely peaks out of valid bounds trigger the address sanitizer
@@ -262,7 +468,7 @@ __attribute__((no_sanitize_address)) // Don't let this function which routinely
 FP_CONSTEXPR inline static bool is_fp(const void* p) FP_NOEXCEPT {
 	if(p == NULL) return false;
 	auto h = __fp_header(p);
-	auto capacity = (size_t*)(((char*)h) - sizeof(size_t)); // Manually access fpda capacity
+	auto capacity = (fp_header_size_t*)(((char*)h) - sizeof(fp_header_size_t)); // Manually access fpda capacity
 	return (h->magic & 0xFF00) == FP_MAGIC_NUMBER && (h->size > 0 || *capacity > 0);
 }
 
@@ -273,10 +479,31 @@ FP_CONSTEXPR inline static size_t fp_magic_number(const void* p) FP_NOEXCEPT {
 }
 
 FP_CONSTEXPR inline static bool fp_is_stack_allocated(const void* p) FP_NOEXCEPT { return fp_magic_number(p) == FP_STACK_MAGIC_NUMBER; }
-FP_CONSTEXPR inline static bool fp_is_heap_allocated(const void* p) FP_NOEXCEPT { return fp_magic_number(p) == FP_HEAP_MAGIC_NUMBER || fp_magic_number(p) == FP_DYNARRAY_MAGIC_NUMBER || fp_magic_number(p) == FP_HASH_MAGIC_NUMBER; }
+FP_CONSTEXPR inline static bool fp_is_heap_allocated(const void* p) FP_NOEXCEPT { return fp_magic_number(p) == FP_HEAP_MAGIC_NUMBER || fp_magic_number(p) == FP_DYNARRAY_MAGIC_NUMBER || fp_magic_number(p) == FP_HASH_MAGIC_NUMBER || fp_magic_number(p) == FP_DEQUE_MAGIC_NUMBER || fp_magic_number(p) == FP_SOA_DYNARRAY_MAGIC_NUMBER || fp_magic_number(p) == FP_BITSET_MAGIC_NUMBER; }
+
+/**
+* @brief Determines which allocator a fat pointer was allocated with
+* @note Returns FP_DEFAULT_ALLOCATOR for anything which isn't a fat pointer
+*/
+FP_CONSTEXPR inline static fp_allocator_id fp_allocator_of(const void* p) FP_NOEXCEPT {
+	if(!is_fp(p)) return FP_DEFAULT_ALLOCATOR;
+	return __fp_header(p)->allocator;
+}
 
-inline static void fp_free(void* p) FP_NOEXCEPT { __fp_alloc(p, 0); }
-#define fp_free_and_null(p) (fp_free(p), p = NULL)
+/**
+* @brief Determines the alignment which was requested when a fat pointer was allocated
+* @note Returns 0 for fat pointers which didn't request an alignment and anything which isn't a fat pointer
+*/
+FP_CONSTEXPR inline static size_t fp_alignment(const void* p) FP_NOEXCEPT {
+	if(!is_fp(p)) return 0;
+	return __fp_header_alignment(__fp_header(p));
+}
+
+inline static void fp_free(void* p) FP_NOEXCEPT {
+	assert(p == NULL || fp_magic_number(p) != FP_MAPPED_MAGIC_NUMBER); // Mapped files must be released with fp_munmap_file
+	__fp_alloc(p, 0);
+}
+#define fp_free_and_null(p) (FP_PROFILE_SCOPE_VOID(fp_free(p)), p = NULL)
 
 FP_CONSTEXPR inline static size_t fp_length(const void* p) FP_NOEXCEPT {
 	if(!is_fp(p)) return 0;
@@ -306,10 +533,7 @@ void* memswap(void* a, void* b, size_t n) FP_NOEXCEPT
 #ifdef FP_IMPLEMENTATION
 {
 	if (a == b) return nullptr;
-	char* buffer = fp_alloca(char, n);
-	memcpy(buffer, a, n);
-	memcpy(a, b, n);
-	memcpy(b, buffer, n);
+	fp_simd_swap(a, b, n);
 	return a;
 }
 #else
@@ -328,11 +552,11 @@ inline static void* __fp_clone(const void* ptr, size_t type_size) FP_NOEXCEPT {
 	assert(is_fp(ptr));
 
 	size_t size = fp_size(ptr);
-	auto out = __fp_malloc(type_size, size);
+	auto out = __fp_malloc_aligned_in(type_size, size, fp_alignment(ptr), fp_allocator_of(ptr));
 	memcpy(out, ptr, size * type_size);
 	return out;
 }
-#define fp_clone(a) ((FP_TYPE_OF_REMOVE_POINTER(a)*)__fp_clone((a), sizeof(*a)))
+#define fp_clone(a) FP_PROFILE_SCOPE(FP_TYPE_OF_REMOVE_POINTER(a)*, __fp_clone((a), sizeof(*a)))
 
 
 #ifdef __cplusplus
@@ -415,30 +639,33 @@ FP_CONSTEXPR inline static fp_void_view __fp_make_subview(const fp_void_view vie
 
 #ifdef __cplusplus
 } // extern "C"
+	// NOTE: Typed views compare and swap all of the bytes of their elements
 	template<typename T>
 	FP_CONSTEXPR inline static int fp_view_compare(const fp_view(T) a, const fp_view(T) b) FP_NOEXCEPT {
-		if(fp_view_size(a) != fp_view_size(b)) return false;
-		return memcmp(fp_view_data_void(a), fp_view_data_void(b), fp_view_size(a));
+		if(fp_view_size(a) != fp_view_size(b)) return fp_view_size(a) < fp_view_size(b) ? -1 : 1;
+		return fp_simd_compare(fp_view_data_void(a), fp_view_data_void(b), fp_view_size(a) * sizeof(T));
 	}
 	template<typename T>
 	FP_CONSTEXPR inline static bool fp_view_equal(const fp_view(T) a, const fp_view(T) b) FP_NOEXCEPT {
-		return fp_view_compare(a, b) == 0;
+		if(fp_view_size(a) != fp_view_size(b)) return false;
+		return fp_simd_equal(fp_view_data_void(a), fp_view_data_void(b), fp_view_size(a) * sizeof(T));
 	}
 
 	template<typename T>
 	inline bool static fp_view_swap(fp_view(T) a, fp_view(T) b) FP_NOEXCEPT {
 		size_t size = fp_view_size(a);
 		if(size != fp_view_size(b)) return false;
-		return memswap(fp_view_data_void(a), fp_view_data_void(b), size) != nullptr;
+		return memswap(fp_view_data_void(a), fp_view_data_void(b), size * sizeof(T)) != nullptr;
 	}
 extern "C" {
 #endif
 FP_CONSTEXPR inline static int fp_view_compare(const fp_void_view a, const fp_void_view b) FP_NOEXCEPT {
-	if(fp_view_size(a) != fp_view_size(b)) return false;
-	return memcmp(fp_view_data_void(a), fp_view_data_void(b), fp_view_size(a));
+	if(fp_view_size(a) != fp_view_size(b)) return fp_view_size(a) < fp_view_size(b) ? -1 : 1;
+	return fp_simd_compare(fp_view_data_void(a), fp_view_data_void(b), fp_view_size(a));
 }
 FP_CONSTEXPR inline static bool fp_view_equal(const fp_void_view a, const fp_void_view b) FP_NOEXCEPT {
-	return fp_view_compare(a, b) == 0;
+	if(fp_view_size(a) != fp_view_size(b)) return false;
+	return fp_simd_equal(fp_view_data_void(a), fp_view_data_void(b), fp_view_size(a));
 }
 
 inline bool static fp_view_swap(fp_void_view a, fp_void_view b) FP_NOEXCEPT {
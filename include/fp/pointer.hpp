@@ -172,6 +172,8 @@ namespace fp {
 		inline bool is_fp() const { return ::is_fp(ptr()); }
 		inline bool stack_allocated() const { return fp_is_stack_allocated(ptr()); }
 		inline bool heap_allocated() const { return fp_is_heap_allocated(ptr()); }
+		inline fp_allocator_id allocator() const { return fp_allocator_of(ptr()); }
+		inline size_t alignment() const { return fp_alignment(ptr()); }
 		inline operator bool() const { return data() != nullptr; }
 
 		inline size_t length() const { return fp_length(ptr()); }
@@ -199,7 +201,10 @@ namespace fp {
 #endif
 
 		inline Derived& fill(const T& value = {}) {
-			std::fill(begin(), end(), value);
+			if constexpr(std::is_trivially_copyable_v<T>) {
+				T pattern = value; // The value may live inside of the array
+				fp_simd_fill(data(), &pattern, sizeof(T), size());
+			} else std::fill(begin(), end(), value);
 			return *(Derived*)this;
 		}
 
@@ -279,8 +284,12 @@ namespace fp {
 	}
 
 	template<typename T>
-	inline pointer<T> malloc(size_t count = 1) {
-		return fp_malloc(T, count);
+	inline pointer<T> malloc(size_t count = 1, fp_allocator_id allocator = FP_DEFAULT_ALLOCATOR) {
+		return fp_malloc_in(T, count, allocator);
+	}
+	template<typename T>
+	inline pointer<T> malloc_aligned(size_t count, size_t alignment, fp_allocator_id allocator = FP_DEFAULT_ALLOCATOR) {
+		return fp_malloc_aligned_in(T, count, alignment, allocator);
 	}
 	template<typename T>
 	inline pointer<T> realloc(pointer<T> ptr, size_t new_count) {
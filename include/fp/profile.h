@@ -0,0 +1,293 @@
+#ifndef __LIB_FAT_POINTER_PROFILE_H__
+#define __LIB_FAT_POINTER_PROFILE_H__
+
+// NOTE: This header sits underneath pointer.h (it is always included by it) so it can't depend on it
+// NOTE: Unless FP_ENABLE_PROFILING is defined everything in this header compiles away to nothing
+
+#ifndef FP_ENABLE_PROFILING
+
+// Marks the call site of a public macro whose expansion may allocate (evaluates to \p expr casted to \p type)
+#define FP_PROFILE_SCOPE(type, expr) ((type)(expr))
+#define FP_PROFILE_SCOPE_VOID(expr) ((void)(expr))
+// Reports an allocation event to the installed hook
+#define FP_PROFILE_EVENT(type, pointer, size, old_capacity, bytes_copied) ((void)0)
+// Reports a dynarray event which was carried out by a reallocation (that is reported separately)
+#define FP_PROFILE_REALLOCATED_EVENT(type, pointer, size, old_capacity) ((void)0)
+
+#else // FP_ENABLE_PROFILING
+
+#include "atomic.h"
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum fp_profile_event_type {
+	FP_PROFILE_ALLOCATE, // A new block was allocated by __fp_alloc
+	FP_PROFILE_REALLOCATE, // An existing block was resized by __fp_alloc
+	FP_PROFILE_FREE, // A block was released by __fp_alloc
+	FP_PROFILE_GROW, // A dynarray's capacity grew
+	FP_PROFILE_SHRINK, // A dynarray's capacity shrank
+	FP_PROFILE_HASH_RESIZE, // A hash table doubled in size (the underlying growth is reported separately)
+	FP_PROFILE_EVENT_TYPE_COUNT
+};
+
+// NOTE: All sizes are in bytes
+struct fp_profile_event {
+	enum fp_profile_event_type type;
+	const void* pointer; // The (new) block, or the freed block
+	size_t size; // The requested size (or new capacity)
+	size_t old_capacity; // The size (or capacity) before the event, 0 for new blocks
+	size_t bytes_copied; // How much data had to be copied to carry out the event
+	bool reallocated; // The event was carried out by a reallocation, which (along with any copying it did) is reported separately
+	const char* file; // The outermost library macro the event happened underneath, null if the event didn't happen underneath one
+	int line;
+};
+
+typedef void(*fp_profile_hook_t)(const struct fp_profile_event* event, void* userdata);
+
+struct __FatProfileHook {
+	fp_profile_hook_t hook;
+	void* userdata;
+};
+
+struct __FatProfileHook* __fp_profile_hook() FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+	static struct __FatProfileHook hook = {NULL, NULL};
+	return &hook;
+}
+#else
+;
+#endif
+
+// Installs a hook which is called for every allocation event (null uninstalls it)
+// NOTE: Should not be changed concurrently with allocations, the hook itself may be called from any thread
+inline static void fp_profile_set_hook(fp_profile_hook_t hook, void* userdata) FP_NOEXCEPT {
+	auto h = __fp_profile_hook();
+	h->hook = hook;
+	h->userdata = userdata;
+}
+
+struct __FatProfileCallSite {
+	const char* file;
+	int line;
+	size_t depth; // How many macros are currently nested, only the outermost one marks the call site
+};
+
+struct __FatProfileCallSite* __fp_profile_call_site() FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+	static thread_local struct __FatProfileCallSite site = {NULL, 0, 0};
+	return &site;
+}
+#else
+;
+#endif
+
+inline static void __fp_profile_enter(const char* file, int line) FP_NOEXCEPT {
+	auto site = __fp_profile_call_site();
+	if(site->depth++ == 0) {
+		site->file = file;
+		site->line = line;
+	}
+}
+
+inline static void* __fp_profile_leave(const void* result) FP_NOEXCEPT {
+	auto site = __fp_profile_call_site();
+	if(--site->depth == 0) {
+		site->file = NULL;
+		site->line = 0;
+	}
+	return (void*)result;
+}
+
+inline static void __fp_profile_emit(enum fp_profile_event_type type, const void* pointer, size_t size, size_t old_capacity, size_t bytes_copied, bool reallocated) FP_NOEXCEPT {
+	auto h = __fp_profile_hook();
+	if(!h->hook) return;
+	auto site = __fp_profile_call_site();
+	struct fp_profile_event event = {type, pointer, size, old_capacity, bytes_copied, reallocated, site->file, site->line};
+	h->hook(&event, h->userdata);
+}
+
+#define FP_PROFILE_SCOPE(type, expr) ((type)__fp_profile_leave((__fp_profile_enter(__FILE__, __LINE__), (void*)(expr))))
+#define FP_PROFILE_SCOPE_VOID(expr) (__fp_profile_enter(__FILE__, __LINE__), (void)(expr), (void)__fp_profile_leave(NULL))
+#define FP_PROFILE_EVENT(type, pointer, size, old_capacity, bytes_copied) __fp_profile_emit((type), (pointer), (size), (old_capacity), (bytes_copied), false)
+#define FP_PROFILE_REALLOCATED_EVENT(type, pointer, size, old_capacity) __fp_profile_emit((type), (pointer), (size), (old_capacity), 0, true)
+
+
+// Aggregator
+
+#ifndef FP_PROFILE_MAX_CALL_SITES
+#define FP_PROFILE_MAX_CALL_SITES 1024
+#endif
+
+struct fp_profile_call_site_stats {
+	const char* file; // Null for events which didn't happen underneath a library macro
+	int line;
+	size_t events[FP_PROFILE_EVENT_TYPE_COUNT]; // How many of each type of event happened at this call site
+	size_t reallocations; // Reallocations, growths, and shrinks of existing blocks
+	size_t bytes_allocated;
+	size_t bytes_copied;
+};
+
+struct __FatProfileAggregate {
+	fp_spinlock lock;
+	size_t dropped; // Events which happened at call sites that didn't fit in the table
+	struct fp_profile_call_site_stats sites[FP_PROFILE_MAX_CALL_SITES];
+};
+
+struct __FatProfileAggregate* __fp_profile_aggregate() FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+	static struct __FatProfileAggregate aggregate;
+	return &aggregate;
+}
+#else
+;
+#endif
+
+inline static bool __fp_profile_same_call_site(const struct fp_profile_call_site_stats* stats, const char* file, int line) FP_NOEXCEPT {
+	if(stats->line != line) return false;
+	if(stats->file == file) return true;
+	return stats->file && file && strcmp(stats->file, file) == 0; // Each translation unit may have its own copy of __FILE__
+}
+
+inline static size_t __fp_profile_hash_call_site(const char* file, int line) FP_NOEXCEPT {
+	size_t hash = 14695981039346656037ull; // FNV-1a
+	if(file) for(; *file; ++file)
+		hash = (hash ^ (uint8_t)*file) * 1099511628211ull;
+	return (hash ^ (size_t)line) * 1099511628211ull;
+}
+
+/**
+* @brief Hook which accumulates events by call site, install with fp_profile_set_hook(fp_profile_aggregate, NULL)
+* @note Thread safe, but serializes every event behind a single lock
+*/
+void fp_profile_aggregate(const struct fp_profile_event* event, void* userdata) FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+	(void)userdata;
+	auto aggregate = __fp_profile_aggregate();
+	fp_spinlock_lock(&aggregate->lock);
+	int line = event->file ? event->line : -1; // Valid lines are positive, so 0 marks empty slots
+	size_t hash = __fp_profile_hash_call_site(event->file, line);
+	struct fp_profile_call_site_stats* stats = NULL;
+	for(size_t i = 0; i < FP_PROFILE_MAX_CALL_SITES; ++i) { // Linear probing
+		auto candidate = &aggregate->sites[(hash + i) % FP_PROFILE_MAX_CALL_SITES];
+		if(candidate->line == 0) {
+			candidate->file = event->file;
+			candidate->line = line;
+		}
+		if(__fp_profile_same_call_site(candidate, event->file, line)) {
+			stats = candidate;
+			break;
+		}
+	}
+
+	if(stats) {
+		stats->events[event->type]++;
+		if(event->type == FP_PROFILE_ALLOCATE || event->type == FP_PROFILE_REALLOCATE)
+			stats->bytes_allocated += event->size;
+		if((event->type == FP_PROFILE_REALLOCATE || event->type == FP_PROFILE_GROW || event->type == FP_PROFILE_SHRINK) && event->old_capacity > 0 && !event->reallocated)
+			stats->reallocations++;
+		stats->bytes_copied += event->bytes_copied;
+	} else aggregate->dropped++;
+	fp_spinlock_unlock(&aggregate->lock);
+}
+#else
+;
+#endif
+
+// Forgets every event which has been aggregated so far
+inline static void fp_profile_aggregate_reset() FP_NOEXCEPT {
+	auto aggregate = __fp_profile_aggregate();
+	fp_spinlock_lock(&aggregate->lock);
+	memset(aggregate->sites, 0, sizeof(aggregate->sites));
+	aggregate->dropped = 0;
+	fp_spinlock_unlock(&aggregate->lock);
+}
+
+inline static int __fp_profile_compare_bytes_copied(const void* _a, const void* _b) FP_NOEXCEPT {
+	auto a = (const struct fp_profile_call_site_stats*)_a;
+	auto b = (const struct fp_profile_call_site_stats*)_b;
+	if(a->bytes_copied != b->bytes_copied) return a->bytes_copied < b->bytes_copied ? 1 : -1;
+	return a->reallocations < b->reallocations ? 1 : a->reallocations > b->reallocations ? -1 : 0;
+}
+inline static int __fp_profile_compare_reallocations(const void* _a, const void* _b) FP_NOEXCEPT {
+	auto a = (const struct fp_profile_call_site_stats*)_a;
+	auto b = (const struct fp_profile_call_site_stats*)_b;
+	if(a->reallocations != b->reallocations) return a->reallocations < b->reallocations ? 1 : -1;
+	return a->bytes_copied < b->bytes_copied ? 1 : a->bytes_copied > b->bytes_copied ? -1 : 0;
+}
+
+/**
+* @brief Copies the (at most \p count) call sites which have copied the most bytes (or reallocated the most, if \p by_reallocations) into \p out
+* @note The unknown call site (collecting every event that didn't happen underneath a library macro) has a null file and a line of -1
+* @return How many call sites were copied
+*/
+size_t fp_profile_top_call_sites(struct fp_profile_call_site_stats* out, size_t count, bool by_reallocations) FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+	auto aggregate = __fp_profile_aggregate();
+	auto sorted = (struct fp_profile_call_site_stats*)malloc(sizeof(aggregate->sites));
+	if(!sorted) return 0;
+
+	size_t used = 0;
+	fp_spinlock_lock(&aggregate->lock);
+	for(size_t i = 0; i < FP_PROFILE_MAX_CALL_SITES; ++i)
+		if(aggregate->sites[i].line != 0)
+			sorted[used++] = aggregate->sites[i];
+	fp_spinlock_unlock(&aggregate->lock);
+
+	qsort(sorted, used, sizeof(*sorted), by_reallocations ? __fp_profile_compare_reallocations : __fp_profile_compare_bytes_copied);
+	if(count > used) count = used;
+	memcpy(out, sorted, count * sizeof(*sorted));
+	free(sorted);
+	return count;
+}
+#else
+;
+#endif
+
+// Prints the \p count call sites which copied the most bytes, followed by the \p count which reallocated the most
+void fp_profile_print_report(FILE* out, size_t count) FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+	auto sites = (struct fp_profile_call_site_stats*)malloc(sizeof(struct fp_profile_call_site_stats) * count);
+	if(!sites) return;
+
+	for(int by_reallocations = 0; by_reallocations < 2; ++by_reallocations) {
+		size_t found = fp_profile_top_call_sites(sites, count, by_reallocations);
+		fprintf(out, "Top %zu call sites by %s:\n", found, by_reallocations ? "reallocation count" : "bytes copied");
+		fprintf(out, "%14s %14s %14s %14s  %s\n", "bytes copied", "reallocations", "allocations", "frees", "call site");
+		for(size_t i = 0; i < found; ++i) {
+			auto s = sites + i;
+			fprintf(out, "%14zu %14zu %14zu %14zu  ", s->bytes_copied, s->reallocations, s->events[FP_PROFILE_ALLOCATE], s->events[FP_PROFILE_FREE]);
+			if(s->file) fprintf(out, "%s:%d\n", s->file, s->line);
+			else fprintf(out, "<unknown>\n");
+		}
+	}
+
+	size_t dropped = __fp_profile_aggregate()->dropped;
+	if(dropped) fprintf(out, "%zu events were dropped (more than FP_PROFILE_MAX_CALL_SITES call sites)\n", dropped);
+	free(sites);
+}
+#else
+;
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FP_ENABLE_PROFILING
+
+#endif // __LIB_FAT_POINTER_PROFILE_H__
@@ -0,0 +1,214 @@
+#ifndef __LIB_FAT_POINTER_QUEUE_H__
+#define __LIB_FAT_POINTER_QUEUE_H__
+
+// Bounded lock-free queues for passing fixed size elements between threads
+// Both store their elements in a fp_malloc'd power-of-two array, and keep the indices each side writes on their own cache lines
+
+#include "dynarray.h" // For fp_upper_power_of_two
+#include "atomic.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Elements in a MPMC queue's cells are placed this far after the cell's sequence number (which keeps them suitably aligned)
+#define __FP_MPMC_QUEUE_ELEMENT_OFFSET 16
+
+
+
+// Single producer single consumer ring buffer, every operation is wait-free
+// NOTE: Only one thread may push and only one (other) thread may pop at a time
+struct fp_spsc_queue {
+	uint8_t* buffer;
+	size_t mask; // Capacity - 1
+	size_t element_size;
+	uint8_t padding0[FP_CACHE_LINE_SIZE - sizeof(uint8_t*) - 2 * sizeof(size_t)];
+
+	FP_ATOMIC(size_t) head; // Index of the next element to pop, only written by the consumer
+	size_t cached_tail; // The consumer's last look at tail, so it only touches the producer's cache line once the elements it knows about run out
+	uint8_t padding1[FP_CACHE_LINE_SIZE - 2 * sizeof(size_t)];
+
+	FP_ATOMIC(size_t) tail; // Index of the next element to push, only written by the producer
+	size_t cached_head; // The producer's last look at head
+	uint8_t padding2[FP_CACHE_LINE_SIZE - 2 * sizeof(size_t)];
+};
+
+/**
+* @brief Creates a queue which can hold \p capacity (rounded up to a power of two) elements of \p element_size bytes
+* @return false if the queue's storage couldn't be allocated
+*/
+inline static bool fp_spsc_queue_init(struct fp_spsc_queue* q, size_t element_size, size_t capacity) FP_NOEXCEPT {
+	assert(element_size > 0);
+	capacity = fp_upper_power_of_two(capacity < 2 ? 2 : capacity);
+	q->buffer = (uint8_t*)__fp_malloc_aligned_in(element_size, capacity, FP_CACHE_LINE_SIZE, FP_DEFAULT_ALLOCATOR);
+	if(!q->buffer) return false;
+	q->mask = capacity - 1;
+	q->element_size = element_size;
+	fp_atomic_store(&q->head, 0, relaxed);
+	fp_atomic_store(&q->tail, 0, relaxed);
+	q->cached_head = q->cached_tail = 0;
+	return true;
+}
+#define fp_spsc_queue_init_type(q, type, capacity) fp_spsc_queue_init((q), sizeof(type), (capacity))
+
+inline static void fp_spsc_queue_free(struct fp_spsc_queue* q) FP_NOEXCEPT {
+	fp_free_and_null(q->buffer);
+}
+
+inline static size_t fp_spsc_queue_capacity(const struct fp_spsc_queue* q) FP_NOEXCEPT { return q->mask + 1; }
+// NOTE: Only exact when called from the producer or consumer while the other side is idle
+inline static size_t fp_spsc_queue_size(struct fp_spsc_queue* q) FP_NOEXCEPT {
+	return fp_atomic_load(&q->tail, acquire) - fp_atomic_load(&q->head, acquire);
+}
+
+// Copies (at most two runs of) count elements between the queue's buffer (starting at index) and elements
+inline static void __fp_spsc_queue_copy(struct fp_spsc_queue* q, size_t index, uint8_t* elements, size_t count, bool into_queue) FP_NOEXCEPT {
+	size_t start = index & q->mask, first = q->mask + 1 - start;
+	if(first > count) first = count;
+	uint8_t* slot = q->buffer + start * q->element_size;
+	if(into_queue) {
+		memcpy(slot, elements, first * q->element_size);
+		memcpy(q->buffer, elements + first * q->element_size, (count - first) * q->element_size);
+	} else {
+		memcpy(elements, slot, first * q->element_size);
+		memcpy(elements + first * q->element_size, q->buffer, (count - first) * q->element_size);
+	}
+}
+
+/**
+* @brief Pushes up to fp_view_size(\p elements) elements (stopping once the queue is full)
+* @note The elements are published together, so the consumer sees all of them at once
+* @return how many elements were pushed
+*/
+inline static size_t fp_spsc_queue_push_view(struct fp_spsc_queue* q, fp_void_view elements) FP_NOEXCEPT {
+	size_t tail = fp_atomic_load(&q->tail, relaxed), capacity = q->mask + 1;
+	size_t count = fp_view_size(elements);
+	if(tail - q->cached_head + count > capacity)
+		q->cached_head = fp_atomic_load(&q->head, acquire);
+	size_t space = capacity - (tail - q->cached_head);
+	if(count > space) count = space;
+	if(count == 0) return 0;
+
+	__fp_spsc_queue_copy(q, tail, fp_view_data(uint8_t, elements), count, true);
+	fp_atomic_store(&q->tail, tail + count, release);
+	return count;
+}
+inline static bool fp_spsc_queue_push(struct fp_spsc_queue* q, const void* element) FP_NOEXCEPT {
+	return fp_spsc_queue_push_view(q, fp_void_view_literal(element, 1)) == 1;
+}
+
+/**
+* @brief Pops up to fp_view_size(\p out) elements into \p out (stopping once the queue is empty)
+* @return how many elements were popped
+*/
+inline static size_t fp_spsc_queue_pop_view(struct fp_spsc_queue* q, fp_void_view out) FP_NOEXCEPT {
+	size_t head = fp_atomic_load(&q->head, relaxed);
+	size_t count = fp_view_size(out);
+	if(q->cached_tail - head < count)
+		q->cached_tail = fp_atomic_load(&q->tail, acquire);
+	size_t available = q->cached_tail - head;
+	if(count > available) count = available;
+	if(count == 0) return 0;
+
+	__fp_spsc_queue_copy(q, head, fp_view_data(uint8_t, out), count, false);
+	fp_atomic_store(&q->head, head + count, release);
+	return count;
+}
+inline static bool fp_spsc_queue_pop(struct fp_spsc_queue* q, void* out) FP_NOEXCEPT {
+	return fp_spsc_queue_pop_view(q, fp_void_view_literal(out, 1)) == 1;
+}
+
+
+
+// Multi producer multi consumer queue (Dmitry Vyukov's bounded queue), every operation is lock-free
+// Each cell carries a sequence number which tells producers and consumers whose turn it is to use the cell
+struct fp_mpmc_queue {
+	uint8_t* cells;
+	size_t mask; // Capacity - 1
+	size_t element_size;
+	size_t stride; // Bytes between cells
+	uint8_t padding0[FP_CACHE_LINE_SIZE - sizeof(uint8_t*) - 3 * sizeof(size_t)];
+
+	FP_ATOMIC(size_t) enqueue_position;
+	uint8_t padding1[FP_CACHE_LINE_SIZE - sizeof(size_t)];
+
+	FP_ATOMIC(size_t) dequeue_position;
+	uint8_t padding2[FP_CACHE_LINE_SIZE - sizeof(size_t)];
+};
+
+inline static FP_ATOMIC(size_t)* __fp_mpmc_queue_sequence(struct fp_mpmc_queue* q, size_t position) FP_NOEXCEPT {
+	return (FP_ATOMIC(size_t)*)(q->cells + (position & q->mask) * q->stride);
+}
+inline static uint8_t* __fp_mpmc_queue_element(struct fp_mpmc_queue* q, size_t position) FP_NOEXCEPT {
+	return q->cells + (position & q->mask) * q->stride + __FP_MPMC_QUEUE_ELEMENT_OFFSET;
+}
+
+/**
+* @brief Creates a queue which can hold \p capacity (rounded up to a power of two) elements of \p element_size bytes
+* @return false if the queue's storage couldn't be allocated
+*/
+inline static bool fp_mpmc_queue_init(struct fp_mpmc_queue* q, size_t element_size, size_t capacity) FP_NOEXCEPT {
+	assert(element_size > 0);
+	capacity = fp_upper_power_of_two(capacity < 2 ? 2 : capacity);
+	q->stride = (__FP_MPMC_QUEUE_ELEMENT_OFFSET + element_size + __FP_MPMC_QUEUE_ELEMENT_OFFSET - 1) & ~(size_t)(__FP_MPMC_QUEUE_ELEMENT_OFFSET - 1);
+	q->cells = (uint8_t*)__fp_malloc_aligned_in(q->stride, capacity, FP_CACHE_LINE_SIZE, FP_DEFAULT_ALLOCATOR);
+	if(!q->cells) return false;
+	q->mask = capacity - 1;
+	q->element_size = element_size;
+	for(size_t i = 0; i < capacity; ++i)
+		fp_atomic_store(__fp_mpmc_queue_sequence(q, i), i, relaxed);
+	fp_atomic_store(&q->enqueue_position, 0, relaxed);
+	fp_atomic_store(&q->dequeue_position, 0, relaxed);
+	return true;
+}
+#define fp_mpmc_queue_init_type(q, type, capacity) fp_mpmc_queue_init((q), sizeof(type), (capacity))
+
+inline static void fp_mpmc_queue_free(struct fp_mpmc_queue* q) FP_NOEXCEPT {
+	fp_free_and_null(q->cells);
+}
+
+inline static size_t fp_mpmc_queue_capacity(const struct fp_mpmc_queue* q) FP_NOEXCEPT { return q->mask + 1; }
+
+// Pushes a copy of \p element, returns false if the queue was full
+inline static bool fp_mpmc_queue_push(struct fp_mpmc_queue* q, const void* element) FP_NOEXCEPT {
+	size_t position = fp_atomic_load(&q->enqueue_position, relaxed);
+	FP_ATOMIC(size_t)* sequence;
+	while(true) {
+		sequence = __fp_mpmc_queue_sequence(q, position);
+		intptr_t difference = (intptr_t)fp_atomic_load(sequence, acquire) - (intptr_t)position;
+		if(difference == 0) { // The cell is free, try to claim it
+			if(fp_atomic_compare_exchange_weak(&q->enqueue_position, &position, position + 1, relaxed, relaxed))
+				break;
+		} else if(difference < 0) return false; // The cell still holds the element pushed a lap ago
+		else position = fp_atomic_load(&q->enqueue_position, relaxed); // Another producer claimed the cell first
+	}
+
+	memcpy(__fp_mpmc_queue_element(q, position), element, q->element_size);
+	fp_atomic_store(sequence, position + 1, release);
+	return true;
+}
+
+// Pops the oldest element into \p out, returns false if the queue was empty
+inline static bool fp_mpmc_queue_pop(struct fp_mpmc_queue* q, void* out) FP_NOEXCEPT {
+	size_t position = fp_atomic_load(&q->dequeue_position, relaxed);
+	FP_ATOMIC(size_t)* sequence;
+	while(true) {
+		sequence = __fp_mpmc_queue_sequence(q, position);
+		intptr_t difference = (intptr_t)fp_atomic_load(sequence, acquire) - (intptr_t)(position + 1);
+		if(difference == 0) { // The cell holds an element, try to claim it
+			if(fp_atomic_compare_exchange_weak(&q->dequeue_position, &position, position + 1, relaxed, relaxed))
+				break;
+		} else if(difference < 0) return false; // No element has been pushed into the cell yet
+		else position = fp_atomic_load(&q->dequeue_position, relaxed); // Another consumer claimed the cell first
+	}
+
+	memcpy(out, __fp_mpmc_queue_element(q, position), q->element_size);
+	fp_atomic_store(sequence, position + q->mask + 1, release); // Hand the cell to the producer one lap later
+	return true;
+}
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // __LIB_FAT_POINTER_QUEUE_H__
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <optional>
+#include <type_traits>
+
+#include "pointer.hpp"
+#include "queue.h"
+
+namespace fp {
+
+	// NOTE: Elements are copied bytewise in and out of the queues, so they must be trivially copyable
+
+	// Wait-free queue between exactly one producer thread and one consumer thread
+	template<typename T>
+	struct spsc_queue {
+		static_assert(std::is_trivially_copyable_v<T>, "Queue elements are copied bytewise");
+
+		explicit spsc_queue(size_t capacity) { [[maybe_unused]] bool ok = fp_spsc_queue_init(&q, sizeof(T), capacity); assert(ok); }
+		spsc_queue(const spsc_queue&) = delete;
+		spsc_queue& operator=(const spsc_queue&) = delete;
+		~spsc_queue() { fp_spsc_queue_free(&q); }
+
+		inline size_t capacity() const { return fp_spsc_queue_capacity(&q); }
+		inline size_t size() { return fp_spsc_queue_size(&q); }
+
+		inline bool push(const T& value) { return fp_spsc_queue_push(&q, &value); }
+		inline bool pop(T& out) { return fp_spsc_queue_pop(&q, &out); }
+		inline std::optional<T> pop() {
+			T out;
+			if(!pop(out)) return {};
+			return out;
+		}
+
+		// Push (or pop) as many elements as fit (or are available), returning how many were
+		inline size_t push_range(view<const T> values) { return fp_spsc_queue_push_view(&q, (fp_void_view)(fp_view(const T))values); }
+		inline size_t pop_range(view<T> out) { return fp_spsc_queue_pop_view(&q, (fp_void_view)(fp_view(T))out); }
+
+	protected:
+		fp_spsc_queue q;
+	};
+
+	// Lock-free queue between any number of producer and consumer threads
+	template<typename T>
+	struct mpmc_queue {
+		static_assert(std::is_trivially_copyable_v<T>, "Queue elements are copied bytewise");
+
+		explicit mpmc_queue(size_t capacity) { [[maybe_unused]] bool ok = fp_mpmc_queue_init(&q, sizeof(T), capacity); assert(ok); }
+		mpmc_queue(const mpmc_queue&) = delete;
+		mpmc_queue& operator=(const mpmc_queue&) = delete;
+		~mpmc_queue() { fp_mpmc_queue_free(&q); }
+
+		inline size_t capacity() const { return fp_mpmc_queue_capacity(&q); }
+
+		inline bool push(const T& value) { return fp_mpmc_queue_push(&q, &value); }
+		inline bool pop(T& out) { return fp_mpmc_queue_pop(&q, &out); }
+		inline std::optional<T> pop() {
+			T out;
+			if(!pop(out)) return {};
+			return out;
+		}
+
+	protected:
+		fp_mpmc_queue q;
+	};
+}
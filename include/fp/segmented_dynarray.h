@@ -0,0 +1,206 @@
+#ifndef __LIB_FAT_POINTER_SEGMENTED_DYNARRAY_H__
+#define __LIB_FAT_POINTER_SEGMENTED_DYNARRAY_H__
+
+// Growable array whose storage is a directory of power-of-two sized chunks (each twice as large as the one before it)
+// Growing only ever allocates a new chunk, so elements are never copied and pointers to them stay valid until they are popped,
+// and growth never needs the old and new storage alive at the same time
+// Any index is found with a couple of shifts, and the elements can be walked one contiguous fp_view per chunk
+
+#include "dynarray.h" // For fp_upper_power_of_two and fp_floor_log2
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Chunk k holds (first chunk size) << k elements, so this many chunks are enough for any realistic array
+#ifndef FP_SEGMENTED_DYNARRAY_MAX_CHUNKS
+#define FP_SEGMENTED_DYNARRAY_MAX_CHUNKS 48
+#endif
+
+// How large the first chunk is (rounded up to a power of two elements) when no size is requested
+#ifndef FP_SEGMENTED_DYNARRAY_DEFAULT_CHUNK_BYTES
+#define FP_SEGMENTED_DYNARRAY_DEFAULT_CHUNK_BYTES 4096
+#endif
+
+struct fp_segmented_dynarray {
+	size_t element_size;
+	size_t first_chunk_shift; // Log2 of the number of elements in the first chunk
+	size_t size;
+	size_t chunk_count; // Number of allocated chunks, always the first chunk_count entries of chunks
+	fp_allocator_id allocator;
+	uint8_t* chunks[FP_SEGMENTED_DYNARRAY_MAX_CHUNKS]; // Cache line aligned fat pointers
+};
+
+/**
+* @brief Creates an empty array of elements \p element_size bytes large
+* @param first_chunk_size how many elements the first chunk holds (rounded up to a power of two), or 0 for FP_SEGMENTED_DYNARRAY_DEFAULT_CHUNK_BYTES worth
+*/
+inline static void fp_segmented_dynarray_init_in(struct fp_segmented_dynarray* a, size_t element_size, size_t first_chunk_size, fp_allocator_id allocator) FP_NOEXCEPT {
+	assert(element_size > 0);
+	if(first_chunk_size == 0) first_chunk_size = FP_SEGMENTED_DYNARRAY_DEFAULT_CHUNK_BYTES / element_size;
+	a->element_size = element_size;
+	a->first_chunk_shift = fp_floor_log2(fp_upper_power_of_two(first_chunk_size ? first_chunk_size : 1));
+	a->size = 0;
+	a->chunk_count = 0;
+	a->allocator = allocator;
+	for(size_t i = 0; i < FP_SEGMENTED_DYNARRAY_MAX_CHUNKS; ++i)
+		a->chunks[i] = NULL;
+}
+#define fp_segmented_dynarray_init(a, element_size) fp_segmented_dynarray_init_in((a), (element_size), 0, FP_DEFAULT_ALLOCATOR)
+#define fp_segmented_dynarray_init_type(a, type) fp_segmented_dynarray_init((a), sizeof(type))
+
+inline static void fp_segmented_dynarray_free(struct fp_segmented_dynarray* a) FP_NOEXCEPT {
+	for(size_t chunk = 0; chunk < a->chunk_count; ++chunk)
+		fp_free_and_null(a->chunks[chunk]);
+	a->chunk_count = 0;
+	a->size = 0;
+}
+
+inline static size_t fp_segmented_dynarray_size(const struct fp_segmented_dynarray* a) FP_NOEXCEPT { return a->size; }
+inline static bool fp_segmented_dynarray_empty(const struct fp_segmented_dynarray* a) FP_NOEXCEPT { return a->size == 0; }
+
+inline static size_t fp_segmented_dynarray_chunk_size(const struct fp_segmented_dynarray* a, size_t chunk) FP_NOEXCEPT {
+	return ((size_t)1) << (a->first_chunk_shift + chunk);
+}
+// Index of the first element in \p chunk (which is also how many elements the chunks before it hold)
+inline static size_t __fp_segmented_dynarray_chunk_start(const struct fp_segmented_dynarray* a, size_t chunk) FP_NOEXCEPT {
+	return ((((size_t)1) << chunk) - 1) << a->first_chunk_shift;
+}
+// Number of elements the allocated chunks can hold
+inline static size_t fp_segmented_dynarray_capacity(const struct fp_segmented_dynarray* a) FP_NOEXCEPT {
+	return __fp_segmented_dynarray_chunk_start(a, a->chunk_count);
+}
+
+// Finds which chunk the element at \p index lives in and where in that chunk it is
+inline static size_t __fp_segmented_dynarray_locate(const struct fp_segmented_dynarray* a, size_t index, size_t* offset) FP_NOEXCEPT {
+	size_t chunk = fp_floor_log2((index >> a->first_chunk_shift) + 1);
+	assert(chunk < FP_SEGMENTED_DYNARRAY_MAX_CHUNKS);
+	*offset = index - __fp_segmented_dynarray_chunk_start(a, chunk);
+	return chunk;
+}
+
+// Address of the element at \p index, which stays the same until the element is popped (or the array freed)
+inline static void* fp_segmented_dynarray_get(const struct fp_segmented_dynarray* a, size_t index) FP_NOEXCEPT {
+	assert(index < fp_segmented_dynarray_capacity(a));
+	size_t offset, chunk = __fp_segmented_dynarray_locate(a, index, &offset);
+	return a->chunks[chunk] + offset * a->element_size;
+}
+#define fp_segmented_dynarray_get_typed(type, a, index) ((type*)fp_segmented_dynarray_get((a), (index)))
+
+/**
+* @brief Allocates chunks until the array can hold \p count elements, existing elements are never touched
+* @return false if a chunk couldn't be allocated
+*/
+inline static bool fp_segmented_dynarray_reserve(struct fp_segmented_dynarray* a, size_t count) FP_NOEXCEPT {
+	while(fp_segmented_dynarray_capacity(a) < count) {
+		assert(a->chunk_count < FP_SEGMENTED_DYNARRAY_MAX_CHUNKS);
+		uint8_t* chunk = (uint8_t*)__fp_malloc_aligned_in(a->element_size, fp_segmented_dynarray_chunk_size(a, a->chunk_count), FP_CACHE_LINE_SIZE, a->allocator);
+		if(!chunk) return false;
+		a->chunks[a->chunk_count++] = chunk;
+	}
+	return true;
+}
+
+// Changes the size, added elements are left uninitialized
+inline static void fp_segmented_dynarray_resize(struct fp_segmented_dynarray* a, size_t size) FP_NOEXCEPT {
+	if(size > a->size && !fp_segmented_dynarray_reserve(a, size)) return;
+	a->size = size;
+}
+
+// @return the first of \p count new (uninitialized) elements at the back of the array (NULL if \p count is 0), they are only contiguous up to the end of its chunk
+inline static void* fp_segmented_dynarray_grow(struct fp_segmented_dynarray* a, size_t count) FP_NOEXCEPT {
+	if(count == 0) return NULL;
+	size_t start = a->size;
+	if(!fp_segmented_dynarray_reserve(a, start + count)) return NULL;
+	a->size += count;
+	return fp_segmented_dynarray_get(a, start);
+}
+
+// Copies the element at \p value onto the back of the array and returns its (stable) address
+inline static void* fp_segmented_dynarray_push_back(struct fp_segmented_dynarray* a, const void* value) FP_NOEXCEPT {
+	void* out = fp_segmented_dynarray_grow(a, 1);
+	if(out) memcpy(out, value, a->element_size);
+	return out;
+}
+
+// Copies \p count elements onto the back of the array (a chunk's run at a time), returns the index of the first one
+inline static size_t fp_segmented_dynarray_append(struct fp_segmented_dynarray* a, const void* data, size_t count) FP_NOEXCEPT {
+	size_t start = a->size;
+	if(!fp_segmented_dynarray_reserve(a, start + count)) return start;
+	const uint8_t* source = (const uint8_t*)data;
+	for(size_t index = start, remaining = count; remaining; ) {
+		size_t offset, chunk = __fp_segmented_dynarray_locate(a, index, &offset);
+		size_t run = fp_segmented_dynarray_chunk_size(a, chunk) - offset;
+		if(run > remaining) run = remaining;
+		memcpy(a->chunks[chunk] + offset * a->element_size, source, run * a->element_size);
+		source += run * a->element_size;
+		index += run;
+		remaining -= run;
+	}
+	a->size += count;
+	return start;
+}
+
+// Removes \p count elements from the back, @return the first removed element (which stays readable until the array grows again), or NULL if \p count is 0
+inline static void* fp_segmented_dynarray_pop_back_n(struct fp_segmented_dynarray* a, size_t count) FP_NOEXCEPT {
+	assert(count <= a->size);
+	if(count == 0) return NULL;
+	a->size -= count;
+	return fp_segmented_dynarray_get(a, a->size);
+}
+#define fp_segmented_dynarray_pop_back(a) fp_segmented_dynarray_pop_back_n((a), 1)
+
+// NOTE: Keeps every chunk, use fp_segmented_dynarray_shrink_to_fit to release them
+inline static void fp_segmented_dynarray_clear(struct fp_segmented_dynarray* a) FP_NOEXCEPT { a->size = 0; }
+
+// Frees every chunk which holds no elements
+inline static void fp_segmented_dynarray_shrink_to_fit(struct fp_segmented_dynarray* a) FP_NOEXCEPT {
+	while(a->chunk_count > 0 && __fp_segmented_dynarray_chunk_start(a, a->chunk_count - 1) >= a->size) {
+		a->chunk_count--;
+		fp_free_and_null(a->chunks[a->chunk_count]);
+	}
+}
+
+// Number of chunks which hold at least one element
+inline static size_t fp_segmented_dynarray_used_chunks(const struct fp_segmented_dynarray* a) FP_NOEXCEPT {
+	if(a->size == 0) return 0;
+	size_t offset;
+	return __fp_segmented_dynarray_locate(a, a->size - 1, &offset) + 1;
+}
+
+// The elements stored in \p chunk, which are contiguous
+inline static fp_void_view fp_segmented_dynarray_chunk_view(const struct fp_segmented_dynarray* a, size_t chunk) FP_NOEXCEPT {
+	size_t start = __fp_segmented_dynarray_chunk_start(a, chunk), size = 0;
+	if(start < a->size) {
+		size = a->size - start;
+		if(size > fp_segmented_dynarray_chunk_size(a, chunk)) size = fp_segmented_dynarray_chunk_size(a, chunk);
+	}
+	return fp_void_view_literal(size ? a->chunks[chunk] : NULL, size);
+}
+
+/**
+* @brief Walks the array one contiguous run at a time
+* @param view_name the name of the fp_void_view holding each chunk's elements
+*/
+#define fp_segmented_dynarray_iterate_chunks(a, view_name)\
+	for(size_t __fp_chunk = 0, __fp_chunks = fp_segmented_dynarray_used_chunks(a); __fp_chunk < __fp_chunks; ++__fp_chunk)\
+		for(fp_void_view view_name = fp_segmented_dynarray_chunk_view((a), __fp_chunk), *__fp_once = &view_name; __fp_once; __fp_once = NULL)
+
+// Copies every element into a single (contiguous) dynarray
+inline static void* fp_segmented_dynarray_to_dynarray(const struct fp_segmented_dynarray* a) FP_NOEXCEPT {
+	if(a->size == 0) return NULL;
+	void* out = NULL;
+	uint8_t* dest = (uint8_t*)__fpda_maybe_grow_in(&out, a->element_size, a->size, true, true, a->allocator) - (a->size - 1) * a->element_size;
+	fp_segmented_dynarray_iterate_chunks(a, chunk) {
+		memcpy(dest, chunk.data, chunk.size * a->element_size);
+		dest += chunk.size * a->element_size;
+	}
+	return out;
+}
+#define fp_segmented_dynarray_to_dynarray_typed(type, a) ((fp_dynarray(type))fp_segmented_dynarray_to_dynarray(a))
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // __LIB_FAT_POINTER_SEGMENTED_DYNARRAY_H__
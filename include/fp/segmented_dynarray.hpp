@@ -0,0 +1,154 @@
+#pragma once
+
+#include <compare>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+#include "dynarray.hpp"
+#include "segmented_dynarray.h"
+
+namespace fp {
+
+	// Growable array stored in power-of-two chunks, elements never move so references stay valid while it grows
+	// Offers the same element API as dynarray (push_back, pop_back, operator[], resize...) for code which needs stable addresses,
+	// and chunks() to walk the elements one contiguous view at a time
+	// NOTE: Elements are copied bytewise into the array, so they must be trivially copyable
+	template<typename T>
+	struct segmented_dynarray {
+		static_assert(std::is_trivially_copyable_v<T>, "Segmented dynarray elements are copied bytewise");
+
+		template<typename Array, typename Value>
+		struct basic_iterator {
+			using iterator_category = std::random_access_iterator_tag;
+			using value_type = std::remove_const_t<Value>;
+			using difference_type = std::ptrdiff_t;
+			using pointer = Value*;
+			using reference = Value&;
+
+			Array* array;
+			size_t index;
+
+			inline Value& operator*() const { return (*array)[index]; }
+			inline Value* operator->() const { return &(*array)[index]; }
+			inline Value& operator[](difference_type n) const { return (*array)[index + n]; }
+			inline basic_iterator& operator++() { ++index; return *this; }
+			inline basic_iterator operator++(int) { auto out = *this; ++index; return out; }
+			inline basic_iterator& operator--() { --index; return *this; }
+			inline basic_iterator operator--(int) { auto out = *this; --index; return out; }
+			inline basic_iterator& operator+=(difference_type n) { index += n; return *this; }
+			inline basic_iterator& operator-=(difference_type n) { index -= n; return *this; }
+			inline basic_iterator operator+(difference_type n) const { return {array, index + n}; }
+			inline basic_iterator operator-(difference_type n) const { return {array, index - n}; }
+			inline difference_type operator-(const basic_iterator& o) const { return difference_type(index) - difference_type(o.index); }
+			inline bool operator==(const basic_iterator& o) const { return index == o.index; }
+			inline auto operator<=>(const basic_iterator& o) const { return index <=> o.index; }
+		};
+		using iterator = basic_iterator<segmented_dynarray, T>;
+		using const_iterator = basic_iterator<const segmented_dynarray, const T>;
+
+		// Walks the chunks which hold elements, yielding a view of each one's elements
+		template<typename Value>
+		struct basic_chunk_range {
+			struct iterator {
+				const fp_segmented_dynarray* a;
+				size_t chunk;
+
+				inline view<Value> operator*() const {
+					auto v = fp_segmented_dynarray_chunk_view(a, chunk);
+					return {(Value*)v.data, v.size};
+				}
+				inline iterator& operator++() { ++chunk; return *this; }
+				inline bool operator==(const iterator& o) const { return chunk == o.chunk; }
+			};
+
+			const fp_segmented_dynarray* a;
+			inline iterator begin() const { return {a, 0}; }
+			inline iterator end() const { return {a, fp_segmented_dynarray_used_chunks(a)}; }
+			inline size_t size() const { return fp_segmented_dynarray_used_chunks(a); }
+			inline view<Value> operator[](size_t chunk) const { return *iterator{a, chunk}; }
+		};
+
+		// \p first_chunk_size is rounded up to a power of two, 0 picks FP_SEGMENTED_DYNARRAY_DEFAULT_CHUNK_BYTES worth of elements
+		explicit segmented_dynarray(size_t first_chunk_size = 0, fp_allocator_id allocator = FP_DEFAULT_ALLOCATOR) {
+			fp_segmented_dynarray_init_in(&a, sizeof(T), first_chunk_size, allocator);
+		}
+		segmented_dynarray(const segmented_dynarray& o) : segmented_dynarray(fp_segmented_dynarray_chunk_size(&o.a, 0), o.a.allocator) { *this = o; }
+		segmented_dynarray(segmented_dynarray&& o) : segmented_dynarray(fp_segmented_dynarray_chunk_size(&o.a, 0), o.a.allocator) { std::swap(a, o.a); }
+		segmented_dynarray& operator=(const segmented_dynarray& o) {
+			if(this == &o) return *this;
+			clear();
+			for(auto chunk: o.chunks()) append_range(chunk);
+			return *this;
+		}
+		segmented_dynarray& operator=(segmented_dynarray&& o) { if(this != &o) std::swap(a, o.a); return *this; }
+		~segmented_dynarray() { fp_segmented_dynarray_free(&a); }
+
+		inline size_t size() const { return fp_segmented_dynarray_size(&a); }
+		inline size_t length() const { return size(); }
+		inline bool empty() const { return fp_segmented_dynarray_empty(&a); }
+		inline size_t capacity() const { return fp_segmented_dynarray_capacity(&a); }
+
+		inline T& operator[](size_t i) { assert(i < size()); return *fp_segmented_dynarray_get_typed(T, &a, i); }
+		inline const T& operator[](size_t i) const { assert(i < size()); return *fp_segmented_dynarray_get_typed(const T, &a, i); }
+		inline T& front() { return (*this)[0]; }
+		inline const T& front() const { return (*this)[0]; }
+		inline T& back() { return (*this)[size() - 1]; }
+		inline const T& back() const { return (*this)[size() - 1]; }
+
+		inline iterator begin() { return {this, 0}; }
+		inline iterator end() { return {this, size()}; }
+		inline const_iterator begin() const { return {this, 0}; }
+		inline const_iterator end() const { return {this, size()}; }
+
+		inline basic_chunk_range<T> chunks() { return {&a}; }
+		inline basic_chunk_range<const T> chunks() const { return {&a}; }
+
+		inline segmented_dynarray& reserve(size_t size) {
+			fp_segmented_dynarray_reserve(&a, size);
+			return *this;
+		}
+		// Added elements are set to value
+		inline segmented_dynarray& resize(size_t size, const T& value = {}) {
+			size_t old = this->size();
+			fp_segmented_dynarray_resize(&a, size);
+			for(size_t i = old; i < this->size(); ++i) (*this)[i] = value;
+			return *this;
+		}
+		inline segmented_dynarray& grow(size_t to_add, const T& value = {}) { return resize(size() + to_add, value); }
+		inline segmented_dynarray& grow_to_size(size_t size, const T& value = {}) { return size > this->size() ? resize(size, value) : *this; }
+
+		inline T& push_back(const T& value) { return *(T*)fp_segmented_dynarray_push_back(&a, &value); }
+		// Returns the index of the first appended element
+		inline size_t append_range(view<const T> range) { return fp_segmented_dynarray_append(&a, range.data(), range.size()); }
+		inline size_t append_range(std::initializer_list<T> range) { return append_range(view<const T>{range.begin(), range.size()}); }
+
+		// Return the first removed element, which stays readable until the array grows again
+		// NOTE: count must be at least 1
+		inline T& pop_back_n(size_t count) {
+			assert(count > 0);
+			return *(T*)fp_segmented_dynarray_pop_back_n(&a, count);
+		}
+		inline T& pop_back() { return pop_back_n(1); }
+		inline T& pop_back_to_size(size_t size) {
+			assert(size < this->size());
+			return pop_back_n(this->size() - size);
+		}
+
+		inline segmented_dynarray& clear() {
+			fp_segmented_dynarray_clear(&a);
+			return *this;
+		}
+		// Releases the chunks which no longer hold any elements
+		inline segmented_dynarray& shrink_to_fit() {
+			fp_segmented_dynarray_shrink_to_fit(&a);
+			return *this;
+		}
+
+		// Copies every element into one contiguous dynarray
+		inline raii::dynarray<T> to_dynarray() const { return fp_segmented_dynarray_to_dynarray_typed(T, &a); }
+
+	protected:
+		fp_segmented_dynarray a;
+	};
+}
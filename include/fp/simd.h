@@ -0,0 +1,594 @@
+#ifndef __LIB_FAT_POINTER_SIMD_H__
+#define __LIB_FAT_POINTER_SIMD_H__
+
+// NOTE: This header sits underneath pointer.h (it is always included by it) so it can't depend on it
+// NOTE: Vector kernels are compiled with per-function target attributes and selected at runtime, so no special compiler flags are required
+//	(they are only available on x86 with GCC or Clang, everywhere else the scalar paths are used)
+
+#include "atomic.h"
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__)) && !defined(FP_DISABLE_SIMD)
+	#define FP_SIMD_X86
+	#include <immintrin.h>
+	#if defined(__GNUC__) && !defined(__clang__)
+		// GCC reports the _mm512_undefined_* placeholders some AVX-512 intrinsics pass through as uninitialized reads
+		#define __FP_SIMD_IGNORE_UNINITIALIZED_BEGIN _Pragma("GCC diagnostic push") _Pragma("GCC diagnostic ignored \"-Wuninitialized\"") _Pragma("GCC diagnostic ignored \"-Wmaybe-uninitialized\"")
+		#define __FP_SIMD_IGNORE_UNINITIALIZED_END _Pragma("GCC diagnostic pop")
+	#else
+		#define __FP_SIMD_IGNORE_UNINITIALIZED_BEGIN
+		#define __FP_SIMD_IGNORE_UNINITIALIZED_END
+	#endif
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Regions smaller than this skip the dispatch and use the scalar paths
+#ifndef FP_SIMD_MIN_BYTES
+#define FP_SIMD_MIN_BYTES 32
+#endif
+
+enum fp_simd_level {
+	FP_SIMD_SCALAR,
+	FP_SIMD_SSE2,
+	FP_SIMD_AVX2,
+	FP_SIMD_AVX512, // Requires AVX-512BW
+};
+
+// The operations fp_simd_bitwise can combine regions with
+enum fp_simd_bitwise_op {
+	FP_SIMD_AND,
+	FP_SIMD_OR,
+	FP_SIMD_XOR,
+	FP_SIMD_ANDNOT, // dest & ~src
+};
+
+// Determines the best instruction set the current CPU supports
+inline static enum fp_simd_level fp_simd_detect() FP_NOEXCEPT {
+#ifdef FP_SIMD_X86
+	__builtin_cpu_init();
+	if(__builtin_cpu_supports("avx512bw")) return FP_SIMD_AVX512;
+	if(__builtin_cpu_supports("avx2")) return FP_SIMD_AVX2;
+	if(__builtin_cpu_supports("sse2")) return FP_SIMD_SSE2;
+#endif
+	return FP_SIMD_SCALAR;
+}
+
+FP_ATOMIC(int)* __fp_simd_level_storage() FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+	static FP_ATOMIC(int) level = -1;
+	return &level;
+}
+#else
+;
+#endif
+
+// The instruction set the primitives in this header currently dispatch to (detected the first time it is needed)
+inline static enum fp_simd_level fp_simd_level() FP_NOEXCEPT {
+	int level = fp_atomic_load(__fp_simd_level_storage(), relaxed);
+	if(level < 0) {
+		level = fp_simd_detect();
+		fp_atomic_store(__fp_simd_level_storage(), level, relaxed);
+	}
+	return (enum fp_simd_level)level;
+}
+
+/**
+* @brief Overrides the instruction set the primitives dispatch to (useful for testing and benchmarking the different paths)
+* @return the level which will actually be used, levels the CPU doesn't support are lowered to the best one it does
+*/
+inline static enum fp_simd_level fp_simd_set_level(enum fp_simd_level level) FP_NOEXCEPT {
+	enum fp_simd_level supported = fp_simd_detect();
+	if(level > supported) level = supported;
+	fp_atomic_store(__fp_simd_level_storage(), (int)level, relaxed);
+	return level;
+}
+
+// Number of set bits in \p x
+inline static size_t fp_popcount64(uint64_t x) FP_NOEXCEPT {
+#if defined(__GNUC__) || defined(__clang__)
+	return (size_t)__builtin_popcountll(x);
+#else
+	x = x - ((x >> 1) & 0x5555555555555555ull);
+	x = (x & 0x3333333333333333ull) + ((x >> 2) & 0x3333333333333333ull);
+	x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+	return (size_t)((x * 0x0101010101010101ull) >> 56);
+#endif
+}
+
+// Index of the lowest set bit of \p x (which must not be zero)
+inline static size_t fp_count_trailing_zeros64(uint64_t x) FP_NOEXCEPT {
+	assert(x);
+#if defined(__GNUC__) || defined(__clang__)
+	return (size_t)__builtin_ctzll(x);
+#else
+	size_t count = 0;
+	while(!(x & 1)) {
+		x >>= 1;
+		++count;
+	}
+	return count;
+#endif
+}
+
+
+// Kernels, each one processes as many whole vectors as it can and returns how many bytes it handled
+
+#ifdef FP_SIMD_X86
+__attribute__((target("sse2"))) inline static size_t __fp_simd_swap_sse2(uint8_t* a, uint8_t* b, size_t n) FP_NOEXCEPT {
+	size_t i = 0;
+	for(; i + 16 <= n; i += 16) {
+		__m128i x = _mm_loadu_si128((__m128i*)(a + i)), y = _mm_loadu_si128((__m128i*)(b + i));
+		_mm_storeu_si128((__m128i*)(a + i), y);
+		_mm_storeu_si128((__m128i*)(b + i), x);
+	}
+	return i;
+}
+__attribute__((target("avx2"))) inline static size_t __fp_simd_swap_avx2(uint8_t* a, uint8_t* b, size_t n) FP_NOEXCEPT {
+	size_t i = 0;
+	for(; i + 32 <= n; i += 32) {
+		__m256i x = _mm256_loadu_si256((__m256i*)(a + i)), y = _mm256_loadu_si256((__m256i*)(b + i));
+		_mm256_storeu_si256((__m256i*)(a + i), y);
+		_mm256_storeu_si256((__m256i*)(b + i), x);
+	}
+	return i;
+}
+__attribute__((target("avx512f,avx512bw"))) inline static size_t __fp_simd_swap_avx512(uint8_t* a, uint8_t* b, size_t n) FP_NOEXCEPT {
+	size_t i = 0;
+	for(; i + 64 <= n; i += 64) {
+		__m512i x = _mm512_loadu_si512(a + i), y = _mm512_loadu_si512(b + i);
+		_mm512_storeu_si512(a + i, y);
+		_mm512_storeu_si512(b + i, x);
+	}
+	return i;
+}
+
+// The mismatch kernels return the index of the first differing byte, or how far they got without finding one
+__attribute__((target("sse2"))) inline static size_t __fp_simd_mismatch_sse2(const uint8_t* a, const uint8_t* b, size_t n) FP_NOEXCEPT {
+	size_t i = 0;
+	for(; i + 16 <= n; i += 16) {
+		unsigned equal = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((__m128i*)(a + i)), _mm_loadu_si128((__m128i*)(b + i))));
+		if(equal != 0xFFFF) return i + __builtin_ctz(~equal);
+	}
+	return i;
+}
+__attribute__((target("avx2"))) inline static size_t __fp_simd_mismatch_avx2(const uint8_t* a, const uint8_t* b, size_t n) FP_NOEXCEPT {
+	size_t i = 0;
+	for(; i + 32 <= n; i += 32) {
+		uint32_t equal = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((__m256i*)(a + i)), _mm256_loadu_si256((__m256i*)(b + i))));
+		if(equal != 0xFFFFFFFF) return i + __builtin_ctz(~equal);
+	}
+	return i;
+}
+__attribute__((target("avx512f,avx512bw"))) inline static size_t __fp_simd_mismatch_avx512(const uint8_t* a, const uint8_t* b, size_t n) FP_NOEXCEPT {
+	size_t i = 0;
+	for(; i + 64 <= n; i += 64) {
+		uint64_t different = _mm512_cmpneq_epi8_mask(_mm512_loadu_si512(a + i), _mm512_loadu_si512(b + i));
+		if(different) return i + __builtin_ctzll(different);
+	}
+	return i;
+}
+
+// The fill kernels repeat a 64 byte block (which must hold a whole number of copies of the pattern), a block at a time
+__attribute__((target("sse2"))) inline static size_t __fp_simd_fill_sse2(uint8_t* dest, const uint8_t* block, size_t n) FP_NOEXCEPT {
+	__m128i x0 = _mm_loadu_si128((__m128i*)block), x1 = _mm_loadu_si128((__m128i*)(block + 16));
+	__m128i x2 = _mm_loadu_si128((__m128i*)(block + 32)), x3 = _mm_loadu_si128((__m128i*)(block + 48));
+	size_t i = 0;
+	for(; i + 64 <= n; i += 64) {
+		_mm_storeu_si128((__m128i*)(dest + i), x0);
+		_mm_storeu_si128((__m128i*)(dest + i + 16), x1);
+		_mm_storeu_si128((__m128i*)(dest + i + 32), x2);
+		_mm_storeu_si128((__m128i*)(dest + i + 48), x3);
+	}
+	return i;
+}
+__attribute__((target("avx2"))) inline static size_t __fp_simd_fill_avx2(uint8_t* dest, const uint8_t* block, size_t n) FP_NOEXCEPT {
+	__m256i x0 = _mm256_loadu_si256((__m256i*)block), x1 = _mm256_loadu_si256((__m256i*)(block + 32));
+	size_t i = 0;
+	for(; i + 64 <= n; i += 64) {
+		_mm256_storeu_si256((__m256i*)(dest + i), x0);
+		_mm256_storeu_si256((__m256i*)(dest + i + 32), x1);
+	}
+	return i;
+}
+__attribute__((target("avx512f,avx512bw"))) inline static size_t __fp_simd_fill_avx512(uint8_t* dest, const uint8_t* block, size_t n) FP_NOEXCEPT {
+	__m512i x = _mm512_loadu_si512(block);
+	size_t i = 0;
+	for(; i + 64 <= n; i += 64)
+		_mm512_storeu_si512(dest + i, x);
+	return i;
+}
+
+// Compress kernels pack the elements (up to 64) whose bit is set in keep together, returning how many they wrote
+// NOTE: Each vector is loaded before anything is stored, so dest may overlap src as long as it doesn't come after it
+__attribute__((target("avx512f"))) inline static size_t __fp_simd_compress32_avx512(uint8_t* dest, const uint8_t* src, uint64_t keep, size_t count) FP_NOEXCEPT {
+	size_t written = 0;
+	for(size_t i = 0; i < count; i += 16) {
+		__mmask16 valid = (__mmask16)(count - i >= 16 ? 0xFFFF : (1u << (count - i)) - 1);
+		__mmask16 mask = (__mmask16)(keep >> i) & valid;
+		__m512i x = _mm512_maskz_loadu_epi32(valid, src + i * 4);
+		_mm512_mask_compressstoreu_epi32(dest + written * 4, mask, x);
+		written += __builtin_popcount(mask);
+	}
+	return written;
+}
+__attribute__((target("avx512f"))) inline static size_t __fp_simd_compress64_avx512(uint8_t* dest, const uint8_t* src, uint64_t keep, size_t count) FP_NOEXCEPT {
+	size_t written = 0;
+	for(size_t i = 0; i < count; i += 8) {
+		__mmask8 valid = (__mmask8)(count - i >= 8 ? 0xFF : (1u << (count - i)) - 1);
+		__mmask8 mask = (__mmask8)(keep >> i) & valid;
+		__m512i x = _mm512_maskz_loadu_epi64(valid, src + i * 8);
+		_mm512_mask_compressstoreu_epi64(dest + written * 8, mask, x);
+		written += __builtin_popcount(mask);
+	}
+	return written;
+}
+// The bitwise kernels combine dest with src (dest = dest op src)
+#define __FP_SIMD_BITWISE_LOOP(width, type, load, store, expression) for(; i + width <= n; i += width) {\
+		type x = load((type*)(dest + i)), y = load((type*)(src + i));\
+		store((type*)(dest + i), expression);\
+	} break
+__attribute__((target("sse2"))) inline static size_t __fp_simd_bitwise_sse2(uint8_t* dest, const uint8_t* src, size_t n, enum fp_simd_bitwise_op op) FP_NOEXCEPT {
+	size_t i = 0;
+	switch(op) {
+		case FP_SIMD_AND: __FP_SIMD_BITWISE_LOOP(16, __m128i, _mm_loadu_si128, _mm_storeu_si128, _mm_and_si128(x, y));
+		case FP_SIMD_OR: __FP_SIMD_BITWISE_LOOP(16, __m128i, _mm_loadu_si128, _mm_storeu_si128, _mm_or_si128(x, y));
+		case FP_SIMD_XOR: __FP_SIMD_BITWISE_LOOP(16, __m128i, _mm_loadu_si128, _mm_storeu_si128, _mm_xor_si128(x, y));
+		case FP_SIMD_ANDNOT: __FP_SIMD_BITWISE_LOOP(16, __m128i, _mm_loadu_si128, _mm_storeu_si128, _mm_andnot_si128(y, x));
+	}
+	return i;
+}
+__attribute__((target("avx2"))) inline static size_t __fp_simd_bitwise_avx2(uint8_t* dest, const uint8_t* src, size_t n, enum fp_simd_bitwise_op op) FP_NOEXCEPT {
+	size_t i = 0;
+	switch(op) {
+		case FP_SIMD_AND: __FP_SIMD_BITWISE_LOOP(32, __m256i, _mm256_loadu_si256, _mm256_storeu_si256, _mm256_and_si256(x, y));
+		case FP_SIMD_OR: __FP_SIMD_BITWISE_LOOP(32, __m256i, _mm256_loadu_si256, _mm256_storeu_si256, _mm256_or_si256(x, y));
+		case FP_SIMD_XOR: __FP_SIMD_BITWISE_LOOP(32, __m256i, _mm256_loadu_si256, _mm256_storeu_si256, _mm256_xor_si256(x, y));
+		case FP_SIMD_ANDNOT: __FP_SIMD_BITWISE_LOOP(32, __m256i, _mm256_loadu_si256, _mm256_storeu_si256, _mm256_andnot_si256(y, x));
+	}
+	return i;
+}
+__FP_SIMD_IGNORE_UNINITIALIZED_BEGIN
+__attribute__((target("avx512f,avx512bw"))) inline static size_t __fp_simd_bitwise_avx512(uint8_t* dest, const uint8_t* src, size_t n, enum fp_simd_bitwise_op op) FP_NOEXCEPT {
+	size_t i = 0;
+	switch(op) {
+		case FP_SIMD_AND: __FP_SIMD_BITWISE_LOOP(64, __m512i, _mm512_loadu_si512, _mm512_storeu_si512, _mm512_and_si512(x, y));
+		case FP_SIMD_OR: __FP_SIMD_BITWISE_LOOP(64, __m512i, _mm512_loadu_si512, _mm512_storeu_si512, _mm512_or_si512(x, y));
+		case FP_SIMD_XOR: __FP_SIMD_BITWISE_LOOP(64, __m512i, _mm512_loadu_si512, _mm512_storeu_si512, _mm512_xor_si512(x, y));
+		case FP_SIMD_ANDNOT: __FP_SIMD_BITWISE_LOOP(64, __m512i, _mm512_loadu_si512, _mm512_storeu_si512, _mm512_andnot_si512(y, x));
+	}
+	return i;
+}
+__FP_SIMD_IGNORE_UNINITIALIZED_END
+#undef __FP_SIMD_BITWISE_LOOP
+
+// The popcount kernels look up the bit count of each nibble with a byte shuffle (Mula's method) and sum the bytes with SAD,
+// they add the number of set bits they saw to count
+__attribute__((target("avx2"))) inline static size_t __fp_simd_popcount_avx2(const uint8_t* data, size_t n, uint64_t* count) FP_NOEXCEPT {
+	const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+	const __m256i low = _mm256_set1_epi8(0x0F);
+	__m256i total = _mm256_setzero_si256();
+	size_t i = 0;
+	for(; i + 32 <= n; i += 32) {
+		__m256i x = _mm256_loadu_si256((__m256i*)(data + i));
+		__m256i bits = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, _mm256_and_si256(x, low)), _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(x, 4), low)));
+		total = _mm256_add_epi64(total, _mm256_sad_epu8(bits, _mm256_setzero_si256()));
+	}
+	*count += (uint64_t)_mm256_extract_epi64(total, 0) + (uint64_t)_mm256_extract_epi64(total, 1) + (uint64_t)_mm256_extract_epi64(total, 2) + (uint64_t)_mm256_extract_epi64(total, 3);
+	return i;
+}
+__FP_SIMD_IGNORE_UNINITIALIZED_BEGIN
+__attribute__((target("avx512f,avx512bw"))) inline static size_t __fp_simd_popcount_avx512(const uint8_t* data, size_t n, uint64_t* count) FP_NOEXCEPT {
+	const __m512i lookup = _mm512_broadcast_i32x4(_mm_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4));
+	const __m512i low = _mm512_set1_epi8(0x0F);
+	__m512i total = _mm512_setzero_si512();
+	size_t i = 0;
+	for(; i + 64 <= n; i += 64) {
+		__m512i x = _mm512_loadu_si512(data + i);
+		__m512i bits = _mm512_add_epi8(_mm512_shuffle_epi8(lookup, _mm512_and_si512(x, low)), _mm512_shuffle_epi8(lookup, _mm512_and_si512(_mm512_srli_epi16(x, 4), low)));
+		total = _mm512_add_epi64(total, _mm512_sad_epu8(bits, _mm512_setzero_si512()));
+	}
+	*count += (uint64_t)_mm512_reduce_add_epi64(total);
+	return i;
+}
+__FP_SIMD_IGNORE_UNINITIALIZED_END
+// The unpack kernels extract count width bit values starting at bit start of packed, gathering each value's (unaligned) 8 bytes
+// then shifting and masking it into place, they return how many values they unpacked
+// NOTE: Only valid for widths up to 57 bits (so a value never spans more than 8 bytes)
+__attribute__((target("avx2"))) inline static size_t __fp_simd_unpack_bits_avx2(const uint8_t* packed, uint64_t start, size_t count, unsigned width, uint64_t* out) FP_NOEXCEPT {
+	const __m256i mask = _mm256_set1_epi64x((long long)((((uint64_t)1) << width) - 1)), seven = _mm256_set1_epi64x(7), step = _mm256_set1_epi64x(4 * (long long)width);
+	__m256i bits = _mm256_add_epi64(_mm256_set1_epi64x((long long)start), _mm256_setr_epi64x(0, width, 2 * width, 3 * width));
+	size_t i = 0;
+	for(; i + 4 <= count; i += 4) {
+		__m256i x = _mm256_i64gather_epi64((const long long*)packed, _mm256_srli_epi64(bits, 3), 1);
+		_mm256_storeu_si256((__m256i*)(out + i), _mm256_and_si256(_mm256_srlv_epi64(x, _mm256_and_si256(bits, seven)), mask));
+		bits = _mm256_add_epi64(bits, step);
+	}
+	return i;
+}
+__FP_SIMD_IGNORE_UNINITIALIZED_BEGIN
+__attribute__((target("avx512f"))) inline static size_t __fp_simd_unpack_bits_avx512(const uint8_t* packed, uint64_t start, size_t count, unsigned width, uint64_t* out) FP_NOEXCEPT {
+	const __m512i mask = _mm512_set1_epi64((long long)((((uint64_t)1) << width) - 1)), seven = _mm512_set1_epi64(7), step = _mm512_set1_epi64(8 * (long long)width);
+	__m512i bits = _mm512_add_epi64(_mm512_set1_epi64((long long)start), _mm512_setr_epi64(0, width, 2 * width, 3 * width, 4 * width, 5 * width, 6 * width, 7 * width));
+	size_t i = 0;
+	for(; i + 8 <= count; i += 8) {
+		__m512i x = _mm512_i64gather_epi64(_mm512_srli_epi64(bits, 3), (const long long*)packed, 1);
+		_mm512_storeu_si512(out + i, _mm512_and_si512(_mm512_srlv_epi64(x, _mm512_and_si512(bits, seven)), mask));
+		bits = _mm512_add_epi64(bits, step);
+	}
+	return i;
+}
+__FP_SIMD_IGNORE_UNINITIALIZED_END
+#endif // FP_SIMD_X86
+
+
+/**
+* @brief Swaps the contents of two (non-overlapping) regions of \p n bytes a vector at a time, without any temporary buffer
+*/
+void fp_simd_swap(void* _a, void* _b, size_t n) FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+	uint8_t* a = (uint8_t*)_a, *b = (uint8_t*)_b;
+	size_t i = 0;
+#ifdef FP_SIMD_X86
+	if(n >= FP_SIMD_MIN_BYTES) switch(fp_simd_level()) {
+		case FP_SIMD_AVX512: i = __fp_simd_swap_avx512(a, b, n); break;
+		case FP_SIMD_AVX2: i = __fp_simd_swap_avx2(a, b, n); break;
+		case FP_SIMD_SSE2: i = __fp_simd_swap_sse2(a, b, n); break;
+		default: break;
+	}
+#endif
+	for(; i + sizeof(uint64_t) <= n; i += sizeof(uint64_t)) {
+		uint64_t x, y;
+		memcpy(&x, a + i, sizeof(x));
+		memcpy(&y, b + i, sizeof(y));
+		memcpy(a + i, &y, sizeof(y));
+		memcpy(b + i, &x, sizeof(x));
+	}
+	for(; i < n; ++i) {
+		uint8_t x = a[i];
+		a[i] = b[i];
+		b[i] = x;
+	}
+}
+#else
+;
+#endif
+
+// Finds the index of the first byte which differs between two regions of \p n bytes, \p n if they are identical
+size_t fp_simd_mismatch(const void* _a, const void* _b, size_t n) FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+	const uint8_t* a = (const uint8_t*)_a, *b = (const uint8_t*)_b;
+	size_t i = 0;
+#ifdef FP_SIMD_X86
+	if(n >= FP_SIMD_MIN_BYTES) switch(fp_simd_level()) {
+		case FP_SIMD_AVX512: i = __fp_simd_mismatch_avx512(a, b, n); break;
+		case FP_SIMD_AVX2: i = __fp_simd_mismatch_avx2(a, b, n); break;
+		case FP_SIMD_SSE2: i = __fp_simd_mismatch_sse2(a, b, n); break;
+		default: break;
+	}
+	if(i < n && a[i] != b[i]) return i;
+#endif
+	for(; i < n; ++i)
+		if(a[i] != b[i]) return i;
+	return n;
+}
+#else
+;
+#endif
+
+// Compares two regions of \p n bytes, follows the same semantics as memcmp
+inline static int fp_simd_compare(const void* a, const void* b, size_t n) FP_NOEXCEPT {
+	if(n < FP_SIMD_MIN_BYTES) return memcmp(a, b, n);
+	size_t i = fp_simd_mismatch(a, b, n);
+	if(i == n) return 0;
+	return (int)((const uint8_t*)a)[i] - (int)((const uint8_t*)b)[i];
+}
+
+inline static bool fp_simd_equal(const void* a, const void* b, size_t n) FP_NOEXCEPT {
+	if(n < FP_SIMD_MIN_BYTES) return memcmp(a, b, n) == 0;
+	return fp_simd_mismatch(a, b, n) == n;
+}
+
+/**
+* @brief Fills \p count elements of \p pattern_size bytes starting at \p dest with copies of \p pattern
+* @note Patterns whose size divides 64 are broadcast into vector registers, all others are filled by repeatedly doubling the filled region
+*/
+void fp_simd_fill(void* _dest, const void* pattern, size_t pattern_size, size_t count) FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+	uint8_t* dest = (uint8_t*)_dest;
+	size_t n = pattern_size * count;
+	if(n == 0) return;
+	if(pattern_size == 1) {
+		memset(dest, *(const uint8_t*)pattern, n);
+		return;
+	}
+
+	size_t i = 0;
+#ifdef FP_SIMD_X86
+	if(n >= FP_SIMD_MIN_BYTES && 64 % pattern_size == 0) {
+		uint8_t block[64];
+		for(size_t j = 0; j < 64; j += pattern_size)
+			memcpy(block + j, pattern, pattern_size);
+		switch(fp_simd_level()) {
+			case FP_SIMD_AVX512: i = __fp_simd_fill_avx512(dest, block, n); break;
+			case FP_SIMD_AVX2: i = __fp_simd_fill_avx2(dest, block, n); break;
+			case FP_SIMD_SSE2: i = __fp_simd_fill_sse2(dest, block, n); break;
+			default: break;
+		}
+		if(i > 0) { // The kernels only store whole blocks, so the tail lines up with the start of the block
+			memcpy(dest + i, block, n - i);
+			return;
+		}
+	}
+#endif
+	memcpy(dest, pattern, pattern_size);
+	for(i = pattern_size; i < n; i *= 2)
+		memcpy(dest + i, dest, (n - i) < i ? (n - i) : i);
+}
+#else
+;
+#endif
+
+/**
+* @brief Packs the elements (of \p element_size bytes) among the first \p count (at most 64) of \p src whose bit is set in \p keep into \p dest, keeping their order
+* @note \p dest may overlap \p src as long as it doesn't come after it
+* @return the number of elements written
+*/
+size_t fp_simd_compress(void* _dest, const void* _src, uint64_t keep, size_t count, size_t element_size) FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+	assert(count <= 64);
+	uint8_t* dest = (uint8_t*)_dest;
+	const uint8_t* src = (const uint8_t*)_src;
+#ifdef FP_SIMD_X86
+	if(fp_simd_level() == FP_SIMD_AVX512) {
+		if(element_size == 4) return __fp_simd_compress32_avx512(dest, src, keep, count);
+		if(element_size == 8) return __fp_simd_compress64_avx512(dest, src, keep, count);
+	}
+#endif
+	// Copies runs of kept elements
+	size_t written = 0;
+	for(size_t i = 0; i < count; ) {
+		if(!((keep >> i) & 1)) {
+			++i;
+			continue;
+		}
+		size_t start = i;
+		while(i < count && ((keep >> i) & 1)) ++i;
+		memmove(dest + written * element_size, src + start * element_size, (i - start) * element_size);
+		written += i - start;
+	}
+	return written;
+}
+#else
+;
+#endif
+
+/**
+* @brief Combines two (non-overlapping or identical) regions of \p n bytes, storing dest op src into \p dest
+*/
+void fp_simd_bitwise(void* _dest, const void* _src, size_t n, enum fp_simd_bitwise_op op) FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+	uint8_t* dest = (uint8_t*)_dest;
+	const uint8_t* src = (const uint8_t*)_src;
+	size_t i = 0;
+#ifdef FP_SIMD_X86
+	if(n >= FP_SIMD_MIN_BYTES) switch(fp_simd_level()) {
+		case FP_SIMD_AVX512: i = __fp_simd_bitwise_avx512(dest, src, n, op); break;
+		case FP_SIMD_AVX2: i = __fp_simd_bitwise_avx2(dest, src, n, op); break;
+		case FP_SIMD_SSE2: i = __fp_simd_bitwise_sse2(dest, src, n, op); break;
+		default: break;
+	}
+#endif
+	for(; i + sizeof(uint64_t) <= n; i += sizeof(uint64_t)) {
+		uint64_t x, y;
+		memcpy(&x, dest + i, sizeof(x));
+		memcpy(&y, src + i, sizeof(y));
+		switch(op) {
+			case FP_SIMD_AND: x &= y; break;
+			case FP_SIMD_OR: x |= y; break;
+			case FP_SIMD_XOR: x ^= y; break;
+			case FP_SIMD_ANDNOT: x &= ~y; break;
+		}
+		memcpy(dest + i, &x, sizeof(x));
+	}
+	for(; i < n; ++i) switch(op) {
+		case FP_SIMD_AND: dest[i] &= src[i]; break;
+		case FP_SIMD_OR: dest[i] |= src[i]; break;
+		case FP_SIMD_XOR: dest[i] ^= src[i]; break;
+		case FP_SIMD_ANDNOT: dest[i] &= ~src[i]; break;
+	}
+}
+#else
+;
+#endif
+
+// Counts the set bits in a region of \p n bytes
+uint64_t fp_simd_popcount(const void* _data, size_t n) FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+	const uint8_t* data = (const uint8_t*)_data;
+	uint64_t count = 0;
+	size_t i = 0;
+#ifdef FP_SIMD_X86
+	if(n >= FP_SIMD_MIN_BYTES) switch(fp_simd_level()) {
+		case FP_SIMD_AVX512: i = __fp_simd_popcount_avx512(data, n, &count); break;
+		case FP_SIMD_AVX2: i = __fp_simd_popcount_avx2(data, n, &count); break;
+		default: break; // SSE2 lacks a byte shuffle, the scalar path is just as fast
+	}
+#endif
+	for(; i + sizeof(uint64_t) <= n; i += sizeof(uint64_t)) {
+		uint64_t x;
+		memcpy(&x, data + i, sizeof(x));
+		count += fp_popcount64(x);
+	}
+	for(; i < n; ++i)
+		count += fp_popcount64(data[i]);
+	return count;
+}
+#else
+;
+#endif
+
+/**
+* @brief Extracts \p count values, each \p width bits wide, which are packed back to back (least significant bits first)
+*	starting at value \p first of \p packed
+* @note Reads up to 8 bytes past the first byte of the last value, so packed regions should end with a word of padding
+*/
+void fp_simd_unpack_bits(const void* _packed, size_t first, size_t count, unsigned width, uint64_t* out) FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+	assert(width <= 64);
+	const uint8_t* packed = (const uint8_t*)_packed;
+	uint64_t start = (uint64_t)first * width;
+	size_t i = 0;
+	if(width == 0) {
+		memset(out, 0, count * sizeof(uint64_t));
+		return;
+	}
+	if(width > 57) { // Values can span 9 bytes, read the two words they overlap instead
+		const uint64_t mask = width == 64 ? ~(uint64_t)0 : (((uint64_t)1) << width) - 1;
+		for(; i < count; ++i, start += width) {
+			uint64_t low, high;
+			memcpy(&low, packed + (start >> 6) * 8, sizeof(low));
+			memcpy(&high, packed + (start >> 6) * 8 + 8, sizeof(high));
+			out[i] = ((low >> (start & 63)) | ((high << 1) << (63 - (start & 63)))) & mask;
+		}
+		return;
+	}
+#ifdef FP_SIMD_X86
+	if(count * sizeof(uint64_t) >= FP_SIMD_MIN_BYTES) switch(fp_simd_level()) {
+		case FP_SIMD_AVX512: i = __fp_simd_unpack_bits_avx512(packed, start, count, width, out); break;
+		case FP_SIMD_AVX2: i = __fp_simd_unpack_bits_avx2(packed, start, count, width, out); break;
+		default: break; // SSE2 has neither gathers nor per-lane shifts
+	}
+	start += (uint64_t)i * width;
+#endif
+	const uint64_t mask = (((uint64_t)1) << width) - 1;
+	for(; i < count; ++i, start += width) {
+		uint64_t x;
+		memcpy(&x, packed + (start >> 3), sizeof(x));
+		out[i] = (x >> (start & 7)) & mask;
+	}
+}
+#else
+;
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __LIB_FAT_POINTER_SIMD_H__
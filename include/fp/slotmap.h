@@ -0,0 +1,237 @@
+#ifndef __LIB_FAT_POINTER_SLOTMAP_H__
+#define __LIB_FAT_POINTER_SLOTMAP_H__
+
+// Containers which hand out stable identifiers to densely packed elements
+// A slot map stores its values in one contiguous dynarray (swap deleting on erase) and resolves generational handles through
+// an indirection table, so handles survive other elements being erased and go stale (instead of aliasing) once their own element is
+// A sparse set tracks which small integer IDs are present, with the members also packed contiguously for iteration
+
+#include "dynarray.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Low 32 bits are the slot, high 32 bits are its generation (occupied slots always have odd generations, so 0 is never a valid handle)
+typedef uint64_t fp_slotmap_handle;
+#define FP_SLOTMAP_NULL_HANDLE ((fp_slotmap_handle)0)
+#define __FP_SLOTMAP_NO_FREE_SLOT UINT32_MAX
+
+inline static uint32_t fp_slotmap_handle_slot(fp_slotmap_handle handle) FP_NOEXCEPT { return (uint32_t)handle; }
+inline static uint32_t fp_slotmap_handle_generation(fp_slotmap_handle handle) FP_NOEXCEPT { return (uint32_t)(handle >> 32); }
+inline static fp_slotmap_handle __fp_slotmap_make_handle(uint32_t slot, uint32_t generation) FP_NOEXCEPT { return (((uint64_t)generation) << 32) | slot; }
+
+struct __fp_slotmap_slot {
+	uint32_t index; // Position of the slot's value if it is occupied, otherwise the next free slot
+	uint32_t generation; // Incremented on every insert and erase
+};
+
+struct fp_slotmap {
+	fp_dynarray(uint8_t) values; // Packed elements, element_size bytes each
+	fp_dynarray(uint32_t) value_slots; // The slot pointing at each packed element (so erase can patch the element moved into the hole)
+	fp_dynarray(struct __fp_slotmap_slot) slots;
+	uint32_t free_head; // First slot of the free list
+	size_t element_size;
+};
+
+inline static void fp_slotmap_init(struct fp_slotmap* m, size_t element_size) FP_NOEXCEPT {
+	assert(element_size > 0);
+	m->values = NULL;
+	m->value_slots = NULL;
+	m->slots = NULL;
+	m->free_head = __FP_SLOTMAP_NO_FREE_SLOT;
+	m->element_size = element_size;
+}
+#define fp_slotmap_init_type(m, type) fp_slotmap_init((m), sizeof(type))
+
+inline static void fp_slotmap_free(struct fp_slotmap* m) FP_NOEXCEPT {
+	fpda_free_and_null(m->values);
+	fpda_free_and_null(m->value_slots);
+	fpda_free_and_null(m->slots);
+	m->free_head = __FP_SLOTMAP_NO_FREE_SLOT;
+}
+
+inline static size_t fp_slotmap_size(const struct fp_slotmap* m) FP_NOEXCEPT { return fpda_size(m->value_slots); }
+inline static bool fp_slotmap_empty(const struct fp_slotmap* m) FP_NOEXCEPT { return fp_slotmap_size(m) == 0; }
+
+// Grows the packed elements to hold \p count, the byte array is created aligned to the largest power of two dividing the element size
+inline static uint8_t* __fp_slotmap_grow_values(struct fp_slotmap* m, size_t count, bool update_utilized, bool exact_sizing) FP_NOEXCEPT {
+	size_t alignment = m->element_size & -m->element_size;
+	if(alignment > 16) alignment = 16;
+	return (uint8_t*)FP_PROFILE_SCOPE(void*, __fpda_maybe_grow_aligned_in((void**)&m->values, m->element_size, count, update_utilized, exact_sizing, FP_DEFAULT_ALLOCATOR, alignment));
+}
+
+// Makes room for \p count elements so inserting up to that many won't reallocate
+inline static void fp_slotmap_reserve(struct fp_slotmap* m, size_t count) FP_NOEXCEPT {
+	__fp_slotmap_grow_values(m, count, false, true);
+	fpda_reserve(m->value_slots, count);
+	fpda_reserve(m->slots, count);
+}
+
+// Packed elements (fp_slotmap_size of them) in no particular order, the pointer is invalidated by inserts and erases
+inline static void* fp_slotmap_values(struct fp_slotmap* m) FP_NOEXCEPT { return m->values; }
+#define fp_slotmap_values_typed(type, m) ((type*)fp_slotmap_values(m))
+
+// Handle of the element packed at \p index
+inline static fp_slotmap_handle fp_slotmap_handle_at(const struct fp_slotmap* m, size_t index) FP_NOEXCEPT {
+	assert(index < fp_slotmap_size(m));
+	uint32_t slot = m->value_slots[index];
+	return __fp_slotmap_make_handle(slot, m->slots[slot].generation);
+}
+
+inline static bool fp_slotmap_contains(const struct fp_slotmap* m, fp_slotmap_handle handle) FP_NOEXCEPT {
+	uint32_t slot = fp_slotmap_handle_slot(handle);
+	return slot < fpda_size(m->slots) && m->slots[slot].generation == fp_slotmap_handle_generation(handle) && (m->slots[slot].generation & 1);
+}
+
+// @return The element \p handle refers to, or NULL if it has been erased
+inline static void* fp_slotmap_get(struct fp_slotmap* m, fp_slotmap_handle handle) FP_NOEXCEPT {
+	if(!fp_slotmap_contains(m, handle)) return NULL;
+	return m->values + (size_t)m->slots[fp_slotmap_handle_slot(handle)].index * m->element_size;
+}
+#define fp_slotmap_get_typed(type, m, handle) ((type*)fp_slotmap_get((m), (handle)))
+
+/**
+* @brief Appends a copy of the element at \p value to the packed elements
+* @return A handle which stays valid until the element is erased
+*/
+inline static fp_slotmap_handle fp_slotmap_insert(struct fp_slotmap* m, const void* value) FP_NOEXCEPT {
+	size_t index = fp_slotmap_size(m);
+	assert(index < __FP_SLOTMAP_NO_FREE_SLOT);
+	uint32_t slot = m->free_head;
+	if(slot == __FP_SLOTMAP_NO_FREE_SLOT) {
+		slot = (uint32_t)fpda_size(m->slots);
+		*__fpda_maybe_grow_short(m->slots, slot + 1) = (struct __fp_slotmap_slot){0, 0};
+	} else m->free_head = m->slots[slot].index;
+
+	memcpy(__fp_slotmap_grow_values(m, index + 1, true, false), value, m->element_size);
+	*__fpda_maybe_grow_short(m->value_slots, index + 1) = slot;
+
+	struct __fp_slotmap_slot* s = m->slots + slot;
+	s->index = (uint32_t)index;
+	s->generation++;
+	return __fp_slotmap_make_handle(slot, s->generation);
+}
+
+/**
+* @brief Erases the element \p handle refers to, moving the last packed element into its place
+* @return false if the handle was stale
+*/
+inline static bool fp_slotmap_erase(struct fp_slotmap* m, fp_slotmap_handle handle) FP_NOEXCEPT {
+	if(!fp_slotmap_contains(m, handle)) return false;
+	uint32_t slot = fp_slotmap_handle_slot(handle);
+	struct __fp_slotmap_slot* s = m->slots + slot;
+	size_t index = s->index, last = fp_slotmap_size(m) - 1;
+	if(index != last) {
+		memcpy(m->values + index * m->element_size, m->values + last * m->element_size, m->element_size);
+		uint32_t moved = m->value_slots[index] = m->value_slots[last];
+		m->slots[moved].index = (uint32_t)index;
+	}
+	__fpda_header(m->values)->h.size--;
+	__fpda_header(m->value_slots)->h.size--;
+
+	s->generation++;
+	s->index = m->free_head;
+	m->free_head = slot;
+	return true;
+}
+
+// Erases every element, invalidating all outstanding handles (the storage is kept)
+inline static void fp_slotmap_clear(struct fp_slotmap* m) FP_NOEXCEPT {
+	for(size_t i = 0, size = fp_slotmap_size(m); i < size; ++i) {
+		uint32_t slot = m->value_slots[i];
+		m->slots[slot].generation++;
+		m->slots[slot].index = m->free_head;
+		m->free_head = slot;
+	}
+	if(m->values) __fpda_header(m->values)->h.size = 0;
+	if(m->value_slots) __fpda_header(m->value_slots)->h.size = 0;
+}
+
+inline static void fp_slotmap_clone_to(struct fp_slotmap* dest, const struct fp_slotmap* src) FP_NOEXCEPT {
+	fp_slotmap_free(dest);
+	dest->element_size = src->element_size;
+	dest->free_head = src->free_head;
+	if(src->values) dest->values = (uint8_t*)__fpda_clone(src->values, src->element_size);
+	if(src->value_slots) dest->value_slots = fpda_clone(src->value_slots);
+	if(src->slots) dest->slots = fpda_clone(src->slots);
+}
+
+
+
+// Set of integer IDs with O(1) insert, erase and membership tests
+// sparse maps each ID to its position in dense, an ID is a member if that position points back at it
+// NOTE: sparse grows to the largest ID ever inserted, so IDs should be small (like the slots of a slot map or entity indices)
+struct fp_sparse_set {
+	fp_dynarray(uint32_t) dense; // The members, packed in no particular order
+	fp_dynarray(uint32_t) sparse;
+};
+
+inline static void fp_sparse_set_init(struct fp_sparse_set* s) FP_NOEXCEPT {
+	s->dense = NULL;
+	s->sparse = NULL;
+}
+
+inline static void fp_sparse_set_free(struct fp_sparse_set* s) FP_NOEXCEPT {
+	fpda_free_and_null(s->dense);
+	fpda_free_and_null(s->sparse);
+}
+
+inline static size_t fp_sparse_set_size(const struct fp_sparse_set* s) FP_NOEXCEPT { return fpda_size(s->dense); }
+inline static bool fp_sparse_set_empty(const struct fp_sparse_set* s) FP_NOEXCEPT { return fp_sparse_set_size(s) == 0; }
+// Members (fp_sparse_set_size of them) in no particular order
+inline static uint32_t* fp_sparse_set_values(struct fp_sparse_set* s) FP_NOEXCEPT { return s->dense; }
+
+inline static bool fp_sparse_set_contains(const struct fp_sparse_set* s, uint32_t id) FP_NOEXCEPT {
+	if(id >= fpda_size(s->sparse)) return false;
+	uint32_t index = s->sparse[id];
+	return index < fpda_size(s->dense) && s->dense[index] == id;
+}
+
+// Position of \p id among the packed members, or fp_sparse_set_size if it isn't a member
+inline static size_t fp_sparse_set_index_of(const struct fp_sparse_set* s, uint32_t id) FP_NOEXCEPT {
+	return fp_sparse_set_contains(s, id) ? s->sparse[id] : fp_sparse_set_size(s);
+}
+
+// @return false if \p id was already a member
+inline static bool fp_sparse_set_insert(struct fp_sparse_set* s, uint32_t id) FP_NOEXCEPT {
+	if(fp_sparse_set_contains(s, id)) return false;
+	size_t old = fpda_size(s->sparse);
+	if(id >= old) {
+		// Zeroed so every lookup reads initialized memory (stale entries are still filtered out by the check against dense)
+		size_t size = FP_MAX((size_t)id + 1, old * 2);
+		fpda_grow_to_size(s->sparse, size);
+		memset(s->sparse + old, 0, (size - old) * sizeof(uint32_t));
+	}
+	size_t index = fpda_size(s->dense);
+	s->sparse[id] = (uint32_t)index;
+	*__fpda_maybe_grow_short(s->dense, index + 1) = id;
+	return true;
+}
+
+// Removes \p id by moving the last member into its place, @return false if it wasn't a member
+inline static bool fp_sparse_set_erase(struct fp_sparse_set* s, uint32_t id) FP_NOEXCEPT {
+	if(!fp_sparse_set_contains(s, id)) return false;
+	uint32_t index = s->sparse[id], last = *fpda_back(s->dense);
+	s->dense[index] = last;
+	s->sparse[last] = index;
+	__fpda_header(s->dense)->h.size--;
+	return true;
+}
+
+// O(1), the sparse array is left as is since its entries no longer point at members
+inline static void fp_sparse_set_clear(struct fp_sparse_set* s) FP_NOEXCEPT {
+	if(s->dense) __fpda_header(s->dense)->h.size = 0;
+}
+
+inline static void fp_sparse_set_clone_to(struct fp_sparse_set* dest, const struct fp_sparse_set* src) FP_NOEXCEPT {
+	fp_sparse_set_free(dest);
+	if(src->dense) dest->dense = fpda_clone(src->dense);
+	if(src->sparse) dest->sparse = fpda_clone(src->sparse);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __LIB_FAT_POINTER_SLOTMAP_H__
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <type_traits>
+#include <utility>
+
+#include "pointer.hpp"
+#include "slotmap.h"
+
+namespace fp {
+
+	// Densely packed elements addressed through generational handles, handles stay valid while other elements are erased and
+	// lookups through an erased element's handle fail instead of finding whatever reused its slot
+	// NOTE: Elements are copied bytewise (and moved around on erase), so they must be trivially copyable
+	template<typename T>
+	struct slotmap {
+		static_assert(std::is_trivially_copyable_v<T>, "Slot map elements are copied bytewise");
+		using handle = fp_slotmap_handle;
+
+		slotmap() { fp_slotmap_init_type(&m, T); }
+		slotmap(const slotmap& o) : slotmap() { fp_slotmap_clone_to(&m, &o.m); }
+		slotmap(slotmap&& o) : slotmap() { std::swap(m, o.m); }
+		slotmap& operator=(const slotmap& o) { if(this != &o) fp_slotmap_clone_to(&m, &o.m); return *this; }
+		slotmap& operator=(slotmap&& o) { if(this != &o) std::swap(m, o.m); return *this; }
+		~slotmap() { fp_slotmap_free(&m); }
+
+		inline size_t size() const { return fp_slotmap_size(&m); }
+		inline bool empty() const { return fp_slotmap_empty(&m); }
+		inline slotmap& reserve(size_t count) { fp_slotmap_reserve(&m, count); return *this; }
+		inline slotmap& clear() { fp_slotmap_clear(&m); return *this; }
+
+		inline handle insert(const T& value) { return fp_slotmap_insert(&m, &value); }
+		// @return false if the handle was stale
+		inline bool erase(handle h) { return fp_slotmap_erase(&m, h); }
+		inline bool contains(handle h) const { return fp_slotmap_contains(&m, h); }
+
+		// @return nullptr if the handle was stale, the pointer is invalidated by inserts and erases
+		inline T* get(handle h) { return fp_slotmap_get_typed(T, &m, h); }
+		inline const T* get(handle h) const { return fp_slotmap_get_typed(const T, const_cast<fp_slotmap*>(&m), h); }
+		inline T& operator[](handle h) { auto out = get(h); assert(out); return *out; }
+		inline const T& operator[](handle h) const { auto out = get(h); assert(out); return *out; }
+
+		// Every element packed contiguously (in no particular order), handle_at finds the handle of one of them
+		inline view<T> values() { return {fp_slotmap_values_typed(T, &m), size()}; }
+		inline view<const T> values() const { return {(const T*)m.values, size()}; }
+		inline handle handle_at(size_t index) const { return fp_slotmap_handle_at(&m, index); }
+
+		inline T* begin() { return values().begin(); }
+		inline T* end() { return values().end(); }
+		inline const T* begin() const { return values().begin(); }
+		inline const T* end() const { return values().end(); }
+
+	protected:
+		fp_slotmap m;
+	};
+
+	// Set of small integer IDs with O(1) insert, erase and membership tests, members are packed contiguously for iteration
+	struct sparse_set {
+		sparse_set() { fp_sparse_set_init(&s); }
+		sparse_set(const sparse_set& o) : sparse_set() { fp_sparse_set_clone_to(&s, &o.s); }
+		sparse_set(sparse_set&& o) : sparse_set() { std::swap(s, o.s); }
+		sparse_set& operator=(const sparse_set& o) { if(this != &o) fp_sparse_set_clone_to(&s, &o.s); return *this; }
+		sparse_set& operator=(sparse_set&& o) { if(this != &o) std::swap(s, o.s); return *this; }
+		~sparse_set() { fp_sparse_set_free(&s); }
+
+		inline size_t size() const { return fp_sparse_set_size(&s); }
+		inline bool empty() const { return fp_sparse_set_empty(&s); }
+		inline sparse_set& clear() { fp_sparse_set_clear(&s); return *this; }
+
+		// Both return false if nothing changed
+		inline bool insert(uint32_t id) { return fp_sparse_set_insert(&s, id); }
+		inline bool erase(uint32_t id) { return fp_sparse_set_erase(&s, id); }
+		inline bool contains(uint32_t id) const { return fp_sparse_set_contains(&s, id); }
+		// Position of id in values(), or size() if it isn't a member
+		inline size_t index_of(uint32_t id) const { return fp_sparse_set_index_of(&s, id); }
+
+		inline view<const uint32_t> values() const { return {s.dense, size()}; }
+		inline const uint32_t* begin() const { return values().begin(); }
+		inline const uint32_t* end() const { return values().end(); }
+
+	protected:
+		fp_sparse_set s;
+	};
+}
@@ -0,0 +1,229 @@
+#ifndef __LIB_FAT_POINTER_SOA_DYNARRAY_H__
+#define __LIB_FAT_POINTER_SOA_DYNARRAY_H__
+
+#include "dynarray.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// A struct-of-arrays dynarray stores each field of its rows in a separate column, all the columns share one allocation
+// (and one size/capacity) so passes which only touch a couple of fields only pull those fields through the cache
+// The pointer points to the start of the first column, the layout of the columns is described by an array of their element
+// sizes (which every function takes), each column starts FP_SOA_DYNARRAY_COLUMN_ALIGNMENT aligned
+// NOTE: Rows are copied bytewise when the array grows or rows are inserted/deleted (like a dynarray's elements)
+#define fp_soa_dynarray(name) void*
+
+#ifndef FP_SOA_DYNARRAY_COLUMN_ALIGNMENT
+#define FP_SOA_DYNARRAY_COLUMN_ALIGNMENT 64 // A cache line (and the widest SIMD register)
+#endif
+
+struct __FatSoADynarrayHeader {
+	fp_header_size_t capacity; // NOTE: Must directly precede the fat pointer header (like a dynarray's) so that is_fp works
+	struct __FatPointerHeader h; // h.size is the number of rows
+};
+#ifndef __cplusplus
+	#define FP_SOA_DYNARRAY_HEADER_SIZE sizeof(struct __FatSoADynarrayHeader)
+#else
+	static constexpr size_t FP_SOA_DYNARRAY_HEADER_SIZE = sizeof(__FatSoADynarrayHeader) - detail::completed_sizeof_v<decltype(__FatPointerHeader{}.data)>;
+#endif
+
+inline static struct __FatSoADynarrayHeader* __fp_soa_dynarray_header(const void* a) FP_NOEXCEPT {
+	assert(a);
+	return (struct __FatSoADynarrayHeader*)(((uint8_t*)a) - FP_SOA_DYNARRAY_HEADER_SIZE);
+}
+
+inline static bool is_fp_soa_dynarray(const void* a) FP_NOEXCEPT { return fp_magic_number(a) == FP_SOA_DYNARRAY_MAGIC_NUMBER; }
+
+#define fp_soa_dynarray_size fp_size
+#define fp_soa_dynarray_length fp_length
+#define fp_soa_dynarray_empty fp_empty
+inline static size_t fp_soa_dynarray_capacity(const void* a) FP_NOEXCEPT { return a ? __fp_soa_dynarray_header(a)->capacity : 0; }
+
+// Offset (from the start of the first column) of the \p column th column of an array which can hold \p capacity rows
+inline static size_t __fp_soa_dynarray_column_offset(size_t capacity, const size_t* column_sizes, size_t column) FP_NOEXCEPT {
+	size_t offset = 0;
+	for(size_t i = 0; i < column; ++i)
+		offset = (offset + column_sizes[i] * capacity + FP_SOA_DYNARRAY_COLUMN_ALIGNMENT - 1) & ~(size_t)(FP_SOA_DYNARRAY_COLUMN_ALIGNMENT - 1);
+	return offset;
+}
+#define __fp_soa_dynarray_bytes(capacity, column_sizes, column_count) (__fp_soa_dynarray_column_offset((capacity), (column_sizes), (column_count) - 1) + (column_sizes)[(column_count) - 1] * (capacity))
+
+// Pointer to the first element of the \p column th column (NULL if the array hasn't been allocated)
+inline static void* fp_soa_dynarray_column(const void* a, const size_t* column_sizes, size_t column) FP_NOEXCEPT {
+	if(!a) return NULL;
+	return ((uint8_t*)a) + __fp_soa_dynarray_column_offset(__fp_soa_dynarray_header(a)->capacity, column_sizes, column);
+}
+#define fp_soa_dynarray_column_typed(type, a, column_sizes, column) ((type*)fp_soa_dynarray_column((a), (column_sizes), (column)))
+
+/**
+* @brief Makes sure the array can hold at least \p required rows, creating it in \p allocator if it doesn't exist yet
+* @param exact_sizing when false the capacity is rounded up to a power of two (so repeated pushes are amortized O(1))
+* @note The allocation is resized (giving the allocator a chance to do so in place) and then the columns are moved, last
+*	first, to where the new capacity places them
+*/
+inline static struct __FatSoADynarrayHeader* __fp_soa_dynarray_reserve_in(void** a, const size_t* column_sizes, size_t column_count, size_t required, bool exact_sizing, fp_allocator_id allocator) FP_NOEXCEPT {
+	assert(column_count > 0);
+	if(*a && required <= __fp_soa_dynarray_header(*a)->capacity) return __fp_soa_dynarray_header(*a);
+
+	size_t capacity = required;
+	if(!exact_sizing) {
+		size_t row_size = 0;
+		for(size_t i = 0; i < column_count; ++i)
+			row_size += column_sizes[i];
+		size_t minimum = FPDA_DEFAULT_SIZE_BYTES / row_size;
+		capacity = fp_upper_power_of_two(required > minimum ? required : minimum);
+	}
+	size_t bytes = FP_SOA_DYNARRAY_HEADER_SIZE + __fp_soa_dynarray_bytes(capacity, column_sizes, column_count);
+	struct __FatSoADynarrayHeader* h;
+	if(*a == NULL) {
+		h = (struct __FatSoADynarrayHeader*)__fp_alloc_aligned_in(NULL, bytes, allocator, FP_SOA_DYNARRAY_COLUMN_ALIGNMENT, FP_SOA_DYNARRAY_HEADER_SIZE);
+		h->h.magic = FP_SOA_DYNARRAY_MAGIC_NUMBER;
+		h->h.allocator = allocator;
+		__fp_header_set_alignment(&h->h, 0, 0);
+		h->h.size = 0;
+	} else {
+		h = __fp_soa_dynarray_header(*a);
+		size_t old_capacity = h->capacity;
+		h = (struct __FatSoADynarrayHeader*)__fp_alloc_aligned_in(h, bytes, FP_DEFAULT_ALLOCATOR, 0, FP_SOA_DYNARRAY_HEADER_SIZE);
+		FP_PROFILE_REALLOCATED_EVENT(FP_PROFILE_GROW, h->h.data, bytes - FP_SOA_DYNARRAY_HEADER_SIZE, __fp_soa_dynarray_bytes(old_capacity, column_sizes, column_count));
+
+		// Every column moves towards the end, so moving the last one first never overwrites a column which hasn't moved yet
+		for(size_t i = column_count; i-- > 1; )
+			memmove(h->h.data + __fp_soa_dynarray_column_offset(capacity, column_sizes, i), h->h.data + __fp_soa_dynarray_column_offset(old_capacity, column_sizes, i), column_sizes[i] * h->h.size);
+	}
+	h->capacity = capacity;
+	*a = h->h.data;
+	return h;
+}
+#define fp_soa_dynarray_reserve(a, column_sizes, column_count, _size) ((void)FP_PROFILE_SCOPE(void*, __fp_soa_dynarray_reserve_in((void**)&a, (column_sizes), (column_count), (_size), true, FP_DEFAULT_ALLOCATOR)))
+#define fp_soa_dynarray_reserve_in(a, column_sizes, column_count, _size, allocator) ((void)FP_PROFILE_SCOPE(void*, __fp_soa_dynarray_reserve_in((void**)&a, (column_sizes), (column_count), (_size), true, (allocator))))
+
+inline static void fp_soa_dynarray_free(void* a) FP_NOEXCEPT {
+	if(a) __fp_alloc(__fp_soa_dynarray_header(a), 0);
+}
+#define fp_soa_dynarray_free_and_null(a) (FP_PROFILE_SCOPE_VOID(fp_soa_dynarray_free(a)), a = NULL)
+
+inline static void fp_soa_dynarray_clear(void* a) FP_NOEXCEPT {
+	if(a) __fp_soa_dynarray_header(a)->h.size = 0;
+}
+
+// Sets the number of rows, NOTE: Added rows are left uninitialized
+inline static void __fp_soa_dynarray_resize(void** a, const size_t* column_sizes, size_t column_count, size_t size) FP_NOEXCEPT {
+	if(size == 0 && *a == NULL) return;
+	__fp_soa_dynarray_reserve_in(a, column_sizes, column_count, size, false, FP_DEFAULT_ALLOCATOR)->h.size = size;
+}
+#define fp_soa_dynarray_resize(a, column_sizes, column_count, _size) FP_PROFILE_SCOPE_VOID(__fp_soa_dynarray_resize((void**)&a, (column_sizes), (column_count), (_size)))
+
+/**
+* @brief Opens a gap of \p count (uninitialized) rows before the \p pos th row, shifting the rows after it back in every column
+* @return \p pos, the index of the first new row
+*/
+inline static size_t __fp_soa_dynarray_insert_uninitialized(void** a, const size_t* column_sizes, size_t column_count, size_t pos, size_t count) FP_NOEXCEPT {
+	size_t size = fp_size(*a);
+	assert(pos <= size);
+	auto h = __fp_soa_dynarray_reserve_in(a, column_sizes, column_count, size + count, false, FP_DEFAULT_ALLOCATOR);
+	if(count && pos < size)
+		for(size_t i = 0; i < column_count; ++i) {
+			uint8_t* column = h->h.data + __fp_soa_dynarray_column_offset(h->capacity, column_sizes, i);
+			memmove(column + column_sizes[i] * (pos + count), column + column_sizes[i] * pos, column_sizes[i] * (size - pos));
+		}
+	h->h.size = size + count;
+	return pos;
+}
+#define fp_soa_dynarray_insert_uninitialized(a, column_sizes, column_count, pos, count) __fp_soa_dynarray_insert_uninitialized((void**)&a, (column_sizes), (column_count), (pos), (count))
+// Returns the index of the new (uninitialized) row
+#define fp_soa_dynarray_push_back(a, column_sizes, column_count) fp_soa_dynarray_insert_uninitialized(a, (column_sizes), (column_count), fp_size(a), 1)
+
+// Removes \p count rows starting with the \p pos th, shifting the rows after them forward in every column
+inline static void fp_soa_dynarray_delete_range(void* a, const size_t* column_sizes, size_t column_count, size_t pos, size_t count) FP_NOEXCEPT {
+	if(count == 0) return;
+	size_t size = fp_size(a);
+	assert(pos + count <= size);
+	auto h = __fp_soa_dynarray_header(a);
+	for(size_t i = 0; i < column_count; ++i) {
+		uint8_t* column = h->h.data + __fp_soa_dynarray_column_offset(h->capacity, column_sizes, i);
+		memmove(column + column_sizes[i] * pos, column + column_sizes[i] * (pos + count), column_sizes[i] * (size - pos - count));
+	}
+	h->h.size -= count;
+}
+#define fp_soa_dynarray_delete(a, column_sizes, column_count, pos) fp_soa_dynarray_delete_range((a), (column_sizes), (column_count), (pos), 1)
+
+// Removes \p count rows starting with the \p pos th by moving the last rows into their place (doesn't preserve order, but only moves count rows)
+inline static void fp_soa_dynarray_swap_delete_range(void* a, const size_t* column_sizes, size_t column_count, size_t pos, size_t count) FP_NOEXCEPT {
+	if(count == 0) return;
+	size_t size = fp_size(a);
+	assert(pos + count <= size);
+	size_t after = size - pos - count, moved = after < count ? after : count;
+	auto h = __fp_soa_dynarray_header(a);
+	for(size_t i = 0; i < column_count; ++i) {
+		uint8_t* column = h->h.data + __fp_soa_dynarray_column_offset(h->capacity, column_sizes, i);
+		memcpy(column + column_sizes[i] * pos, column + column_sizes[i] * (size - moved), column_sizes[i] * moved);
+	}
+	h->h.size -= count;
+}
+#define fp_soa_dynarray_swap_delete(a, column_sizes, column_count, pos) fp_soa_dynarray_swap_delete_range((a), (column_sizes), (column_count), (pos), 1)
+
+// Copies the array into a new allocation (in the same allocator) just large enough to hold its rows
+inline static void* __fp_soa_dynarray_clone(const void* a, const size_t* column_sizes, size_t column_count) FP_NOEXCEPT {
+	size_t size = fp_size(a);
+	if(size == 0) return NULL;
+	void* out = NULL;
+	auto h = __fp_soa_dynarray_reserve_in(&out, column_sizes, column_count, size, true, fp_allocator_of(a));
+	for(size_t i = 0; i < column_count; ++i)
+		memcpy(fp_soa_dynarray_column(out, column_sizes, i), fp_soa_dynarray_column(a, column_sizes, i), column_sizes[i] * size);
+	h->h.size = size;
+	return out;
+}
+#define fp_soa_dynarray_clone(a, column_sizes, column_count) FP_PROFILE_SCOPE(void*, __fp_soa_dynarray_clone((a), (column_sizes), (column_count)))
+
+
+
+// Generates a typed struct-of-arrays interface, FIELDS is an X macro which lists the fields as X(context, type, name):
+//	#define PARTICLE_FIELDS(X, context) X(context, float, x) X(context, float, y) X(context, uint32_t, id)
+//	FP_SOA_DYNARRAY_DEFINE(particles, PARTICLE_FIELDS)
+// which defines struct particles_row (with one member per field), particles_column_sizes, the column accessors
+// particles_x(a) (etc), and particles_push_back/get/set/insert/delete/swap_delete/reserve/resize/clone/free
+#define __FP_SOA_ROW_MEMBER(name, type, field) type field;
+#define __FP_SOA_COLUMN_INDEX(name, type, field) name##_column_##field,
+#define __FP_SOA_COLUMN_SIZE(name, type, field) sizeof(type),
+#define __FP_SOA_COLUMN_ACCESSOR(name, type, field)\
+	inline static type* name##_##field(void* a) FP_NOEXCEPT { return (type*)fp_soa_dynarray_column(a, name##_column_sizes, name##_column_##field); }
+#define __FP_SOA_ROW_STORE(name, type, field) name##_##field(a)[index] = row->field;
+#define __FP_SOA_ROW_LOAD(name, type, field) out.field = name##_##field(a)[index];
+
+#define FP_SOA_DYNARRAY_DEFINE(name, FIELDS)\
+	struct name##_row { FIELDS(__FP_SOA_ROW_MEMBER, name) };\
+	enum name##_columns { FIELDS(__FP_SOA_COLUMN_INDEX, name) name##_column_count };\
+	static const size_t name##_column_sizes[] = { FIELDS(__FP_SOA_COLUMN_SIZE, name) };\
+	FIELDS(__FP_SOA_COLUMN_ACCESSOR, name)\
+	inline static void name##_set(void* a, size_t index, const struct name##_row* row) FP_NOEXCEPT {\
+		assert(index < fp_size(a));\
+		FIELDS(__FP_SOA_ROW_STORE, name)\
+	}\
+	inline static struct name##_row name##_get(void* a, size_t index) FP_NOEXCEPT {\
+		assert(index < fp_size(a));\
+		struct name##_row out;\
+		FIELDS(__FP_SOA_ROW_LOAD, name)\
+		return out;\
+	}\
+	inline static size_t name##_insert(void** a, size_t pos, const struct name##_row* row) FP_NOEXCEPT {\
+		__fp_soa_dynarray_insert_uninitialized(a, name##_column_sizes, name##_column_count, pos, 1);\
+		name##_set(*a, pos, row);\
+		return pos;\
+	}\
+	inline static size_t name##_push_back(void** a, const struct name##_row* row) FP_NOEXCEPT { return name##_insert(a, fp_size(*a), row); }\
+	inline static void name##_delete_range(void* a, size_t pos, size_t count) FP_NOEXCEPT { fp_soa_dynarray_delete_range(a, name##_column_sizes, name##_column_count, pos, count); }\
+	inline static void name##_delete(void* a, size_t pos) FP_NOEXCEPT { name##_delete_range(a, pos, 1); }\
+	inline static void name##_swap_delete_range(void* a, size_t pos, size_t count) FP_NOEXCEPT { fp_soa_dynarray_swap_delete_range(a, name##_column_sizes, name##_column_count, pos, count); }\
+	inline static void name##_swap_delete(void* a, size_t pos) FP_NOEXCEPT { name##_swap_delete_range(a, pos, 1); }\
+	inline static void name##_reserve(void** a, size_t size) FP_NOEXCEPT { __fp_soa_dynarray_reserve_in(a, name##_column_sizes, name##_column_count, size, true, FP_DEFAULT_ALLOCATOR); }\
+	inline static void name##_resize(void** a, size_t size) FP_NOEXCEPT { __fp_soa_dynarray_resize(a, name##_column_sizes, name##_column_count, size); }\
+	inline static void* name##_clone(const void* a) FP_NOEXCEPT { return __fp_soa_dynarray_clone(a, name##_column_sizes, name##_column_count); }\
+	inline static void name##_free(void* a) FP_NOEXCEPT { fp_soa_dynarray_free(a); }
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // __LIB_FAT_POINTER_SOA_DYNARRAY_H__
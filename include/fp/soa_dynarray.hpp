@@ -0,0 +1,132 @@
+#pragma once
+
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "pointer.hpp"
+#include "soa_dynarray.h"
+
+namespace fp {
+
+	// NOTE: Fields are copied bytewise when the array grows (like dynarray elements), so they must be trivially copyable
+	template<typename Derived, typename... Fields>
+	struct soa_dynarray_crtp {
+		static_assert(sizeof...(Fields) > 0, "A struct-of-arrays needs at least one field");
+		static_assert((std::is_trivially_copyable_v<Fields> && ...), "Struct-of-arrays fields are copied bytewise");
+		static_assert(((alignof(Fields) <= FP_SOA_DYNARRAY_COLUMN_ALIGNMENT) && ...), "Columns are only FP_SOA_DYNARRAY_COLUMN_ALIGNMENT aligned");
+
+		static constexpr size_t column_count = sizeof...(Fields);
+		static constexpr size_t column_sizes[] = {sizeof(Fields)...};
+		template<size_t Column>
+		using field_t = std::tuple_element_t<Column, std::tuple<Fields...>>;
+
+		inline bool is_soa_dynarray() const { return is_fp_soa_dynarray(ptr()); }
+		inline size_t size() const { return fp_soa_dynarray_size(ptr()); }
+		inline size_t length() const { return fp_soa_dynarray_length(ptr()); }
+		inline bool empty() const { return fp_soa_dynarray_empty(ptr()); }
+		inline size_t capacity() const { return fp_soa_dynarray_capacity(ptr()); }
+		inline operator bool() const { return ptr() != nullptr; }
+
+		inline void free() { fp_soa_dynarray_free(ptr()); }
+		inline void free_and_null() { fp_soa_dynarray_free_and_null(ptr()); }
+
+		// NOTE: The allocator is only used if the array hasn't been allocated yet
+		inline Derived& reserve(size_t size, fp_allocator_id allocator = FP_DEFAULT_ALLOCATOR) {
+			fp_soa_dynarray_reserve_in(ptr(), column_sizes, column_count, size, allocator);
+			return *derived();
+		}
+		// Added rows are value initialized
+		inline Derived& resize(size_t size) {
+			size_t old = this->size();
+			fp_soa_dynarray_resize(ptr(), column_sizes, column_count, size);
+			if(size > old) fill_rows(old, size - old, std::index_sequence_for<Fields...>{}, Fields{}...);
+			return *derived();
+		}
+		inline Derived& clear() {
+			fp_soa_dynarray_clear(ptr());
+			return *derived();
+		}
+
+		// Both return the index of the new row
+		inline size_t push_back(const Fields&... values) { return insert(size(), values...); }
+		inline size_t insert(size_t pos, const Fields&... values) {
+			fp_soa_dynarray_insert_uninitialized(ptr(), column_sizes, column_count, pos, 1);
+			fill_rows(pos, 1, std::index_sequence_for<Fields...>{}, values...);
+			return pos;
+		}
+		inline Derived& pop_back() { return delete_(size() - 1); }
+
+		inline Derived& delete_range(size_t pos, size_t count) {
+			fp_soa_dynarray_delete_range(ptr(), column_sizes, column_count, pos, count);
+			return *derived();
+		}
+		inline Derived& delete_(size_t pos) { return delete_range(pos, 1); }
+		inline Derived& remove(size_t pos) { return delete_(pos); }
+		inline Derived& swap_delete_range(size_t pos, size_t count) {
+			fp_soa_dynarray_swap_delete_range(ptr(), column_sizes, column_count, pos, count);
+			return *derived();
+		}
+		inline Derived& swap_delete(size_t pos) { return swap_delete_range(pos, 1); }
+
+		// Every element of one field, contiguous (and FP_SOA_DYNARRAY_COLUMN_ALIGNMENT aligned) so it can be handed to SIMD or parallel loops
+		template<size_t Column>
+		inline view<field_t<Column>> column() { return {fp_soa_dynarray_column_typed(field_t<Column>, ptr(), column_sizes, Column), size()}; }
+		template<size_t Column>
+		inline view<const field_t<Column>> column() const { return {fp_soa_dynarray_column_typed(const field_t<Column>, ptr(), column_sizes, Column), size()}; }
+
+		template<size_t Column>
+		inline field_t<Column>& get(size_t row) { assert(row < size()); return column<Column>()[row]; }
+		template<size_t Column>
+		inline const field_t<Column>& get(size_t row) const { assert(row < size()); return column<Column>()[row]; }
+		// References to every field of a row
+		inline std::tuple<Fields&...> operator[](size_t row) { return row_references(row, std::index_sequence_for<Fields...>{}); }
+
+		inline Derived clone() const { return (Derived)fp_soa_dynarray_clone(ptr(), column_sizes, column_count); }
+
+	protected:
+		template<size_t... Columns>
+		inline void fill_rows(size_t pos, size_t count, std::index_sequence<Columns...>, const Fields&... values) {
+			([&] {
+				auto data = column<Columns>().data() + pos;
+				for(size_t i = 0; i < count; ++i)
+					data[i] = values;
+			}(), ...);
+		}
+		template<size_t... Columns>
+		inline std::tuple<Fields&...> row_references(size_t row, std::index_sequence<Columns...>) { return {get<Columns>(row)...}; }
+
+		inline Derived* derived() { return (Derived*)this; }
+		inline const Derived* derived() const { return (Derived*)this; }
+		inline void*& ptr() { return derived()->raw; }
+		inline void* const & ptr() const { return derived()->raw; }
+	};
+
+	// Struct-of-arrays dynarray, each field lives in its own column: fp::soa_dynarray<float, float, uint32_t> particles
+	template<typename... Fields>
+	struct soa_dynarray: public soa_dynarray_crtp<soa_dynarray<Fields...>, Fields...> {
+		void* raw;
+
+		soa_dynarray(): raw(nullptr) {}
+		soa_dynarray(std::nullptr_t): raw(nullptr) {}
+		soa_dynarray(void* ptr): raw(ptr) { assert(ptr == nullptr || is_fp_soa_dynarray(ptr)); }
+	};
+
+	namespace raii {
+		template<typename... Fields>
+		struct soa_dynarray: public fp::soa_dynarray<Fields...> {
+			using super = fp::soa_dynarray<Fields...>;
+			using super::raw;
+
+			soa_dynarray(): super(nullptr) {}
+			soa_dynarray(void* ptr): super(ptr) {}
+			soa_dynarray(const fp::soa_dynarray<Fields...>& o): super(o.clone().raw) {}
+			soa_dynarray(fp::soa_dynarray<Fields...>&& o): super(std::exchange(o.raw, nullptr)) {}
+			soa_dynarray(const soa_dynarray& o): super(o.clone().raw) {}
+			soa_dynarray(soa_dynarray&& o): super(std::exchange(o.raw, nullptr)) {}
+			soa_dynarray& operator=(const soa_dynarray& o) { if(this != &o) { super::free(); raw = o.clone().raw; } return *this; }
+			soa_dynarray& operator=(soa_dynarray&& o) { if(this != &o) { super::free(); raw = std::exchange(o.raw, nullptr); } return *this; }
+			~soa_dynarray() { super::free_and_null(); }
+		};
+	}
+}
@@ -0,0 +1,342 @@
+#ifndef __LIB_FAT_POINTER_SORT_H__
+#define __LIB_FAT_POINTER_SORT_H__
+
+#include "dynarray.h"
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Orders two elements, follows the same semantics as memcmp
+typedef int(*fp_compare_t)(void* userdata, const void* a, const void* b) FP_NOEXCEPT;
+
+// Ranges smaller than this are insertion sorted
+#ifndef FP_SORT_INSERTION_THRESHOLD
+#define FP_SORT_INSERTION_THRESHOLD 24
+#endif
+#define __FP_SORT_NINTHER_THRESHOLD 128 // Ranges larger than this pick their pivot from nine elements instead of three
+#define __FP_SORT_PARTIAL_INSERTION_LIMIT 8 // How many elements a partial insertion sort may move before giving up
+
+
+// Comparison sort (pattern defeating quicksort)
+
+struct __fp_sort_context {
+	size_t size;
+	fp_compare_t compare;
+	void* userdata;
+};
+
+inline static bool __fp_sort_less(const struct __fp_sort_context* ctx, const uint8_t* a, const uint8_t* b) FP_NOEXCEPT {
+	return ctx->compare(ctx->userdata, a, b) < 0;
+}
+
+inline static void __fp_sort_swap(const struct __fp_sort_context* ctx, uint8_t* a, uint8_t* b) FP_NOEXCEPT {
+	switch(ctx->size) {
+	case 4: {
+		uint32_t x, y;
+		memcpy(&x, a, 4); memcpy(&y, b, 4);
+		memcpy(a, &y, 4); memcpy(b, &x, 4);
+		break;
+	}
+	case 8: {
+		uint64_t x, y;
+		memcpy(&x, a, 8); memcpy(&y, b, 8);
+		memcpy(a, &y, 8); memcpy(b, &x, 8);
+		break;
+	}
+	default: fp_simd_swap(a, b, ctx->size);
+	}
+}
+
+inline static void __fp_sort3(const struct __fp_sort_context* ctx, uint8_t* a, uint8_t* b, uint8_t* c) FP_NOEXCEPT {
+	if(__fp_sort_less(ctx, b, a)) __fp_sort_swap(ctx, a, b);
+	if(__fp_sort_less(ctx, c, b)) __fp_sort_swap(ctx, b, c);
+	if(__fp_sort_less(ctx, b, a)) __fp_sort_swap(ctx, a, b);
+}
+
+inline static void __fp_insertion_sort(const struct __fp_sort_context* ctx, uint8_t* begin, uint8_t* end) FP_NOEXCEPT {
+	size_t size = ctx->size;
+	for(uint8_t* i = begin + size; i < end; i += size)
+		for(uint8_t* j = i; j > begin && __fp_sort_less(ctx, j, j - size); j -= size)
+			__fp_sort_swap(ctx, j, j - size);
+}
+
+// Insertion sorts the range unless that would take more than a few moves, returns true if the range was sorted
+inline static bool __fp_partial_insertion_sort(const struct __fp_sort_context* ctx, uint8_t* begin, uint8_t* end) FP_NOEXCEPT {
+	size_t size = ctx->size, moves = 0;
+	for(uint8_t* i = begin + size; i < end; i += size)
+		for(uint8_t* j = i; j > begin && __fp_sort_less(ctx, j, j - size); j -= size) {
+			__fp_sort_swap(ctx, j, j - size);
+			if(++moves > __FP_SORT_PARTIAL_INSERTION_LIMIT) return false;
+		}
+	return true;
+}
+
+inline static void __fp_heap_sift_down(const struct __fp_sort_context* ctx, uint8_t* begin, size_t root, size_t count) FP_NOEXCEPT {
+	size_t size = ctx->size;
+	for(size_t child; (child = 2 * root + 1) < count; root = child) {
+		if(child + 1 < count && __fp_sort_less(ctx, begin + child * size, begin + (child + 1) * size)) ++child;
+		if(!__fp_sort_less(ctx, begin + root * size, begin + child * size)) return;
+		__fp_sort_swap(ctx, begin + root * size, begin + child * size);
+	}
+}
+
+inline static void __fp_heap_sort(const struct __fp_sort_context* ctx, uint8_t* begin, uint8_t* end) FP_NOEXCEPT {
+	size_t size = ctx->size, count = (end - begin) / size;
+	for(size_t i = count / 2; i--; )
+		__fp_heap_sift_down(ctx, begin, i, count);
+	for(size_t i = count; i-- > 1; ) {
+		__fp_sort_swap(ctx, begin, begin + i * size);
+		__fp_heap_sift_down(ctx, begin, 0, i);
+	}
+}
+
+// Partitions around the pivot at begin, elements equal to it go to the right; sets already_partitioned if no elements had to be swapped
+inline static uint8_t* __fp_partition_right(const struct __fp_sort_context* ctx, uint8_t* begin, uint8_t* end, bool* already_partitioned) FP_NOEXCEPT {
+	size_t size = ctx->size;
+	uint8_t* first = begin + size, *last = end - size;
+	while(first < end && __fp_sort_less(ctx, first, begin)) first += size;
+	while(last >= first && !__fp_sort_less(ctx, last, begin)) last -= size;
+	*already_partitioned = first >= last;
+
+	// Each swap leaves an element on either side which stops the other scan, so the inner loops don't need bounds checks
+	while(first < last) {
+		__fp_sort_swap(ctx, first, last);
+		do first += size; while(__fp_sort_less(ctx, first, begin));
+		do last -= size; while(!__fp_sort_less(ctx, last, begin));
+	}
+
+	uint8_t* pivot = first - size;
+	if(pivot != begin) __fp_sort_swap(ctx, begin, pivot);
+	return pivot;
+}
+
+// Partitions around the pivot at begin, elements equal to it go to the left (used once the pivot is known to be the smallest element in the range)
+inline static uint8_t* __fp_partition_left(const struct __fp_sort_context* ctx, uint8_t* begin, uint8_t* end) FP_NOEXCEPT {
+	size_t size = ctx->size;
+	uint8_t* first = begin + size, *last = end - size;
+	while(last > begin && __fp_sort_less(ctx, begin, last)) last -= size;
+	while(first <= last && !__fp_sort_less(ctx, begin, first)) first += size;
+
+	while(first < last) {
+		__fp_sort_swap(ctx, first, last);
+		do last -= size; while(__fp_sort_less(ctx, begin, last));
+		do first += size; while(!__fp_sort_less(ctx, begin, first));
+	}
+
+	if(last != begin) __fp_sort_swap(ctx, begin, last);
+	return last;
+}
+
+inline static void __fp_sort_loop(const struct __fp_sort_context* ctx, uint8_t* begin, uint8_t* end, int bad_allowed, bool leftmost) FP_NOEXCEPT {
+	size_t size = ctx->size;
+	while(true) {
+		size_t count = (end - begin) / size;
+		if(count < FP_SORT_INSERTION_THRESHOLD) {
+			__fp_insertion_sort(ctx, begin, end);
+			return;
+		}
+
+		// Move the median of three (or of three medians of three) to the start of the range
+		uint8_t* middle = begin + count / 2 * size;
+		if(count > __FP_SORT_NINTHER_THRESHOLD) {
+			__fp_sort3(ctx, begin, middle, end - size);
+			__fp_sort3(ctx, begin + size, middle - size, end - 2 * size);
+			__fp_sort3(ctx, begin + 2 * size, middle + size, end - 3 * size);
+			__fp_sort3(ctx, middle - size, middle, middle + size);
+			__fp_sort_swap(ctx, begin, middle);
+		} else __fp_sort3(ctx, middle, begin, end - size);
+
+		// If the pivot equals the element before the range (which is no larger than anything in it), every element equal to it can be skipped
+		if(!leftmost && !__fp_sort_less(ctx, begin - size, begin)) {
+			begin = __fp_partition_left(ctx, begin, end) + size;
+			continue;
+		}
+
+		bool already_partitioned;
+		uint8_t* pivot = __fp_partition_right(ctx, begin, end, &already_partitioned);
+		size_t left = (pivot - begin) / size, right = (end - pivot) / size - 1;
+
+		if(left < count / 8 || right < count / 8) { // Highly unbalanced, shuffle some elements around to break up the pattern causing it
+			if(--bad_allowed <= 0) {
+				__fp_heap_sort(ctx, begin, end);
+				return;
+			}
+			if(left >= FP_SORT_INSERTION_THRESHOLD) {
+				__fp_sort_swap(ctx, begin, begin + left / 4 * size);
+				__fp_sort_swap(ctx, pivot - size, pivot - left / 4 * size);
+			}
+			if(right >= FP_SORT_INSERTION_THRESHOLD) {
+				__fp_sort_swap(ctx, pivot + size, pivot + (1 + right / 4) * size);
+				__fp_sort_swap(ctx, end - size, end - right / 4 * size);
+			}
+		} else if(already_partitioned && __fp_partial_insertion_sort(ctx, begin, pivot) && __fp_partial_insertion_sort(ctx, pivot + size, end))
+			return; // The range was (nearly) sorted already
+
+		__fp_sort_loop(ctx, begin, pivot, bad_allowed, leftmost);
+		begin = pivot + size;
+		leftmost = false;
+	}
+}
+
+/**
+* @brief Sorts the elements (of \p type_size bytes) in \p view in place, not stable
+* @note Uses pattern defeating quicksort, so sorted, reversed, and mostly equal inputs are handled in (close to) linear time and the worst case is O(n log n)
+*/
+inline static void __fp_sort(fp_void_view view, size_t type_size, fp_compare_t compare, void* userdata) FP_NOEXCEPT {
+	if(fp_view_size(view) < 2) return;
+	struct __fp_sort_context ctx = {type_size, compare, userdata};
+	int bad_allowed = 0;
+	for(size_t n = fp_view_size(view); n > 1; n >>= 1) ++bad_allowed;
+	uint8_t* begin = fp_view_data(uint8_t, view);
+	__fp_sort_loop(&ctx, begin, begin + fp_view_size(view) * type_size, bad_allowed, true);
+}
+#define fp_view_sort(type, view, compare, userdata) __fp_sort((fp_void_view)(view), sizeof(type), (compare), (userdata))
+#define fp_sort(p, compare, userdata) __fp_sort(fp_void_view_literal((p), fp_size(p)), sizeof(*(p)), (compare), (userdata))
+#define fpda_sort fp_sort
+
+
+// Radix sort
+
+enum fp_radix_key {
+	FP_RADIX_UNSIGNED, // Unsigned integers, or any fixed size key whose bytes (read as a little endian number) order it
+	FP_RADIX_SIGNED, // Two's complement integers
+	FP_RADIX_FLOAT, // IEEE 754 floating point numbers (of any width), NaNs end up at whichever end their sign bit points to
+};
+
+// Extracts the byte of a key a pass sorts by, remapped so that the bytes order the same way the keys do
+inline static uint8_t __fp_radix_digit(const uint8_t* key, size_t byte, size_t key_size, enum fp_radix_key kind) FP_NOEXCEPT {
+	uint8_t digit = key[byte];
+	switch(kind) {
+	case FP_RADIX_UNSIGNED: return digit;
+	case FP_RADIX_SIGNED: return byte == key_size - 1 ? digit ^ 0x80 : digit;
+	case FP_RADIX_FLOAT:
+		if(key[key_size - 1] & 0x80) return ~digit; // Negative numbers are ordered backwards
+		return byte == key_size - 1 ? digit ^ 0x80 : digit;
+	}
+	return digit;
+}
+
+inline static void __fp_radix_scatter(uint8_t* dest, const uint8_t* src, size_t count, size_t element_size, size_t key_offset, size_t byte, size_t key_size, enum fp_radix_key kind, size_t* offsets) FP_NOEXCEPT {
+	// NOTE: The common element sizes get their own loops so the copies are inlined
+	switch(element_size) {
+	case 4:
+		for(size_t i = 0; i < count; ++i)
+			memcpy(dest + offsets[__fp_radix_digit(src + i * 4 + key_offset, byte, key_size, kind)]++ * 4, src + i * 4, 4);
+		break;
+	case 8:
+		for(size_t i = 0; i < count; ++i)
+			memcpy(dest + offsets[__fp_radix_digit(src + i * 8 + key_offset, byte, key_size, kind)]++ * 8, src + i * 8, 8);
+		break;
+	default:
+		for(size_t i = 0; i < count; ++i)
+			memcpy(dest + offsets[__fp_radix_digit(src + i * element_size + key_offset, byte, key_size, kind)]++ * element_size, src + i * element_size, element_size);
+	}
+}
+
+/**
+* @brief Stably sorts the elements (of \p element_size bytes) in \p view by the \p key_size byte key \p key_offset bytes into each of them
+* @note Least significant digit first, one pass per byte of the key (passes where every key shares the byte are skipped)
+* @note Keys are read as little endian numbers
+* @param scratch dynarray the sort borrows its temporary storage from (it is grown as needed and left allocated so it can be reused), if null a temporary one is used
+*/
+void __fp_radix_sort(fp_void_view view, size_t element_size, size_t key_offset, size_t key_size, enum fp_radix_key kind, fp_dynarray(uint8_t)* scratch) FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+	assert(key_offset + key_size <= element_size);
+	size_t count = fp_view_size(view);
+	if(count < 2) return;
+
+	fp_dynarray(uint8_t) temporary = NULL;
+	if(!scratch) scratch = &temporary;
+	size_t counts_size = key_size * 256 * sizeof(size_t); // NOTE: A multiple of 8 so the elements which follow stay aligned
+	fpda_reserve(*scratch, counts_size + count * element_size);
+	size_t* counts = (size_t*)*scratch;
+	memset(counts, 0, counts_size);
+
+	// Histogram every byte of the keys in a single pass
+	uint8_t* src = fp_view_data(uint8_t, view), *dest = *scratch + counts_size;
+	for(size_t i = 0; i < count; ++i) {
+		const uint8_t* key = src + i * element_size + key_offset;
+		for(size_t byte = 0; byte < key_size; ++byte)
+			counts[byte * 256 + __fp_radix_digit(key, byte, key_size, kind)]++;
+	}
+
+	for(size_t byte = 0; byte < key_size; ++byte) {
+		size_t* offsets = counts + byte * 256;
+		if(offsets[__fp_radix_digit(src + key_offset, byte, key_size, kind)] == count) continue; // Every key shares this byte
+
+		for(size_t digit = 0, total = 0; digit < 256; ++digit) {
+			size_t c = offsets[digit];
+			offsets[digit] = total;
+			total += c;
+		}
+		__fp_radix_scatter(dest, src, count, element_size, key_offset, byte, key_size, kind, offsets);
+		uint8_t* swap = src;
+		src = dest;
+		dest = swap;
+	}
+
+	if(src != fp_view_data(uint8_t, view))
+		memcpy(fp_view_data(uint8_t, view), src, count * element_size);
+	fpda_free(temporary);
+}
+#else
+;
+#endif
+#define fp_view_radix_sort(type, view, kind) __fp_radix_sort((fp_void_view)(view), sizeof(type), 0, sizeof(type), (kind), NULL)
+#define fp_view_radix_sort_scratch(type, view, kind, scratch) __fp_radix_sort((fp_void_view)(view), sizeof(type), 0, sizeof(type), (kind), (scratch))
+// Sorts structures by one of their (integer, floating point, or fixed size) members
+#define fp_view_radix_sort_by_member(type, view, member, kind) __fp_radix_sort((fp_void_view)(view), sizeof(type), offsetof(type, member), sizeof(((type*)0)->member), (kind), NULL)
+#define fp_radix_sort(p, kind) __fp_radix_sort(fp_void_view_literal((p), fp_size(p)), sizeof(*(p)), 0, sizeof(*(p)), (kind), NULL)
+#define fpda_radix_sort fp_radix_sort
+
+
+// Binary search
+// NOTE: The comparison functions are passed an element of the view first and the key second (the key is usually an element itself)
+
+// Finds the index of the first element which is not less than \p key (the size of the view if there isn't one)
+inline static size_t __fp_lower_bound(fp_void_view view, size_t type_size, const void* key, fp_compare_t compare, void* userdata) FP_NOEXCEPT {
+	const uint8_t* data = fp_view_data(uint8_t, view);
+	size_t first = 0;
+	for(size_t count = fp_view_size(view); count > 0; ) {
+		size_t half = count / 2;
+		if(compare(userdata, data + (first + half) * type_size, key) < 0) {
+			first += half + 1;
+			count -= half + 1;
+		} else count = half;
+	}
+	return first;
+}
+// Finds the index of the first element which is greater than \p key (the size of the view if there isn't one)
+inline static size_t __fp_upper_bound(fp_void_view view, size_t type_size, const void* key, fp_compare_t compare, void* userdata) FP_NOEXCEPT {
+	const uint8_t* data = fp_view_data(uint8_t, view);
+	size_t first = 0;
+	for(size_t count = fp_view_size(view); count > 0; ) {
+		size_t half = count / 2;
+		if(compare(userdata, data + (first + half) * type_size, key) <= 0) {
+			first += half + 1;
+			count -= half + 1;
+		} else count = half;
+	}
+	return first;
+}
+// Finds the subview of elements which are equal to \p key
+inline static fp_void_view __fp_equal_range(fp_void_view view, size_t type_size, const void* key, fp_compare_t compare, void* userdata) FP_NOEXCEPT {
+	size_t start = __fp_lower_bound(view, type_size, key, compare, userdata);
+	fp_void_view rest = __fp_make_subview(view, type_size, start, fp_view_size(view) - start);
+	return __fp_make_subview(rest, type_size, 0, __fp_upper_bound(rest, type_size, key, compare, userdata));
+}
+#define fp_view_lower_bound(type, view, key, compare, userdata) __fp_lower_bound((fp_void_view)(view), sizeof(type), (key), (compare), (userdata))
+#define fp_view_upper_bound(type, view, key, compare, userdata) __fp_upper_bound((fp_void_view)(view), sizeof(type), (key), (compare), (userdata))
+#define fp_view_equal_range(type, view, key, compare, userdata) ((fp_view(type))__fp_equal_range((fp_void_view)(view), sizeof(type), (key), (compare), (userdata)))
+#define fp_lower_bound(p, key, compare, userdata) __fp_lower_bound(fp_void_view_literal((p), fp_size(p)), sizeof(*(p)), (key), (compare), (userdata))
+#define fp_upper_bound(p, key, compare, userdata) __fp_upper_bound(fp_void_view_literal((p), fp_size(p)), sizeof(*(p)), (key), (compare), (userdata))
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __LIB_FAT_POINTER_SORT_H__
@@ -0,0 +1,216 @@
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+#include "sort.h"
+#include "pointer.hpp"
+
+namespace fp {
+
+	namespace detail::sort {
+		// NOTE: Mirrors the pattern defeating quicksort in sort.h, but moves elements and calls the comparator directly so it can be inlined
+
+		template<typename T, typename Less>
+		inline void sort3(T* a, T* b, T* c, Less& less) {
+			if(less(*b, *a)) std::iter_swap(a, b);
+			if(less(*c, *b)) std::iter_swap(b, c);
+			if(less(*b, *a)) std::iter_swap(a, b);
+		}
+
+		template<typename T, typename Less>
+		inline void insertion_sort(T* begin, T* end, Less& less) {
+			if(begin == end) return;
+			for(T* i = begin + 1; i < end; ++i) {
+				if(!less(*i, *(i - 1))) continue;
+				T value = std::move(*i);
+				T* j = i;
+				do {
+					*j = std::move(*(j - 1));
+					--j;
+				} while(j > begin && less(value, *(j - 1)));
+				*j = std::move(value);
+			}
+		}
+
+		template<typename T, typename Less>
+		inline bool partial_insertion_sort(T* begin, T* end, Less& less) {
+			if(begin == end) return true;
+			size_t moves = 0;
+			for(T* i = begin + 1; i < end; ++i) {
+				if(!less(*i, *(i - 1))) continue;
+				T value = std::move(*i);
+				T* j = i;
+				do {
+					*j = std::move(*(j - 1));
+					--j;
+				} while(j > begin && less(value, *(j - 1)));
+				*j = std::move(value);
+				moves += i - j;
+				if(moves > __FP_SORT_PARTIAL_INSERTION_LIMIT) return false;
+			}
+			return true;
+		}
+
+		template<typename T, typename Less>
+		inline void heap_sort(T* begin, T* end, Less& less) {
+			std::make_heap(begin, end, std::ref(less));
+			std::sort_heap(begin, end, std::ref(less));
+		}
+
+		template<typename T, typename Less>
+		inline std::pair<T*, bool> partition_right(T* begin, T* end, Less& less) {
+			T pivot = std::move(*begin);
+			T* first = begin + 1, *last = end - 1;
+			while(first < end && less(*first, pivot)) ++first;
+			while(last >= first && !less(*last, pivot)) --last;
+			bool already_partitioned = first >= last;
+
+			while(first < last) {
+				std::iter_swap(first, last);
+				while(less(*++first, pivot));
+				while(!less(*--last, pivot));
+			}
+
+			T* pivot_position = first - 1;
+			if(pivot_position != begin) *begin = std::move(*pivot_position);
+			*pivot_position = std::move(pivot);
+			return {pivot_position, already_partitioned};
+		}
+
+		template<typename T, typename Less>
+		inline T* partition_left(T* begin, T* end, Less& less) {
+			T pivot = std::move(*begin);
+			T* first = begin + 1, *last = end - 1;
+			while(last > begin && less(pivot, *last)) --last;
+			while(first <= last && !less(pivot, *first)) ++first;
+
+			while(first < last) {
+				std::iter_swap(first, last);
+				while(less(pivot, *--last));
+				while(!less(pivot, *++first));
+			}
+
+			if(last != begin) *begin = std::move(*last);
+			*last = std::move(pivot);
+			return last;
+		}
+
+		template<typename T, typename Less>
+		void loop(T* begin, T* end, Less& less, int bad_allowed, bool leftmost) {
+			while(true) {
+				size_t count = end - begin;
+				if(count < FP_SORT_INSERTION_THRESHOLD) {
+					insertion_sort(begin, end, less);
+					return;
+				}
+
+				T* middle = begin + count / 2;
+				if(count > __FP_SORT_NINTHER_THRESHOLD) {
+					sort3(begin, middle, end - 1, less);
+					sort3(begin + 1, middle - 1, end - 2, less);
+					sort3(begin + 2, middle + 1, end - 3, less);
+					sort3(middle - 1, middle, middle + 1, less);
+					std::iter_swap(begin, middle);
+				} else sort3(middle, begin, end - 1, less);
+
+				if(!leftmost && !less(*(begin - 1), *begin)) {
+					begin = partition_left(begin, end, less) + 1;
+					continue;
+				}
+
+				auto [pivot, already_partitioned] = partition_right(begin, end, less);
+				size_t left = pivot - begin, right = end - pivot - 1;
+
+				if(left < count / 8 || right < count / 8) {
+					if(--bad_allowed <= 0) {
+						heap_sort(begin, end, less);
+						return;
+					}
+					if(left >= FP_SORT_INSERTION_THRESHOLD) {
+						std::iter_swap(begin, begin + left / 4);
+						std::iter_swap(pivot - 1, pivot - left / 4);
+					}
+					if(right >= FP_SORT_INSERTION_THRESHOLD) {
+						std::iter_swap(pivot + 1, pivot + 1 + right / 4);
+						std::iter_swap(end - 1, end - right / 4);
+					}
+				} else if(already_partitioned && partial_insertion_sort(begin, pivot, less) && partial_insertion_sort(pivot + 1, end, less))
+					return;
+
+				loop(begin, pivot, less, bad_allowed, leftmost);
+				begin = pivot + 1;
+				leftmost = false;
+			}
+		}
+
+		template<typename T>
+		constexpr fp_radix_key radix_key() {
+			if constexpr(std::is_floating_point_v<T>) return FP_RADIX_FLOAT;
+			else if constexpr(std::is_signed_v<T>) return FP_RADIX_SIGNED;
+			else return FP_RADIX_UNSIGNED;
+		}
+	}
+
+	// Sorts the view in place (not stable), less is inlined into the sort
+	template<typename T, typename Less = std::less<>>
+	void sort(view<T> range, Less less = {}) {
+		int bad_allowed = 0;
+		for(size_t n = range.size(); n > 1; n >>= 1) ++bad_allowed;
+		if(range.size() > 1) detail::sort::loop(range.data(), range.data() + range.size(), less, bad_allowed, true);
+	}
+
+	// Stably sorts a view of integers or floating point numbers (borrowing temporary storage from scratch if provided)
+	template<typename T>
+		requires(std::is_arithmetic_v<T>)
+	void radix_sort(view<T> range, fp_dynarray(uint8_t)* scratch = nullptr) {
+		__fp_radix_sort((fp_void_view)range, sizeof(T), 0, sizeof(T), detail::sort::radix_key<T>(), scratch);
+	}
+	// Stably sorts a view by an (integer or floating point) member, key must return a reference to the member
+	template<typename T, typename F>
+	void radix_sort_by_key(view<T> range, F key, fp_dynarray(uint8_t)* scratch = nullptr) {
+		if(range.empty()) return;
+		using Key = std::remove_cvref_t<decltype(key(std::declval<T&>()))>;
+		static_assert(std::is_arithmetic_v<Key>, "Radix sort keys must be integers or floating point numbers");
+		static_assert(std::is_trivially_copyable_v<T>, "Radix sort moves elements by copying their bytes");
+		size_t member = (const uint8_t*)&key(*range.data()) - (const uint8_t*)range.data();
+		assert(member + sizeof(Key) <= sizeof(T)); // The key must be a member of the element
+		__fp_radix_sort((fp_void_view)range, sizeof(T), member, sizeof(Key), detail::sort::radix_key<Key>(), scratch);
+	}
+
+	// Finds the index of the first element of a sorted view which is not less than key
+	template<typename T, typename K, typename Less = std::less<>>
+	size_t lower_bound(view<T> range, const K& key, Less less = {}) {
+		size_t first = 0;
+		for(size_t count = range.size(); count > 0; ) {
+			size_t half = count / 2;
+			if(less(range.data()[first + half], key)) {
+				first += half + 1;
+				count -= half + 1;
+			} else count = half;
+		}
+		return first;
+	}
+	// Finds the index of the first element of a sorted view which is greater than key
+	template<typename T, typename K, typename Less = std::less<>>
+	size_t upper_bound(view<T> range, const K& key, Less less = {}) {
+		size_t first = 0;
+		for(size_t count = range.size(); count > 0; ) {
+			size_t half = count / 2;
+			if(!less(key, range.data()[first + half])) {
+				first += half + 1;
+				count -= half + 1;
+			} else count = half;
+		}
+		return first;
+	}
+	// Finds the subview of a sorted view whose elements are equal to key
+	template<typename T, typename K, typename Less = std::less<>>
+	view<T> equal_range(view<T> range, const K& key, Less less = {}) {
+		size_t start = lower_bound(range, key, less);
+		auto rest = range.subview(start);
+		return rest.subview(0, upper_bound(rest, key, less));
+	}
+}
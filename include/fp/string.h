@@ -3,6 +3,9 @@
 
 #include "dynarray.h"
 #include "fp/pointer.h"
+#ifdef FP_HAS_MMAP
+	#include "mapped_file.h"
+#endif
 #include <stdio.h>
 #include <stdarg.h>
 
@@ -27,6 +30,10 @@ typedef fp_view(char) fp_string_view;
 void fp_string_free(fp_string str) FP_NOEXCEPT
 #ifdef FP_IMPLEMENTATION
 {
+#ifdef FP_HAS_MMAP
+	if(fp_is_mapped_file(str)) fp_munmap_file(str);
+	else
+#endif
 	if(is_fpda(str)) fpda_free(str);
 	else if(is_fp(str) && fp_is_heap_allocated(str)) fp_free(str);
 	else FP_ALLOCATION_FUNCTION(str, 0);
@@ -98,8 +105,8 @@ inline static fp_string __fp_string_view_concatenate_inplace(fp_string* a, const
 }
 inline static fp_string __fp_string_concatenate_inplace(fp_string* a, const fp_string b) FP_NOEXCEPT { return __fp_string_view_concatenate_inplace(a, fp_string_to_view_const(b)); }
 
-#define fp_string_view_concatenate_inplace(a, b) __fp_string_view_concatenate_inplace(&a, (b))
-#define fp_string_concatenate_inplace(a, b) __fp_string_concatenate_inplace(&a, (b))
+#define fp_string_view_concatenate_inplace(a, b) FP_PROFILE_SCOPE(fp_string, __fp_string_view_concatenate_inplace(&a, (b)))
+#define fp_string_concatenate_inplace(a, b) FP_PROFILE_SCOPE(fp_string, __fp_string_concatenate_inplace(&a, (b)))
 
 inline static fp_string fp_string_view_concatenate(const fp_string_view a, const fp_string_view b) FP_NOEXCEPT {
 	fp_dynarray(char) out = NULL;
@@ -160,7 +167,7 @@ inline static fp_string fp_string_append_impl(fp_string* str, char c) FP_NOEXCEP
 	(*str)[size + 1] = 0;
 	return *str;
 }
-#define fp_string_append(str, c) fp_string_append_impl(&str, (c))
+#define fp_string_append(str, c) FP_PROFILE_SCOPE(fp_string, fp_string_append_impl(&str, (c)))
 
 
 
@@ -339,7 +346,7 @@ inline static fp_dynarray(fp_string_view) fp_string_view_split(const fp_string_v
 		if(found == MAX) break;
 
 		fpda_push_back(out, fp_string_view_literal(view_data + last_found, found - last_found));
-		last_found = found;
+		last_found = found + 1; // Skip over the delimiter
 	} while(found != MAX);
 
 	// Once there are no more delimiters to be found push the final string
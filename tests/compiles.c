@@ -3,6 +3,20 @@
 #include <fp/dynarray.h>
 #include <fp/string.h>
 #include <fp/hash/table.h>
+#include <fp/allocator/arena.h>
+#include <fp/allocator/slab.h>
+#include <fp/allocator/thread_cache.h>
+#include <fp/profile.h>
+#include <fp/simd.h>
+#include <fp/sort.h>
+#include <fp/deque.h>
+#include <fp/queue.h>
+#include <fp/concurrent_dynarray.h>
+#include <fp/soa_dynarray.h>
+#include <fp/bitset.h>
+#include <fp/slotmap.h>
+#include <fp/segmented_dynarray.h>
+#include <fp/compressed.h>
 
 // void* __heap_end;
 
@@ -9,7 +9,22 @@
 #include <fp/pointer.h>
 #include <fp/dynarray.h>
 #include <fp/string.h>
+#include <fp/sort.h>
+#include <fp/deque.h>
+#include <fp/queue.h>
+#include <fp/concurrent_dynarray.h>
+#include <fp/soa_dynarray.h>
+#include <fp/bitset.h>
+#include <fp/slotmap.h>
+#include <fp/segmented_dynarray.h>
+#include <fp/compressed.h>
 #include <fp/hash/table.h>
+#include <fp/allocator/arena.h>
+#include <fp/allocator/slab.h>
+#include <fp/allocator/thread_cache.h>
+
+#include <atomic>
+#include <thread>
 
 extern "C" {
 void check_stack();
@@ -23,6 +38,16 @@ void check_hash();
 
 #define DISCARD_RESULT (void)
 
+struct counting_allocator_state {
+	size_t allocations, frees;
+};
+static void* counting_allocator(void* userdata, void* p, size_t size) FP_NOEXCEPT {
+	auto state = (counting_allocator_state*)userdata;
+	if(size == 0) ++state->frees;
+	else if(p == nullptr) ++state->allocations;
+	return FP_ALLOCATION_FUNCTION(p, size);
+}
+
 TEST_SUITE("LibFP") {
 
 	TEST_CASE("Stack") {
@@ -50,6 +75,439 @@ TEST_SUITE("LibFP") {
 		fp_free(arr);
 	}
 
+	TEST_CASE("Allocator") {
+		counting_allocator_state state = {};
+		fp_allocator_id allocator = fp_allocator_register({counting_allocator, &state});
+		CHECK(allocator != FP_DEFAULT_ALLOCATOR);
+
+		int* arr = fp_malloc_in(int, 20, allocator);
+		CHECK(fp_allocator_of(arr) == allocator);
+		CHECK(fp_is_heap_allocated(arr));
+		arr = fp_realloc(int, arr, 25);
+		CHECK(fp_allocator_of(arr) == allocator);
+		CHECK(fp_length(arr) == 25);
+		int* clone = fp_clone(arr);
+		CHECK(fp_allocator_of(clone) == allocator);
+		fp_free(clone);
+		fp_free(arr);
+		CHECK(state.allocations == 2);
+		CHECK(state.frees == 2);
+
+		fp_dynarray(int) da = nullptr;
+		fpda_reserve_in(da, 2, allocator);
+		for(int i = 0; i < 20; ++i)
+			fpda_push_back(da, i);
+		CHECK(fp_allocator_of(da) == allocator);
+		CHECK(is_fpda(da));
+		fpda_shrink_to_fit(da);
+		CHECK(fp_allocator_of(da) == allocator);
+		CHECK(da[19] == 19);
+		fpda_free(da);
+		CHECK(state.allocations == state.frees);
+
+		int* hashtable = nullptr;
+		fp_hash_create_empty_table_in(int, hashtable, true, allocator);
+		for(int key = 0; key < 20; ++key)
+			CHECK(*fp_hash_insert(int, hashtable, key) == key);
+		CHECK(fp_allocator_of(hashtable) == allocator);
+		CHECK(fp_allocator_of(__fp_hash_header(hashtable)) == allocator);
+		CHECK(fp_allocator_of(__fp_hash_header(hashtable)->hashes) == allocator);
+		fp_hash_free(hashtable);
+		CHECK(state.allocations == state.frees);
+
+		int* defaulted = fp_malloc(int, 1);
+		CHECK(fp_allocator_of(defaulted) == FP_DEFAULT_ALLOCATOR);
+		fp_free(defaulted);
+		fp_allocator_unregister(allocator);
+	}
+
+	TEST_CASE("Allocator::Arena") {
+		struct fp_arena* arena = fp_arena_create(1024);
+		REQUIRE(arena != nullptr);
+		fp_allocator_id allocator = fp_arena_allocator(arena);
+
+		int* arr = fp_malloc_in(int, 20, allocator);
+		CHECK(is_fp(arr));
+		CHECK(fp_is_heap_allocated(arr));
+		CHECK(fp_allocator_of(arr) == allocator);
+		arr[19] = 6;
+		int* grown = fp_realloc(int, arr, 40); // The most recent allocation is extended in place
+		CHECK(grown == arr);
+		CHECK(fp_length(grown) == 40);
+		CHECK(grown[19] == 6);
+
+		fp_string str = nullptr;
+		fpda_reserve_in(str, 8, allocator);
+		fp_string_concatenate_inplace(str, "Hello World");
+		fp_string_concatenate_inplace(str, "!");
+		CHECK(is_fpda(str));
+		CHECK(fp_is_heap_allocated(str));
+		CHECK(fp_allocator_of(str) == allocator);
+		CHECK(fp_string_equal(str, "Hello World!"));
+
+		fp_dynarray(int) da = nullptr;
+		fpda_reserve_in(da, 1, allocator);
+		for(int i = 0; i < 1000; ++i) // Outgrows the first chunk
+			fpda_push_back(da, i);
+		CHECK(fpda_size(da) == 1000);
+		CHECK(da[999] == 999);
+		CHECK(fp_allocator_of(da) == allocator);
+
+		fp_string_free(str); // Freeing arena memory is always safe (but usually a no-op)
+		CHECK(fp_arena_bytes_used(arena) > 0);
+		fp_arena_reset(arena);
+		CHECK(fp_arena_bytes_used(arena) == 0);
+
+		int* fresh = fp_malloc_in(int, 4, allocator);
+		CHECK(fp_length(fresh) == 4);
+		fp_free(fresh);
+		CHECK(fp_arena_bytes_used(arena) == 0); // Freeing the most recent allocation pops it off the arena
+		fp_arena_destroy(arena);
+	}
+
+	TEST_CASE("Allocator::Slab") {
+		struct fp_slab* slab = fp_slab_create();
+		REQUIRE(slab != nullptr);
+		fp_allocator_id allocator = fp_slab_allocator(slab);
+
+		fp_dynarray(int) da = nullptr;
+		fpda_reserve_in(da, 1, allocator);
+		for(int i = 0; i < 100; ++i)
+			fpda_push_back(da, i);
+		CHECK(fp_allocator_of(da) == allocator);
+		CHECK(fpda_size(da) == 100);
+		CHECK(da[99] == 99);
+		fpda_free(da);
+
+		// Freed blocks are recycled by the next allocation in the same size class
+		fp_string str = nullptr;
+		fpda_reserve_in(str, 16, allocator);
+		fp_string_concatenate_inplace(str, "Hello World");
+		size_t free_before = fp_slab_free_count(slab, FP_SLAB_OVERHEAD + 16);
+		uint8_t* block = (uint8_t*)__fpda_header(str);
+		fp_string_free(str);
+		CHECK(fp_slab_free_count(slab, FP_SLAB_OVERHEAD + 16) == free_before + 1);
+		fp_string reused = nullptr;
+		fpda_reserve_in(reused, 16, allocator);
+		CHECK((uint8_t*)__fpda_header(reused) == block);
+		fp_string_free(reused);
+
+		// fp_realloc within a size class doesn't move
+		int* arr = fp_malloc_in(int, 2, allocator);
+		arr[1] = 6;
+		CHECK(fp_realloc(int, arr, 3) == arr);
+		CHECK(arr[1] == 6);
+		arr = fp_realloc(int, arr, 4000); // Too large for any size class
+		CHECK(fp_length(arr) == 4000);
+		CHECK(arr[1] == 6);
+		arr = fp_realloc(int, arr, 2);
+		CHECK(arr[1] == 6);
+		fp_free(arr);
+
+		fp_slab_destroy(slab);
+	}
+
+	TEST_CASE("Allocator::ThreadCache") {
+		fp_allocator_id allocator = fp_allocator_register({[](void*, void* p, size_t size) noexcept {
+			return fp_thread_cache_allocate(p, size);
+		}, nullptr});
+		REQUIRE(allocator != FP_DEFAULT_ALLOCATOR);
+		CHECK(sizeof(struct __FatThreadCachePool) == FP_CACHE_LINE_SIZE);
+		CHECK((uintptr_t)__fp_thread_cache_pools() % FP_CACHE_LINE_SIZE == 0); // Every pool has a cache line to itself
+
+		// Reallocations within a size class don't move
+		int* arr = fp_malloc_in(int, 2, allocator);
+		arr[1] = 6;
+		CHECK(fp_realloc(int, arr, 3) == arr);
+		arr = fp_realloc(int, arr, 10000); // Too large for any size class
+		CHECK(fp_length(arr) == 10000);
+		CHECK(arr[1] == 6);
+		fp_free(arr);
+
+		// Blocks allocated on one thread can be freed on another
+		constexpr size_t count = 200;
+		fp_string strings[count];
+		std::thread producer([&] {
+			for(size_t i = 0; i < count; ++i) {
+				strings[i] = nullptr;
+				fpda_reserve_in(strings[i], 16, allocator);
+				fp_string_concatenate_inplace(strings[i], "Hello World");
+			}
+		});
+		producer.join();
+		size_t matches = 0;
+		std::thread consumer([&] {
+			for(size_t i = 0; i < count; ++i) {
+				matches += fp_string_equal(strings[i], "Hello World");
+				fp_string_free(strings[i]);
+			}
+			fp_thread_cache_flush();
+		});
+		consumer.join();
+		CHECK(matches == count);
+		size_t block_size = FP_HEADER_SIZE + 1 + FPDA_HEADER_SIZE + 1 + 16;
+		CHECK(fp_thread_cache_pool_count(block_size) >= count);
+
+		std::atomic<size_t> mismatches = 0;
+		std::thread workers[4];
+		for(auto& worker: workers)
+			worker = std::thread([&] {
+				for(size_t i = 0; i < 1000; ++i) {
+					fp_dynarray(size_t) da = nullptr;
+					fpda_reserve_in(da, 1, allocator);
+					for(size_t j = 0; j < i % 50; ++j)
+						fpda_push_back(da, j);
+					if(fpda_size(da) && da[fpda_size(da) - 1] != fpda_size(da) - 1) ++mismatches;
+					fpda_free(da);
+				}
+			});
+		for(auto& worker: workers)
+			worker.join();
+		CHECK(mismatches == 0);
+
+		fp_thread_cache_flush();
+		fp_thread_cache_trim();
+		CHECK(fp_thread_cache_pool_count(block_size) == 0);
+		fp_allocator_unregister(allocator);
+	}
+
+#ifdef FP_MMAP_ALLOCATOR
+	TEST_CASE("Allocator::Mmap") {
+		struct fp_mmap_options* options = fp_mmap_options();
+		struct fp_mmap_options old_options = *options;
+		options->threshold = 1024 * 1024;
+
+		// Arrays which outgrow the threshold are moved into mappings and then grow without copying
+		fp_dynarray(int) da = nullptr;
+		size_t mismatches = 0;
+		for(int i = 0; i < 1000000; ++i)
+			fpda_push_back(da, i);
+		for(int i = 0; i < 1000000; ++i)
+			mismatches += da[i] != i;
+		CHECK(mismatches == 0);
+		CHECK(__fp_header(__fpda_header(da))->allocator == FP_MMAP_ALLOCATOR);
+		CHECK(fp_allocator_of(da) == FP_DEFAULT_ALLOCATOR); // The array still belongs to the allocator it was created in
+		fpda_shrink_delete_range(da, 0, 999990);
+		CHECK(fpda_size(da) == 10);
+		CHECK(da[9] == 999999);
+		CHECK(__fp_header(__fpda_header(da))->allocator == FP_DEFAULT_ALLOCATOR); // Small enough to leave the mapping
+		fpda_free(da);
+
+		int* small = fp_malloc(int, 10);
+		CHECK(fp_allocator_of(small) == FP_DEFAULT_ALLOCATOR);
+		fp_free(small);
+
+		options->populate = true;
+		char* mapped = fp_malloc_in(char, 100, FP_MMAP_ALLOCATOR);
+		CHECK(fp_allocator_of(mapped) == FP_MMAP_ALLOCATOR);
+		CHECK(__fp_mmap_mapped_size(__fp_header(mapped)) % sysconf(_SC_PAGESIZE) == 0);
+		mapped[99] = 'a';
+		mapped = fp_realloc(char, mapped, 1024 * 1024);
+		CHECK(mapped[99] == 'a');
+		mapped = fp_realloc(char, mapped, 100);
+		CHECK(__fp_mmap_mapped_size(__fp_header(mapped)) < 1024 * 1024);
+		CHECK(mapped[99] == 'a');
+		fp_free(mapped);
+
+		// Growing across the threshold lands in the same place as allocating that size outright (alignment padding included)
+		size_t near_threshold = (options->threshold - FPDA_HEADER_SIZE - 9) / sizeof(int);
+		fp_dynarray(int) grown = nullptr;
+		fp_dynarray(int) fresh = nullptr;
+		fpda_reserve_aligned(grown, 1, 64);
+		fpda_reserve(grown, near_threshold);
+		fpda_reserve_aligned(fresh, near_threshold, 64);
+		CHECK(__fp_header(__fpda_header(fresh))->allocator == FP_MMAP_ALLOCATOR);
+		CHECK(__fp_header(__fpda_header(grown))->allocator == FP_MMAP_ALLOCATOR);
+		fpda_free(grown);
+		fpda_free(fresh);
+		*options = old_options;
+	}
+#endif
+
+	TEST_CASE("Aligned") {
+		float* arr = fp_malloc_aligned(float, 10, 64);
+		CHECK((uintptr_t)arr % 64 == 0);
+		CHECK(fp_alignment(arr) == 64);
+		CHECK(fp_length(arr) == 10);
+		arr[9] = 6;
+		arr = fp_realloc(float, arr, 1000);
+		CHECK((uintptr_t)arr % 64 == 0);
+		CHECK(arr[9] == 6);
+		fp_free(arr);
+
+		fp_dynarray(float) da = nullptr;
+		fpda_reserve_aligned(da, 1, 32);
+		size_t misaligned = 0;
+		for(int i = 0; i < 1000; ++i) {
+			fpda_push_back(da, i);
+			misaligned += (uintptr_t)da % 32 != 0;
+		}
+		CHECK(misaligned == 0);
+		CHECK(fp_alignment(da) == 32);
+		fpda_shrink_delete_range(da, 0, 500);
+		CHECK((uintptr_t)da % 32 == 0);
+		CHECK(da[0] == 500);
+		float* clone = fpda_clone(da);
+		CHECK((uintptr_t)clone % 32 == 0);
+		CHECK(fp_alignment(clone) == 32);
+		fpda_free(clone);
+		fpda_free(da);
+
+		// Reallocations which land on a differently aligned address still keep the data aligned
+		struct fp_arena* arena = fp_arena_create(0);
+		REQUIRE(arena != nullptr);
+		int* aligned = fp_malloc_aligned_in(int, 3, 64, fp_arena_allocator(arena));
+		aligned[2] = 6;
+		size_t offsets = 0;
+		for(size_t i = 1; i < 8; ++i) {
+			int* blocker = fp_malloc_in(int, i, fp_arena_allocator(arena)); // Forces the next reallocation to move
+			aligned = fp_realloc(int, aligned, 3 + i);
+			offsets |= (size_t)1 << __fp_header(aligned)->alignment_offset / 16;
+			misaligned += (uintptr_t)aligned % 64 != 0 || aligned[2] != 6;
+			fp_free(blocker);
+		}
+		CHECK(misaligned == 0);
+		CHECK(offsets != 1); // At least one reallocation needed to shift the data
+		fp_arena_destroy(arena);
+	}
+
+	TEST_CASE("Header Size") {
+#ifdef FP_COMPACT_HEADERS
+		CHECK(FP_HEADER_SIZE == 8);
+		CHECK(FP_HEADER_SIZE + FPDA_HEADER_SIZE == 24);
+#else
+		CHECK(FP_HEADER_SIZE == 16);
+		CHECK(FP_HEADER_SIZE + FPDA_HEADER_SIZE == 40);
+#endif
+		fp_dynarray(double) da = nullptr;
+		fpda_push_back(da, 6);
+		CHECK((uintptr_t)da % alignof(double) == 0);
+		CHECK(fpda_capacity(da) > 0);
+		fpda_free(da);
+
+		fp_string str = fp_string_make_dynamic((char*)"Hello World");
+		CHECK(is_fp(str));
+		CHECK(fp_string_length(str) == 11);
+		fp_string_free(str);
+	}
+
+#ifdef FP_ENABLE_PROFILING
+	TEST_CASE("Profile") {
+		struct recorded { size_t events[FP_PROFILE_EVENT_TYPE_COUNT]; size_t grows_here, copied_here, unknown; int line; } record = {};
+		fp_profile_set_hook([](const fp_profile_event* event, void* userdata) {
+			auto record = (recorded*)userdata;
+			record->events[event->type]++;
+			if(event->file && strcmp(event->file, __FILE__) == 0 && event->line == record->line) {
+				record->grows_here += event->type == FP_PROFILE_GROW && event->old_capacity > 0;
+				record->copied_here += event->bytes_copied;
+			}
+			record->unknown += event->file == nullptr;
+		}, &record);
+
+		fp_dynarray(int) da = nullptr;
+		record.line = __LINE__ + 2;
+		for(int i = 0; i < 100; ++i)
+			fpda_push_back(da, i);
+		CHECK(record.grows_here == 5); // 4 -> 8 -> 16 -> 32 -> 64 -> 128
+		CHECK(record.copied_here > 0);
+		fpda_shrink_to_fit(da);
+		CHECK(record.events[FP_PROFILE_SHRINK] == 1);
+		fpda_free(da);
+		CHECK(record.unknown == 1); // Freed by a plain function rather than a macro
+
+		fp_string str = fp_string_make_dynamic((char*)"Hello");
+		record.line = __LINE__ + 1;
+		fp_string_concatenate_inplace(str, (char*)" World, this string needs to grow quite a bit!");
+		CHECK(record.copied_here > 0); // Attributed to the outermost macro, not the macros inside of string.h
+		fp_string_free(str);
+
+		int* table = nullptr;
+		for(int key = 0; key < 100; ++key)
+			fp_hash_insert(int, table, key);
+		CHECK(record.events[FP_PROFILE_HASH_RESIZE] > 1);
+		fp_hash_free(table);
+
+		// The aggregator ranks call sites
+		fp_profile_aggregate_reset();
+		fp_profile_set_hook(fp_profile_aggregate, nullptr);
+		fp_dynarray(int) small = nullptr;
+		fp_dynarray(int) large = nullptr;
+		int small_line = __LINE__ + 3, large_line = __LINE__ + 4;
+		for(int i = 0; i < 1000; ++i) {
+			if(i < 10)
+				fpda_push_back(small, i);
+			fpda_push_back(large, i);
+		}
+		fpda_free(small);
+		fpda_free(large);
+		fp_profile_set_hook(nullptr, nullptr);
+
+		fp_profile_call_site_stats top[2];
+		REQUIRE(fp_profile_top_call_sites(top, 2, false) == 2);
+		CHECK(top[0].line == large_line);
+		CHECK(top[1].line == small_line);
+		CHECK(top[0].bytes_copied > top[1].bytes_copied);
+		REQUIRE(fp_profile_top_call_sites(top, 1, true) == 1);
+		CHECK(top[0].line == large_line);
+		CHECK(top[0].reallocations == top[0].events[FP_PROFILE_GROW] - 1);
+	}
+#endif
+
+	TEST_CASE("SIMD") {
+		constexpr size_t size = 1000;
+		uint8_t* a = fp_malloc(uint8_t, size), *b = fp_malloc(uint8_t, size);
+		uint64_t* filled = fp_malloc(uint64_t, size);
+		enum fp_simd_level supported = fp_simd_detect();
+		for(int level = FP_SIMD_SCALAR; level <= supported; ++level) {
+			CHECK(fp_simd_set_level((enum fp_simd_level)level) == level);
+			size_t failures = 0;
+			for(size_t n: {0, 1, 31, 32, 33, 100, 640, 999}) {
+				for(size_t i = 0; i < n; ++i) {
+					a[i] = (uint8_t)i;
+					b[i] = (uint8_t)(i * 7);
+				}
+				fp_simd_swap(a, b, n);
+				for(size_t i = 0; i < n; ++i)
+					failures += a[i] != (uint8_t)(i * 7) || b[i] != (uint8_t)i;
+
+				memcpy(b, a, n);
+				failures += fp_simd_compare(a, b, n) != 0 || !fp_simd_equal(a, b, n);
+				for(size_t i = 0; i < n; i += 13) { // Every position in a vector (and the tail) is checked against memcmp
+					b[i]++;
+					failures += fp_simd_mismatch(a, b, n) != i || fp_simd_equal(a, b, n);
+					failures += (fp_simd_compare(a, b, n) < 0) != (memcmp(a, b, n) < 0);
+					b[i]--;
+				}
+			}
+			for(size_t pattern_size: {1, 2, 3, 4, 8, 16, 24, 32, 64}) {
+				uint8_t pattern[64];
+				for(size_t i = 0; i < pattern_size; ++i) pattern[i] = (uint8_t)(i + level);
+				size_t count = (size * sizeof(uint64_t) - 5) / pattern_size;
+				fp_simd_fill(filled, pattern, pattern_size, count);
+				for(size_t i = 0; i < count * pattern_size; ++i)
+					failures += ((uint8_t*)filled)[i] != pattern[i % pattern_size];
+			}
+			CHECK(failures == 0);
+		}
+		fp_simd_set_level(supported);
+
+		// Swapping huge regions no longer copies them onto the stack
+		fp_dynarray(uint8_t) large = nullptr;
+		fpda_grow_to_size_and_initialize(large, 16 * 1024 * 1024, 1); // Larger than the default stack
+		large[0] = 2;
+		fpda_swap_range(large, 0, 8 * 1024 * 1024, 8 * 1024 * 1024);
+		CHECK(large[0] == 1);
+		CHECK(large[8 * 1024 * 1024] == 2);
+		fpda_free(large);
+
+		fp_view(uint32_t) x = fp_view_make_full(uint32_t, (uint32_t*)filled);
+		CHECK(fp_view_equal(x, x));
+		CHECK(!fp_view_equal(x, fp_view_subview(uint32_t, x, 0, 10)));
+		fp_free(a);
+		fp_free(b);
+		fp_free(filled);
+	}
+
 	TEST_CASE("View") {
 		int* arr = fp_alloca(int, 20);
 		arr[10] = 6;
@@ -301,6 +759,858 @@ TEST_SUITE("LibFP") {
 		fpda_free(arr);
 	}
 
+	TEST_CASE("Dynamic Array - Bulk") {
+		int values[] = {0, 1, 2, 3, 4, 5, 6, 7};
+		fp_dynarray(int) arr = nullptr;
+		fpda_append_n(arr, values, 4);
+		CHECK(fpda_size(arr) == 4);
+		int* appended = fpda_append_view(arr, fp_view_literal(int, values + 4, 4));
+		CHECK(appended == arr + 4);
+		CHECK(fpda_size(arr) == 8);
+		CHECK(arr[7] == 7);
+		fpda_append_n(arr, arr, 8); // Appending the array to itself
+		CHECK(fpda_size(arr) == 16);
+		CHECK(arr[8] == 0);
+		CHECK(arr[15] == 7);
+		fpda_append_n(arr, values, 0);
+		CHECK(fpda_size(arr) == 16);
+		fpda_free_and_null(arr);
+
+		fpda_append_n(arr, values, 5); // 0 1 2 3 4
+		int a[] = {10, 11}, b[] = {20}, c[] = {30, 31, 32};
+		struct fpda_insertion insertions[] = {
+			{0, fp_void_view_literal(a, 2)},
+			{2, fp_void_view_literal(b, 1)},
+			{2, fp_void_view_literal(c, 3)},
+			{5, fp_void_view_literal(b, 1)},
+		};
+		fpda_insert_views(arr, insertions, 4);
+		int expected[] = {10, 11, 0, 1, 20, 30, 31, 32, 2, 3, 4, 20};
+		REQUIRE(fpda_size(arr) == 12);
+		CHECK(memcmp(arr, expected, sizeof(expected)) == 0);
+
+		int* inserted = fpda_insert_view(arr, 1, fp_view_literal(int, values, 2));
+		CHECK(inserted == arr + 1);
+		CHECK(fpda_size(arr) == 14);
+		CHECK(arr[0] == 10);
+		CHECK(arr[1] == 0);
+		CHECK(arr[2] == 1);
+		CHECK(arr[3] == 11);
+		fpda_free(arr);
+	}
+
+	TEST_CASE("Dynamic Array - Remove If") {
+		enum fp_simd_level supported = fp_simd_detect();
+		for(int level = FP_SIMD_SCALAR; level <= supported; ++level) {
+			fp_simd_set_level((enum fp_simd_level)level);
+
+			fp_dynarray(int) ints = nullptr;
+			for(int i = 0; i < 1000; ++i)
+				fpda_push_back(ints, i);
+			int divisor = 3;
+			size_t removed = fpda_remove_if(ints, [](void* userdata, const void* element) noexcept {
+				return *(const int*)element % *(int*)userdata != 0;
+			}, &divisor);
+			CHECK(removed == 666);
+			REQUIRE(fpda_size(ints) == 334);
+			size_t mismatches = 0;
+			for(int i = 0; i < 334; ++i)
+				mismatches += ints[i] != i * 3;
+			CHECK(mismatches == 0);
+			fpda_free(ints);
+
+			fp_dynarray(int64_t) longs = nullptr;
+			for(int64_t i = 0; i < 100; ++i)
+				fpda_push_back(longs, i / 4); // 0 0 0 0 1 1 1 1 ...
+			CHECK(fpda_unique(longs) == 75);
+			REQUIRE(fpda_size(longs) == 25);
+			mismatches = 0;
+			for(int64_t i = 0; i < 25; ++i)
+				mismatches += longs[i] != i;
+			CHECK(mismatches == 0);
+			fpda_free(longs);
+
+			// Odd sized elements
+			fp_string str = fp_string_promote_literal("a bb ccc dddd eeeee ffffff ggggggg hhhhhhhh iiiiiiiii jjjjjjjjjj kkkkkkkkkkk");
+			CHECK(fpda_erase_if(str, [](void*, const void* c) noexcept { return *(const char*)c == ' '; }, nullptr) == 10);
+			CHECK(fp_string_equal(str, "abbcccddddeeeeeffffffggggggghhhhhhhhiiiiiiiiijjjjjjjjjjkkkkkkkkkkk"));
+			CHECK(fpda_unique(str) == 55);
+			CHECK(fp_string_equal(str, "abcdefghijk"));
+			fp_string_free(str);
+		}
+		fp_simd_set_level(supported);
+
+		fp_dynarray(int) empty = nullptr;
+		CHECK(fpda_unique(empty) == 0);
+	}
+
+	TEST_CASE("Dynamic Array - Growth Policy") {
+		fp_dynarray(int) arr = nullptr;
+		CHECK(fpda_growth_policy(arr) == FP_GROWTH_POWER_OF_TWO);
+		fpda_set_growth_policy(arr, FP_GROWTH_DOUBLE);
+		CHECK(fpda_growth_policy(arr) == FP_GROWTH_DOUBLE);
+		size_t capacity = fpda_capacity(arr), violations = 0;
+		for(int i = 0; i < 100; ++i) {
+			fpda_push_back(arr, i);
+			if(fpda_capacity(arr) != capacity)
+				violations += fpda_capacity(arr) != FP_MAX(capacity * 2, fpda_size(arr));
+			capacity = fpda_capacity(arr);
+		}
+		CHECK(violations == 0);
+		CHECK(fpda_growth_policy(arr) == FP_GROWTH_DOUBLE);
+
+		fp_dynarray(int) copy = fpda_clone(arr);
+		CHECK(fpda_growth_policy(copy) == FP_GROWTH_DOUBLE);
+		fpda_free(copy);
+
+		// Dropping below a quarter full shrinks back to where the array would grow to
+		capacity = fpda_capacity(arr);
+		fpda_delete_range(arr, 10, 60);
+		CHECK(fpda_size(arr) == 40);
+		CHECK(fpda_capacity(arr) == capacity);
+		fpda_delete_range(arr, 10, 20);
+		CHECK(fpda_size(arr) == 20);
+		CHECK(fpda_capacity(arr) == 40);
+		CHECK(fpda_growth_policy(arr) == FP_GROWTH_DOUBLE);
+		CHECK(arr[9] == 9);
+		CHECK(arr[10] == 90);
+		CHECK(arr[19] == 99);
+		fpda_free_and_null(arr);
+
+		fpda_set_growth_policy(arr, FP_GROWTH_ONE_AND_A_HALF);
+		capacity = fpda_capacity(arr);
+		violations = 0;
+		for(int i = 0; i < 100; ++i) {
+			fpda_push_back(arr, i);
+			if(fpda_capacity(arr) != capacity)
+				violations += fpda_capacity(arr) != FP_MAX(capacity + (capacity + 1) / 2, fpda_size(arr));
+			capacity = fpda_capacity(arr);
+		}
+		CHECK(violations == 0);
+		fpda_free_and_null(arr);
+
+		fp_growth_policy_id chunked = fp_growth_policy_register({fp_growth_fixed_chunk, (void*)10, .5f});
+		CHECK(chunked != FP_GROWTH_POWER_OF_TWO);
+		fpda_set_growth_policy(arr, chunked);
+		for(int i = 0; i < 25; ++i)
+			fpda_push_back(arr, i);
+		CHECK(fpda_capacity(arr) == 30);
+		fpda_delete_range(arr, 0, 20);
+		CHECK(fpda_capacity(arr) == 10);
+		CHECK(arr[0] == 20);
+		fpda_free_and_null(arr);
+		fp_growth_policy_unregister(chunked);
+
+		// The policy survives small arrays moving to the heap
+		arr = fpda_alloca(int, 4);
+		fpda_set_growth_policy(arr, FP_GROWTH_DOUBLE);
+		capacity = fpda_capacity(arr);
+		for(int i = 0; i <= (int)capacity; ++i)
+			fpda_push_back(arr, i);
+		CHECK(!fpda_is_small(arr));
+		CHECK(fpda_growth_policy(arr) == FP_GROWTH_DOUBLE);
+		CHECK(fpda_capacity(arr) == capacity * 2);
+		fpda_free(arr);
+	}
+
+	TEST_CASE("Dynamic Array - Small") {
+		fp_dynarray(int) arr = fpda_alloca(int, 8);
+		CHECK(is_fp(arr));
+		CHECK(is_fpda(arr));
+		CHECK(fpda_is_small(arr));
+		CHECK(!fp_is_heap_allocated(arr));
+		CHECK(fpda_capacity(arr) >= 8);
+		CHECK((uintptr_t)arr % FPDA_SMALL_ALIGNMENT == 0);
+		int* inline_storage = arr;
+		for(int i = 0; i < 8; ++i)
+			fpda_push_back(arr, i);
+		CHECK(arr == inline_storage);
+		fpda_shrink_to_fit(arr);
+		CHECK(fpda_is_small(arr));
+		fpda_free(arr); // Does nothing
+		CHECK(arr[7] == 7);
+
+		size_t capacity = fpda_capacity(arr);
+		for(int i = 8; i <= (int)capacity; ++i)
+			fpda_push_back(arr, i);
+		CHECK(!fpda_is_small(arr)); // Spilled onto the heap
+		CHECK(fp_is_heap_allocated(arr));
+		CHECK(fpda_size(arr) == capacity + 1);
+		size_t mismatches = 0;
+		for(int i = 0; i <= (int)capacity; ++i)
+			mismatches += arr[i] != i;
+		CHECK(mismatches == 0);
+		fpda_free(arr);
+
+		// Caller provided storage
+		alignas(16) uint8_t buffer[FPDA_SMALL_BUFFER_SIZE(char, 32)];
+		fp_string str = fpda_from_buffer(char, buffer, sizeof(buffer));
+		CHECK(fpda_capacity(str) >= 32);
+		fp_string_concatenate_inplace(str, "Hello World");
+		CHECK(fpda_is_small(str));
+		CHECK(fp_string_equal(str, "Hello World"));
+		fp_string_free(str); // Does nothing
+
+		fp_dynarray(char) copy = fpda_alloca(char, 32);
+		fpda_clone_to(copy, str);
+		CHECK(fpda_is_small(copy));
+		CHECK(fp_string_equal(copy, "Hello World"));
+		fp_string_concatenate_inplace(str, ", this string no longer fits in its buffer!");
+		CHECK(!fpda_is_small(str));
+		CHECK(fp_string_equal(str, "Hello World, this string no longer fits in its buffer!"));
+		fpda_clone_to(copy, str);
+		CHECK(!fpda_is_small(copy));
+		CHECK(fp_string_equal(copy, str));
+		fp_string_free(copy);
+		fp_string_free(str);
+	}
+
+	TEST_CASE("Sort") {
+		auto compare_ints = [](void*, const void* a, const void* b) noexcept {
+			int x = *(const int*)a, y = *(const int*)b;
+			return (x > y) - (x < y);
+		};
+		size_t sizes[] = {1, 2, 23, 24, 100, 1000, 10000};
+		for(size_t size: sizes) {
+			// Random, sorted, reversed, and mostly equal inputs
+			fp_dynarray(int) arr = nullptr;
+			fpda_grow(arr, size);
+			for(int pattern = 0; pattern < 4; ++pattern) {
+				uint32_t state = 12345;
+				for(size_t i = 0; i < size; ++i) {
+					state = state * 1664525 + 1013904223;
+					switch(pattern) {
+					case 0: arr[i] = (int)(state >> 8) - (1 << 23); break;
+					case 1: arr[i] = (int)i; break;
+					case 2: arr[i] = (int)(size - i); break;
+					case 3: arr[i] = (int)(state >> 30); break;
+					}
+				}
+				fp_dynarray(int) radix = fpda_clone(arr);
+				fpda_sort(arr, compare_ints, nullptr);
+				fpda_radix_sort(radix, FP_RADIX_SIGNED);
+				size_t unsorted = 0;
+				for(size_t i = 1; i < size; ++i)
+					unsorted += arr[i - 1] > arr[i];
+				CHECK(unsorted == 0);
+				CHECK(fp_view_equal(fp_view_make_full(int, arr), fp_view_make_full(int, radix)));
+				fpda_free(radix);
+			}
+			fpda_free(arr);
+		}
+
+		// Floating point keys, and searching
+		double doubles[] = {3.5, -1, 0, -0.25, 1e10, -1e10, 2, 2, 2, 7};
+		fp_view(double) view = fp_view_literal(double, doubles, 10);
+		fp_view_radix_sort(double, view, FP_RADIX_FLOAT);
+		double sorted[] = {-1e10, -1, -0.25, 0, 2, 2, 2, 3.5, 7, 1e10};
+		CHECK(memcmp(doubles, sorted, sizeof(sorted)) == 0);
+
+		auto compare_doubles = [](void*, const void* a, const void* b) noexcept {
+			double x = *(const double*)a, y = *(const double*)b;
+			return (x > y) - (x < y);
+		};
+		double key = 2;
+		CHECK(fp_view_lower_bound(double, view, &key, compare_doubles, nullptr) == 4);
+		CHECK(fp_view_upper_bound(double, view, &key, compare_doubles, nullptr) == 7);
+		fp_view(double) equal = fp_view_equal_range(double, view, &key, compare_doubles, nullptr);
+		CHECK(fp_view_data(double, equal) == doubles + 4);
+		CHECK(fp_view_size(equal) == 3);
+		key = 100;
+		CHECK(fp_view_lower_bound(double, view, &key, compare_doubles, nullptr) == 9);
+		key = -1e20;
+		CHECK(fp_view_size(fp_view_equal_range(double, view, &key, compare_doubles, nullptr)) == 0);
+
+		// Structures sorted by a member, with a reused scratch buffer
+		struct pair { uint16_t key; char value; } pairs[] = {{300, 'c'}, {2, 'a'}, {300, 'd'}, {7, 'b'}};
+		fp_view_radix_sort_by_member(struct pair, fp_view_literal(struct pair, pairs, 4), key, FP_RADIX_UNSIGNED);
+		CHECK(pairs[0].value == 'a');
+		CHECK(pairs[1].value == 'b');
+		CHECK(pairs[2].value == 'c'); // Stable
+		CHECK(pairs[3].value == 'd');
+		fp_dynarray(uint8_t) scratch = nullptr;
+		fp_view_radix_sort_scratch(double, view, FP_RADIX_FLOAT, &scratch);
+		CHECK(fpda_capacity(scratch) > 0);
+		fpda_free(scratch);
+	}
+
+	TEST_CASE("Deque") {
+		fp_deque(int) q = nullptr;
+		CHECK(fp_deque_capacity(q) == 0);
+		fp_deque_push_back(q, 1);
+		CHECK(is_fp_deque(q));
+		CHECK(is_fp(q));
+		CHECK(fp_is_heap_allocated(q));
+		CHECK(fp_deque_capacity(q) == 4);
+		fp_deque_push_back(q, 2);
+		fp_deque_push_front(q, 0);
+		CHECK(fp_deque_size(q) == 3);
+		CHECK(*fp_deque_front(q) == 0);
+		CHECK(*fp_deque_back(q) == 2);
+		CHECK(fp_deque_segment(int, q, false).size == 1); // The front element wrapped around to the end of the buffer
+		CHECK(fp_deque_segment(int, q, true).size == 2);
+
+		// Growing while wrapped around keeps the elements in order
+		for(int i = 3; i < 10; ++i) fp_deque_push_back(q, i);
+		fp_deque_push_front(q, -1);
+		CHECK(fp_deque_capacity(q) == 16);
+		REQUIRE(fp_deque_size(q) == 11);
+		for(int i = 0; i < 11; ++i) CHECK(fp_deque_get(q, i) == i - 1);
+
+		CHECK(fp_deque_pop_front(q) == -1);
+		CHECK(fp_deque_pop_back(q) == 9);
+		fp_deque_drop_front(q, 2);
+		fp_deque_drop_back(q, 1);
+		CHECK(fp_deque_size(q) == 6);
+		CHECK(fp_deque_get(q, 0) == 2);
+		CHECK(fp_deque_get(q, 5) == 7);
+
+		// FIFO usage never needs more than a handful of slots
+		size_t capacity = fp_deque_capacity(q);
+		for(int i = 0; i < 1000; ++i) {
+			fp_deque_push_back(q, i);
+			fp_deque_drop_front(q, 1);
+		}
+		CHECK(fp_deque_capacity(q) == capacity);
+		CHECK(fp_deque_get(q, 5) == 999);
+
+		int values[20];
+		for(int i = 0; i < 20; ++i) values[i] = 100 + i;
+		fp_deque_append_n(q, values, 20);
+		CHECK(fp_deque_size(q) == 26);
+		auto first = fp_deque_segment(int, q, false), second = fp_deque_segment(int, q, true);
+		CHECK(first.size + second.size == 26);
+		CHECK(fp_view_data(int, first)[0] == 994);
+
+		fp_deque(int) clone = fp_deque_clone(q);
+		CHECK(fp_deque_segment(int, clone, true).size == 0);
+
+		int out[30];
+		CHECK(fp_deque_pop_front_n(q, out, 30) == 26);
+		CHECK(fp_deque_empty(q));
+		CHECK(out[5] == 999);
+		CHECK(out[25] == 119);
+		for(int i = 0; i < 26; ++i) CHECK(fp_deque_get(clone, i) == out[i]);
+
+		fp_deque_free_and_null(q);
+		fp_deque_free(clone);
+	}
+
+	TEST_CASE("Queue") {
+		struct fp_spsc_queue spsc;
+		REQUIRE(fp_spsc_queue_init_type(&spsc, int, 5));
+		CHECK(fp_spsc_queue_capacity(&spsc) == 8);
+		int values[] = {1, 2, 3, 4, 5, 6}, out[8];
+		CHECK(fp_spsc_queue_push_view(&spsc, fp_void_view_literal(values, 6)) == 6);
+		CHECK(fp_spsc_queue_push_view(&spsc, fp_void_view_literal(values, 6)) == 2); // Only two slots were left
+		CHECK(!fp_spsc_queue_push(&spsc, values));
+		CHECK(fp_spsc_queue_pop_view(&spsc, fp_void_view_literal(out, 5)) == 5);
+		CHECK(out[4] == 5);
+		CHECK(fp_spsc_queue_push_view(&spsc, fp_void_view_literal(values, 4)) == 4); // Wraps around
+		CHECK(fp_spsc_queue_pop_view(&spsc, fp_void_view_literal(out, 8)) == 7);
+		int expected[] = {6, 1, 2, 1, 2, 3, 4};
+		CHECK(memcmp(out, expected, sizeof(expected)) == 0);
+		CHECK(!fp_spsc_queue_pop(&spsc, out));
+
+		fp_spsc_queue_free(&spsc);
+
+		// Elements arrive in order across threads
+		REQUIRE(fp_spsc_queue_init_type(&spsc, size_t, 64));
+		constexpr size_t count = 100000;
+		bool ordered = true;
+		std::thread consumer([&] {
+			size_t next = 0, batch[16];
+			while(next < count) {
+				size_t popped = fp_spsc_queue_pop_view(&spsc, fp_void_view_literal(batch, 16));
+				for(size_t i = 0; i < popped; ++i)
+					ordered &= batch[i] == next++;
+			}
+		});
+		for(size_t i = 0; i < count; )
+			i += fp_spsc_queue_push(&spsc, &i);
+		consumer.join();
+		CHECK(ordered);
+		fp_spsc_queue_free(&spsc);
+
+		struct fp_mpmc_queue mpmc;
+		REQUIRE(fp_mpmc_queue_init_type(&mpmc, size_t, 100));
+		CHECK(fp_mpmc_queue_capacity(&mpmc) == 128);
+		std::atomic<size_t> sum = 0, popped = 0;
+		std::thread threads[4];
+		for(size_t t = 0; t < 4; ++t)
+			threads[t] = std::thread([&, t] {
+				if(t % 2 == 0) { // Producers
+					for(size_t i = 1; i <= count; )
+						i += fp_mpmc_queue_push(&mpmc, &i);
+				} else while(popped.load() < 2 * count) { // Consumers
+					size_t value;
+					if(fp_mpmc_queue_pop(&mpmc, &value)) {
+						sum += value;
+						++popped;
+					}
+				}
+			});
+		for(auto& thread: threads)
+			thread.join();
+		CHECK(sum == count * (count + 1)); // Both producers pushed 1 through count
+		size_t value;
+		CHECK(!fp_mpmc_queue_pop(&mpmc, &value));
+		fp_mpmc_queue_free(&mpmc);
+	}
+
+	TEST_CASE("Concurrent Dynamic Array") {
+		struct fp_concurrent_dynarray a;
+		fp_concurrent_dynarray_init(&a, sizeof(int), 4);
+		int values[] = {1, 2, 3, 4, 5, 6};
+		CHECK(fp_concurrent_dynarray_append(&a, values, 3) == 0);
+		int* first = fp_concurrent_dynarray_get_typed(int, &a, 0);
+		CHECK(fp_concurrent_dynarray_append(&a, values, 6) == 3); // Spills into the second and third chunks
+		CHECK(fp_concurrent_dynarray_get_typed(int, &a, 0) == first); // Nothing moved
+		CHECK(*fp_concurrent_dynarray_get_typed(int, &a, 8) == 6);
+		CHECK(fp_concurrent_dynarray_size(&a) == 9);
+
+		fp_dynarray(int) frozen = fp_concurrent_dynarray_freeze_typed(int, &a);
+		REQUIRE(fpda_size(frozen) == 9);
+		int expected[] = {1, 2, 3, 1, 2, 3, 4, 5, 6};
+		CHECK(memcmp(frozen, expected, sizeof(expected)) == 0);
+		CHECK(fp_concurrent_dynarray_size(&a) == 0);
+		fpda_free_and_null(frozen);
+
+		// Every thread's elements end up in the frozen array exactly once
+		fp_concurrent_dynarray_init(&a, sizeof(size_t), 0);
+		constexpr size_t count = 20000, thread_count = 4;
+		std::atomic<bool> stable = true;
+		std::thread threads[thread_count];
+		for(size_t t = 0; t < thread_count; ++t)
+			threads[t] = std::thread([&, t] {
+				for(size_t i = t; i < count; i += thread_count) {
+					size_t index = fp_concurrent_dynarray_push_back(&a, &i);
+					if(*fp_concurrent_dynarray_get_typed(size_t, &a, index) != i) stable = false;
+				}
+			});
+		for(auto& thread: threads)
+			thread.join();
+		fp_dynarray(size_t) all = fp_concurrent_dynarray_freeze_typed(size_t, &a);
+		REQUIRE(fpda_size(all) == count);
+		CHECK(stable);
+		static bool seen[count];
+		size_t distinct = 0;
+		for(size_t i = 0; i < count; ++i)
+			if(!seen[all[i]]) {
+				seen[all[i]] = true;
+				++distinct;
+			}
+		CHECK(distinct == count);
+		fpda_free_and_null(all);
+
+#ifdef FP_MMAP_ALLOCATOR
+		// Freezing past the mapping threshold copies the first chunk, which must bring its elements along
+		struct fp_mmap_options* options = fp_mmap_options();
+		struct fp_mmap_options old_options = *options;
+		options->threshold = 64 * 1024;
+		fp_concurrent_dynarray_init(&a, sizeof(size_t), 1024);
+		for(size_t i = 0; i < count; ++i)
+			fp_concurrent_dynarray_push_back(&a, &i);
+		all = fp_concurrent_dynarray_freeze_typed(size_t, &a);
+		REQUIRE(fpda_size(all) == count);
+		CHECK(__fp_header(__fpda_header(all))->allocator == FP_MMAP_ALLOCATOR);
+		size_t mismatches = 0;
+		for(size_t i = 0; i < count; ++i)
+			mismatches += all[i] != i;
+		CHECK(mismatches == 0);
+		fpda_free_and_null(all);
+		*options = old_options;
+#endif
+		fp_concurrent_dynarray_free(&a);
+	}
+
+	#define PARTICLE_FIELDS(X, context) X(context, float, x) X(context, double, mass) X(context, uint8_t, flags)
+	FP_SOA_DYNARRAY_DEFINE(particles, PARTICLE_FIELDS)
+
+	TEST_CASE("Struct of Arrays Dynamic Array") {
+		fp_soa_dynarray(particles) a = nullptr;
+		for(size_t i = 0; i < 100; ++i) {
+			particles_row row = {float(i), i * 2.0, uint8_t(i % 3)};
+			CHECK(particles_push_back(&a, &row) == i);
+		}
+		CHECK(is_fp_soa_dynarray(a));
+		CHECK(fp_soa_dynarray_size(a) == 100);
+		CHECK(fp_soa_dynarray_capacity(a) == 128);
+		CHECK(particles_mass(a)[99] == 198.0);
+		CHECK(particles_flags(a)[98] == 2);
+		for(size_t i = 0; i < particles_column_count; ++i) // Every column is aligned
+			CHECK(((uintptr_t)fp_soa_dynarray_column(a, particles_column_sizes, i)) % FP_SOA_DYNARRAY_COLUMN_ALIGNMENT == 0);
+
+		particles_row row = {-1, -1, 7};
+		particles_insert(&a, 10, &row);
+		CHECK(particles_x(a)[10] == -1);
+		CHECK(particles_x(a)[11] == 10);
+		CHECK(particles_flags(a)[10] == 7);
+		particles_delete_range(a, 0, 10);
+		row = particles_get(a, 0);
+		CHECK(row.x == -1);
+		CHECK(row.mass == -1);
+		CHECK(particles_mass(a)[1] == 20.0);
+
+		particles_swap_delete(a, 0);
+		CHECK(fp_soa_dynarray_size(a) == 90);
+		CHECK(particles_x(a)[0] == 99); // The last row took its place
+		CHECK(particles_flags(a)[0] == 0);
+
+		void* clone = particles_clone(a);
+		CHECK(fp_soa_dynarray_capacity(clone) == 90);
+		CHECK(particles_mass(clone)[0] == 198.0);
+		CHECK(particles_mass(clone)[89] == 196.0);
+		particles_free(clone);
+
+		particles_reserve(&a, 1000); // Columns move further apart
+		CHECK(fp_soa_dynarray_capacity(a) == 1000);
+		CHECK(particles_x(a)[0] == 99);
+		CHECK(particles_mass(a)[89] == 196.0);
+		CHECK(particles_flags(a)[89] == 98 % 3);
+		fp_soa_dynarray_free_and_null(a);
+	}
+
+	static bool is_even(const void* element, void*) noexcept { return *(const int*)element % 2 == 0; }
+
+	TEST_CASE("Bitset") {
+		fp_bitset b = fp_bitset_create(200);
+		CHECK(is_fp_bitset(b));
+		CHECK(fp_bitset_size(b) == 200);
+		CHECK(fp_bitset_word_count(b) == 4);
+		CHECK(fp_bitset_none(b));
+		fp_bitset_set(b, 0);
+		fp_bitset_set(b, 63);
+		fp_bitset_set(b, 64);
+		fp_bitset_set(b, 199);
+		fp_bitset_flip(b, 100);
+		fp_bitset_flip(b, 100);
+		CHECK(fp_bitset_test(b, 63));
+		CHECK(!fp_bitset_test(b, 100));
+		CHECK(fp_bitset_count(b) == 4);
+		CHECK(fp_bitset_find_next_set(b, 1) == 63);
+		CHECK(fp_bitset_find_next_set(b, 65) == 199);
+		size_t visited = 0, sum = 0;
+		fp_bitset_iterate(b) {
+			++visited;
+			sum += i;
+		}
+		CHECK(visited == 4);
+		CHECK(sum == 0 + 63 + 64 + 199);
+
+		fp_bitset other = fp_bitset_clone(b);
+		fp_bitset_set_all(other);
+		CHECK(fp_bitset_count(other) == 200); // Bits past the size stay clear
+		fp_bitset_andnot(other, b);
+		CHECK(fp_bitset_count(other) == 196);
+		CHECK(!fp_bitset_test(other, 64));
+		fp_bitset_or(other, b);
+		CHECK(fp_bitset_all(other));
+		fp_bitset_xor(other, b);
+		fp_bitset_and(other, b);
+		CHECK(fp_bitset_none(other));
+		fp_bitset_free_and_null(other);
+
+		fp_bitset_resize_value(b, 300, true);
+		CHECK(fp_bitset_count(b) == 104);
+		CHECK(fp_bitset_test(b, 200));
+		fp_bitset_resize(b, 65);
+		CHECK(fp_bitset_count(b) == 3);
+		fp_bitset_push_back(b, true);
+		fp_bitset_push_back(b, false);
+		CHECK(fp_bitset_size(b) == 67);
+		CHECK(fp_bitset_test(b, 65));
+		CHECK(!fp_bitset_test(b, 66));
+		fp_bitset_free_and_null(b);
+
+		// Rank and select agree with a linear scan
+		b = fp_bitset_create(5000);
+		for(size_t i = 0; i < 5000; i += 1 + i % 7)
+			fp_bitset_set(b, i);
+		uint64_t* index = fp_bitset_rank_index(b);
+		size_t rank = 0;
+		bool agree = true;
+		for(size_t i = 0; i < 5000; ++i) {
+			agree &= fp_bitset_rank(b, index, i) == rank;
+			if(fp_bitset_test(b, i)) agree &= fp_bitset_select(b, index, rank++) == i;
+		}
+		CHECK(agree);
+		CHECK(fp_bitset_rank(b, index, 5000) == fp_bitset_count(b));
+		CHECK(fp_bitset_select(b, index, rank) == 5000);
+		fpda_free_and_null(index);
+		fp_bitset_free_and_null(b);
+
+		// Masks built from views
+		int values[100];
+		for(int i = 0; i < 100; ++i) values[i] = i;
+		fp_bitset even = fp_bitset_from_view(int, fp_view_literal(int, values, 100), is_even, nullptr);
+		CHECK(fp_bitset_size(even) == 100);
+		CHECK(fp_bitset_count(even) == 50);
+		CHECK(fp_bitset_test(even, 98));
+		CHECK(fp_bitset_compress(int, even, values, values) == 50);
+		CHECK(values[49] == 98);
+		fp_bitset_free_and_null(even);
+	}
+
+	TEST_CASE("SlotMap") {
+		struct fp_slotmap m;
+		fp_slotmap_init_type(&m, double);
+		CHECK(fp_slotmap_empty(&m));
+		CHECK(!fp_slotmap_contains(&m, FP_SLOTMAP_NULL_HANDLE));
+
+		fp_slotmap_handle handles[10];
+		for(int i = 0; i < 10; ++i) {
+			double value = i;
+			handles[i] = fp_slotmap_insert(&m, &value);
+		}
+		CHECK(fp_slotmap_size(&m) == 10);
+		CHECK(*fp_slotmap_get_typed(double, &m, handles[7]) == 7);
+
+		// Erasing moves the last element into the hole without disturbing its handle
+		CHECK(fp_slotmap_erase(&m, handles[2]));
+		CHECK(!fp_slotmap_erase(&m, handles[2]));
+		CHECK(fp_slotmap_get(&m, handles[2]) == nullptr);
+		CHECK(fp_slotmap_values_typed(double, &m)[2] == 9);
+		CHECK(*fp_slotmap_get_typed(double, &m, handles[9]) == 9);
+		CHECK(fp_slotmap_handle_at(&m, 2) == handles[9]);
+
+		// Reused slots get a new generation, so the stale handle doesn't alias the new element
+		double value = 42;
+		fp_slotmap_handle reused = fp_slotmap_insert(&m, &value);
+		CHECK(fp_slotmap_handle_slot(reused) == fp_slotmap_handle_slot(handles[2]));
+		CHECK(reused != handles[2]);
+		CHECK(fp_slotmap_get(&m, handles[2]) == nullptr);
+		CHECK(*fp_slotmap_get_typed(double, &m, reused) == 42);
+
+		double sum = 0;
+		for(size_t i = 0; i < fp_slotmap_size(&m); ++i)
+			sum += fp_slotmap_values_typed(double, &m)[i];
+		CHECK(sum == 45 - 2 + 42);
+
+		struct fp_slotmap copy;
+		fp_slotmap_init_type(&copy, double);
+		fp_slotmap_clone_to(&copy, &m);
+		fp_slotmap_clear(&m);
+		CHECK(fp_slotmap_empty(&m));
+		CHECK(!fp_slotmap_contains(&m, reused));
+		CHECK(*fp_slotmap_get_typed(double, &copy, reused) == 42);
+		CHECK(fp_slotmap_size(&copy) == 10);
+		fp_slotmap_free(&copy);
+		fp_slotmap_free(&m);
+	}
+
+	TEST_CASE("SparseSet") {
+		struct fp_sparse_set s;
+		fp_sparse_set_init(&s);
+		CHECK(!fp_sparse_set_contains(&s, 0));
+		CHECK(fp_sparse_set_insert(&s, 5));
+		CHECK(fp_sparse_set_insert(&s, 0));
+		CHECK(fp_sparse_set_insert(&s, 100));
+		CHECK(!fp_sparse_set_insert(&s, 5));
+		CHECK(fp_sparse_set_size(&s) == 3);
+		CHECK(fp_sparse_set_contains(&s, 100));
+		CHECK(!fp_sparse_set_contains(&s, 99));
+		CHECK(fp_sparse_set_index_of(&s, 0) == 1);
+
+		CHECK(fp_sparse_set_erase(&s, 5));
+		CHECK(!fp_sparse_set_erase(&s, 5));
+		CHECK(fp_sparse_set_values(&s)[0] == 100);
+		CHECK(fp_sparse_set_index_of(&s, 5) == 2);
+
+		fp_sparse_set_clear(&s);
+		CHECK(fp_sparse_set_empty(&s));
+		CHECK(!fp_sparse_set_contains(&s, 0));
+		CHECK(fp_sparse_set_insert(&s, 0));
+		CHECK(fp_sparse_set_contains(&s, 0));
+		fp_sparse_set_free(&s);
+	}
+
+	TEST_CASE("SegmentedDynarray") {
+		struct fp_segmented_dynarray a;
+		fp_segmented_dynarray_init_in(&a, sizeof(int), 4, FP_DEFAULT_ALLOCATOR);
+		CHECK(fp_segmented_dynarray_empty(&a));
+		CHECK(fp_segmented_dynarray_used_chunks(&a) == 0);
+
+		// Elements never move as the array grows
+		int first = 0;
+		int* stable = (int*)fp_segmented_dynarray_push_back(&a, &first);
+		for(int i = 1; i < 100; ++i)
+			CHECK(*(int*)fp_segmented_dynarray_push_back(&a, &i) == i);
+		CHECK(fp_segmented_dynarray_get(&a, 0) == stable);
+		CHECK(fp_segmented_dynarray_size(&a) == 100);
+		CHECK(*fp_segmented_dynarray_get_typed(int, &a, 63) == 63);
+		CHECK(fp_segmented_dynarray_capacity(&a) == 4 + 8 + 16 + 32 + 64);
+
+		// Chunks are walked in order, each one contiguous
+		size_t chunks = 0, expected = 0;
+		bool in_order = true;
+		fp_segmented_dynarray_iterate_chunks(&a, chunk) {
+			CHECK(chunk.size == FP_MIN(fp_segmented_dynarray_chunk_size(&a, chunks), 100 - expected));
+			for(size_t i = 0; i < chunk.size; ++i)
+				in_order &= ((int*)chunk.data)[i] == (int)expected++;
+			++chunks;
+		}
+		CHECK(in_order);
+		CHECK(chunks == 5);
+
+		int more[50];
+		for(int i = 0; i < 50; ++i) more[i] = 100 + i;
+		CHECK(fp_segmented_dynarray_append(&a, more, 50) == 100);
+		CHECK(*fp_segmented_dynarray_get_typed(int, &a, 149) == 149);
+		CHECK(*(int*)fp_segmented_dynarray_pop_back(&a) == 149);
+
+		fp_dynarray(int) flat = fp_segmented_dynarray_to_dynarray_typed(int, &a);
+		CHECK(fpda_size(flat) == 149);
+		CHECK(flat[124] == 124);
+		fpda_free_and_null(flat);
+
+		fp_segmented_dynarray_resize(&a, 10);
+		fp_segmented_dynarray_shrink_to_fit(&a);
+		CHECK(fp_segmented_dynarray_capacity(&a) == 4 + 8);
+		CHECK(fp_segmented_dynarray_get(&a, 0) == stable);
+		fp_segmented_dynarray_resize(&a, 12);
+		CHECK(fp_segmented_dynarray_pop_back_n(&a, 0) == NULL); // Exactly full, so there is no element past the end to point at
+		CHECK(fp_segmented_dynarray_size(&a) == 12);
+		CHECK(fp_segmented_dynarray_grow(&a, 0) == NULL);
+		fp_segmented_dynarray_free(&a);
+		CHECK(fp_segmented_dynarray_pop_back_n(&a, 0) == NULL);
+		CHECK(fp_segmented_dynarray_grow(&a, 0) == NULL);
+		CHECK(fp_segmented_dynarray_size(&a) == 0);
+		CHECK(fp_segmented_dynarray_capacity(&a) == 0);
+	}
+
+	TEST_CASE("PackedArray") {
+		uint64_t values[300], unpacked[300];
+		enum fp_simd_level supported = fp_simd_detect();
+		for(unsigned width: {0, 1, 7, 13, 32, 57, 58, 63, 64}) {
+			for(size_t i = 0; i < 300; ++i)
+				values[i] = (i * 0x9E3779B97F4A7C15ull) & __fp_bits_mask(width);
+
+			struct fp_packed_array a;
+			fp_packed_array_init(&a, 0);
+			fp_packed_array_assign(&a, values, 300);
+			CHECK(fp_packed_array_width(&a) <= width);
+			CHECK(fp_packed_array_bytes(&a) <= (fp_packed_words(300, width) + 1) * sizeof(uint64_t));
+			size_t failures = 0;
+			for(size_t i = 0; i < 300; ++i)
+				failures += fp_packed_array_get(&a, i) != values[i];
+			for(int level = FP_SIMD_SCALAR; level <= supported; ++level) { // Every kernel, from every starting position in a word
+				fp_simd_set_level((enum fp_simd_level)level);
+				for(size_t first: {0, 1, 5, 63, 64, 100}) {
+					fp_packed_array_unpack(&a, first, 300 - first, unpacked);
+					failures += memcmp(unpacked, values + first, (300 - first) * sizeof(uint64_t)) != 0;
+				}
+			}
+			fp_simd_set_level(supported);
+			CHECK(failures == 0);
+			fp_packed_array_free(&a);
+		}
+
+		// Values are set in place and pushed onto the end without disturbing their neighbours
+		struct fp_packed_array a;
+		fp_packed_array_init(&a, 11);
+		for(uint64_t i = 0; i < 100; ++i)
+			fp_packed_array_push_back(&a, i * 20);
+		fp_packed_array_set(&a, 5, 2047);
+		CHECK(fp_packed_array_size(&a) == 100);
+		CHECK(fp_packed_array_get(&a, 4) == 80);
+		CHECK(fp_packed_array_get(&a, 5) == 2047);
+		CHECK(fp_packed_array_get(&a, 6) == 120);
+		CHECK(fp_packed_array_get(&a, 99) == 1980);
+		CHECK(fp_packed_array_bytes(&a) < 100 * sizeof(uint64_t) / 4);
+		fp_packed_array_free(&a);
+	}
+
+	TEST_CASE("FrameOfReferenceArray") {
+		constexpr size_t size = 1000;
+		uint64_t sorted[size], noisy[size], decoded[size];
+		for(size_t i = 0; i < size; ++i) {
+			sorted[i] = 1000000 + i * 10 + (i * 7) % 5;
+			noisy[i] = 5000 + (i * 0x9E3779B97F4A7C15ull) % 300;
+		}
+		sorted[500] = sorted[501]; // Repeated values are fine
+
+		for(bool delta: {false, true}) {
+			struct fp_for_array a;
+			fp_for_array_init(&a);
+			fp_for_array_encode(&a, sorted, size, delta);
+			CHECK(fp_for_array_size(&a) == size);
+			CHECK(fp_for_array_bytes(&a) * 4 < size * sizeof(uint64_t));
+			size_t failures = 0;
+			for(size_t i = 0; i < size; ++i)
+				failures += fp_for_array_get(&a, i) != sorted[i];
+			fp_for_array_decode(&a, 0, size, decoded);
+			failures += memcmp(decoded, sorted, sizeof(decoded)) != 0;
+			fp_for_array_decode(&a, 100, 300, decoded);
+			failures += memcmp(decoded, sorted + 100, 300 * sizeof(uint64_t)) != 0;
+			CHECK(failures == 0);
+
+			CHECK(fp_for_array_lower_bound(&a, 0) == 0);
+			CHECK(fp_for_array_lower_bound(&a, sorted[700]) == 700);
+			CHECK(fp_for_array_lower_bound(&a, sorted[700] + 1) == 701);
+			CHECK(fp_for_array_lower_bound(&a, sorted[501]) == 500);
+			CHECK(fp_for_array_lower_bound(&a, sorted[size - 1] + 1) == size);
+			CHECK(fp_for_array_lower_bound(&a, sorted[FP_FOR_BLOCK_SIZE]) == FP_FOR_BLOCK_SIZE);
+
+			// A run of duplicates crossing into later blocks is found from its start
+			uint64_t runs[300];
+			for(size_t i = 0; i < 300; ++i)
+				runs[i] = i < 120 ? i : 1000;
+			fp_for_array_encode(&a, runs, 300, delta);
+			CHECK(fp_for_array_lower_bound(&a, 1000) == 120);
+			CHECK(fp_for_array_lower_bound(&a, 119) == 119);
+			CHECK(fp_for_array_lower_bound(&a, 1001) == 300);
+			fp_for_array_free(&a);
+		}
+
+		// Unsorted values are stored relative to each block's minimum
+		struct fp_for_array a;
+		fp_for_array_init(&a);
+		fp_for_array_encode(&a, noisy, size, false);
+		CHECK(a.blocks[0].width <= 9);
+		fp_for_array_decode(&a, 0, size, decoded);
+		CHECK(memcmp(decoded, noisy, sizeof(decoded)) == 0);
+		CHECK(fp_for_array_get(&a, 777) == noisy[777]);
+		fp_for_array_free(&a);
+	}
+
+	TEST_CASE("Varint") {
+		CHECK(fp_varint_size(0) == 1);
+		CHECK(fp_varint_size(127) == 1);
+		CHECK(fp_varint_size(128) == 2);
+		CHECK(fp_varint_size(UINT64_MAX) == 10);
+		CHECK(fp_zigzag_encode(-1) == 1);
+		CHECK(fp_zigzag_decode(fp_zigzag_encode(INT64_MIN)) == INT64_MIN);
+
+		uint64_t values[100], decoded[100];
+		for(size_t i = 0; i < 100; ++i)
+			values[i] = i < 50 ? i : ((uint64_t)1) << (i - 36); // Runs of single byte values, then ever longer ones
+		fp_dynarray(uint8_t) bytes = nullptr;
+		fp_varint_encode(bytes, values, 100);
+		CHECK(fp_varint_count(bytes, fpda_size(bytes)) == 100);
+		CHECK(fp_varint_decode(bytes, fpda_size(bytes), decoded, 100, false) == 100);
+		CHECK(memcmp(values, decoded, sizeof(values)) == 0);
+		CHECK(fp_varint_decode(bytes, fpda_size(bytes) - 1, decoded, 100, false) == 99); // The last value is cut off
+
+		// Streaming one value at a time
+		const uint8_t* cursor = bytes, *end = bytes + fpda_size(bytes);
+		size_t read = 0;
+		uint64_t value;
+		while((cursor = fp_varint_read(cursor, end, &value)))
+			read += value == values[read];
+		CHECK(read == 100);
+
+		// Sorted values only store their (small) gaps
+		for(size_t i = 0; i < 100; ++i)
+			values[i] = 1700000000000ull + i * 100;
+		fpda_clear(bytes);
+		fp_varint_encode_delta(bytes, values, 100);
+		CHECK(fpda_size(bytes) == fp_varint_size(values[0]) + 99);
+		CHECK(fp_varint_decode(bytes, fpda_size(bytes), decoded, 100, true) == 100);
+		CHECK(memcmp(values, decoded, sizeof(values)) == 0);
+		fpda_free_and_null(bytes);
+	}
+
 	TEST_CASE("String") {
 		fp_string str = fp_string_promote_literal("Hello World");
 		CHECK(is_fp(str));
@@ -353,6 +1663,52 @@ TEST_SUITE("LibFP") {
 		fp_string_free(str);
 	}
 
+#ifdef FP_HAS_MMAP
+	TEST_CASE("String::MappedFile") {
+		const char* path = "fp_mapped_file_test.txt";
+		FILE* file = fopen(path, "wb");
+		REQUIRE(file != nullptr);
+		fputs("alpha,beta,gamma", file);
+		fclose(file);
+
+		fp_string mapped = fp_mmap_file(path, false);
+		REQUIRE(mapped != nullptr);
+		CHECK(is_fp(mapped));
+		CHECK(fp_is_mapped_file(mapped));
+		CHECK(!fp_is_heap_allocated(mapped));
+		CHECK(fp_length(mapped) == 16);
+		CHECK(mapped[16] == 0);
+		fp_string_view view = fp_string_to_view(mapped);
+		CHECK(fp_string_view_length(view) == 16);
+		CHECK(fp_string_view_find(view, fp_string_to_view((char*)"gamma"), 0) == 11);
+		fp_dynarray(fp_string_view) parts = fp_string_view_split(view, fp_string_to_view((char*)","));
+		CHECK(fpda_size(parts) == 3);
+		CHECK(fp_string_view_equal(parts[1], fp_string_to_view((char*)"beta")));
+		fpda_free(parts);
+		fp_string_free(mapped);
+
+		fp_string copy = fp_mmap_file(path, true);
+		REQUIRE(copy != nullptr);
+		copy[0] = 'A'; // Changes stay in memory
+		fp_munmap_file(copy);
+		copy = fp_mmap_file(path, true);
+		CHECK(copy[0] == 'a');
+		fp_munmap_file_and_null(copy);
+
+		file = fopen(path, "wb");
+		fclose(file);
+		fp_string empty = fp_mmap_file(path, false);
+		REQUIRE(empty != nullptr);
+		CHECK(is_fp(empty));
+		CHECK(fp_length(empty) == 0);
+		CHECK(empty[0] == 0);
+		fp_string_free(empty);
+
+		remove(path);
+		CHECK(fp_mmap_file(path, false) == nullptr);
+	}
+#endif
+
 	TEST_CASE("UTF32") {
 		auto cp = fp_string_to_codepoints("Hello, 世界");
 		uint32_t real[] = {'H', 'e', 'l', 'l', 'o', ',', ' ', 0x4E16, 0x754C};
@@ -2,10 +2,22 @@
 // #include "doctest_stubs.hpp"
 
 #include <format>
+#include <string>
+#include <vector>
 
 #include <fp/pointer.hpp>
 #include <fp/dynarray.hpp>
 #include <fp/string.hpp>
+#include <fp/sort.hpp>
+#include <fp/parallel.hpp>
+#include <fp/deque.hpp>
+#include <fp/queue.hpp>
+#include <fp/concurrent_dynarray.hpp>
+#include <fp/soa_dynarray.hpp>
+#include <fp/bitset.hpp>
+#include <fp/slotmap.hpp>
+#include <fp/segmented_dynarray.hpp>
+#include <fp/compressed.hpp>
 
 TEST_SUITE("LibFP::C++") {
 
@@ -44,6 +56,48 @@ TEST_SUITE("LibFP::C++") {
 		arr.free();
 	}
 
+	TEST_CASE("Heap (Allocator)") {
+		size_t calls = 0;
+		fp_allocator_id allocator = fp_allocator_register({[](void* calls, void* p, size_t size) noexcept {
+			++*(size_t*)calls;
+			return FP_ALLOCATION_FUNCTION(p, size);
+		}, &calls});
+
+		auto arr = fp::malloc<int>(20, allocator);
+		CHECK(arr.allocator() == allocator);
+		arr.realloc(25);
+		CHECK(arr.allocator() == allocator);
+		arr.free();
+		CHECK(calls == 3);
+
+		{
+			fp::raii::dynarray<int> da = {};
+			da.reserve(4, allocator);
+			for(int i = 0; i < 10; ++i)
+				da.push_back(i);
+			CHECK(da.allocator() == allocator);
+			CHECK(da[9] == 9);
+		}
+		fp_allocator_unregister(allocator);
+	}
+
+	TEST_CASE("Dynarray (Aligned)") {
+		fp::raii::dynarray<float, 64> arr;
+		for(size_t i = 0; i < 100; ++i)
+			arr.push_back(i);
+		CHECK((uintptr_t)arr.raw % 64 == 0);
+		CHECK(arr.alignment() == 64);
+		CHECK(arr[99] == 99);
+
+		auto copy = arr;
+		CHECK((uintptr_t)copy.raw % 64 == 0);
+
+		fp::raii::pointer<double> ptr = fp::malloc_aligned<double>(4, 32);
+		CHECK((uintptr_t)ptr.raw % 32 == 0);
+		ptr.realloc(400);
+		CHECK((uintptr_t)ptr.raw % 32 == 0);
+	}
+
 	TEST_CASE("Heap (RAII)") {
 		fp::raii::pointer arr = fp::malloc<int>(20);
 		arr.realloc(25);
@@ -82,6 +136,18 @@ TEST_SUITE("LibFP::C++") {
 		for(auto& i: view) CHECK(i == 6);
 	}
 
+	TEST_CASE("Fill") {
+		fp::dynarray<double> arr = {};
+		arr.resize(100);
+		arr.fill(6.5);
+		size_t mismatches = 0;
+		for(auto& d: arr) mismatches += d != 6.5;
+		CHECK(mismatches == 0);
+		arr.fill(arr[3]);
+		CHECK(arr[99] == 6.5);
+		arr.free();
+	}
+
 	TEST_CASE("Dynamic Array - Basic") {
 		fp::dynarray<int> arr = {};
 		arr.reserve(20);
@@ -151,6 +217,425 @@ TEST_SUITE("LibFP::C++") {
 		arr.free_and_null();
 	}
 
+	TEST_CASE("Dynamic Array - Bulk") {
+		fp::raii::dynarray<int> arr;
+		arr.append_range({1, 2, 3});
+		auto appended = arr.append_range(arr.full_view()); // Appending the array to itself
+		CHECK(appended.size() == 3);
+		CHECK(arr.size() == 6);
+		CHECK(arr[5] == 3);
+		arr.insert_range(1, {7, 8});
+		CHECK(arr.size() == 8);
+		CHECK(arr[0] == 1);
+		CHECK(arr[1] == 7);
+		CHECK(arr[2] == 8);
+		CHECK(arr[3] == 2);
+
+		// Elements which aren't trivially copyable are copy constructed
+		struct copied {
+			int value;
+			bool copy_constructed = false;
+			copied(int value): value(value) {}
+			copied(const copied& o): value(o.value), copy_constructed(true) {}
+		};
+		fp::raii::dynarray<copied> objects;
+		objects.append_range({1, 3});
+		objects.insert_range(1, {2});
+		CHECK(objects.size() == 3);
+		CHECK(objects[1].value == 2);
+		CHECK(objects[2].value == 3);
+		CHECK(objects[1].copy_constructed);
+
+		fp::raii::dynarray<std::string> strings;
+		strings.append_range({"a string too long for small string optimization", "another string which lives on the heap"}); // Short strings point into themselves, so can't be relocated bytewise
+		strings.shrink_to_fit();
+		strings.append_range(strings.full_view()); // Growing moves the elements being copied
+		CHECK(strings.size() == 4);
+		CHECK(strings[2] == "a string too long for small string optimization");
+		CHECK(strings[3] == "another string which lives on the heap");
+		for(auto& string: strings) std::destroy_at(&string); // The array frees its storage but doesn't run destructors
+	}
+
+	TEST_CASE("Dynamic Array - Remove If") {
+		fp::raii::dynarray<int> arr;
+		arr.append_range({5, 1, 1, 2, 8, 3, 3, 3, 9});
+		int threshold = 4;
+		CHECK(arr.remove_if([threshold](int x) { return x > threshold; }) == 3);
+		CHECK(arr.size() == 6);
+		CHECK(arr.unique() == 3);
+		CHECK(arr.size() == 3);
+		CHECK(arr[0] == 1);
+		CHECK(arr[1] == 2);
+		CHECK(arr[2] == 3);
+	}
+
+	TEST_CASE("Dynamic Array - Growth Policy") {
+		fp::raii::dynarray<int> arr;
+		arr.set_growth_policy(FP_GROWTH_DOUBLE);
+		CHECK(arr.growth_policy() == FP_GROWTH_DOUBLE);
+		for(int i = 0; i < 100; ++i)
+			arr.push_back(i);
+		CHECK(arr.capacity() == 128);
+		arr.delete_range(0, 80);
+		CHECK(arr.size() == 20);
+		CHECK(arr.capacity() == 40);
+		CHECK(arr[0] == 80);
+	}
+
+	TEST_CASE("Dynamic Array - Small") {
+		fp::small_dynarray<int, 4> arr;
+		CHECK(arr.is_small());
+		CHECK(arr.capacity() >= 4);
+		for(int i = 1; i <= 3; ++i)
+			arr.push_back(i);
+		CHECK(arr.is_small());
+		CHECK(arr.size() == 3);
+
+		fp::small_dynarray<int, 4> copy = arr;
+		CHECK(copy.is_small());
+		CHECK(copy.data() != arr.data());
+		CHECK(copy[2] == 3);
+
+		for(int i = 4; i <= 100; ++i)
+			arr.push_back(i);
+		CHECK(!arr.is_small());
+		CHECK(arr[99] == 100);
+
+		auto moved = std::move(arr); // Steals the heap allocation
+		CHECK(!moved.is_small());
+		CHECK(moved.size() == 100);
+		CHECK(arr.is_small());
+		CHECK(arr.empty());
+
+		copy = std::move(moved);
+		CHECK(copy.size() == 100);
+		copy.free();
+		CHECK(copy.is_small());
+		CHECK(copy.empty());
+
+		fp::small_dynarray<double, 2, 64> aligned;
+		CHECK((uintptr_t)aligned.data() % 64 == 0);
+		for(int i = 0; i < 10; ++i)
+			aligned.push_back(i);
+		CHECK(!aligned.is_small());
+		CHECK((uintptr_t)aligned.data() % 64 == 0);
+	}
+
+	TEST_CASE("Sort") {
+		fp::raii::dynarray<int> arr;
+		uint32_t state = 1;
+		for(int i = 0; i < 5000; ++i) {
+			state = state * 1664525 + 1013904223;
+			arr.push_back((int)(state >> 16) % 1000);
+		}
+		fp::raii::dynarray<int> radix = arr;
+		fp::sort(arr.full_view(), std::greater<>{});
+		CHECK(std::is_sorted(arr.begin(), arr.end(), std::greater<>{}));
+		fp::radix_sort(radix.full_view());
+		CHECK(std::is_sorted(radix.begin(), radix.end()));
+
+		auto equal = fp::equal_range(radix.full_view(), 500);
+		CHECK(fp::lower_bound(radix.full_view(), 500) == (size_t)(equal.data() - radix.data()));
+		CHECK(std::all_of(equal.begin(), equal.end(), [](int x) { return x == 500; }));
+		CHECK(fp::upper_bound(radix.full_view(), 999) == radix.size());
+
+		struct entry { float weight; int id; };
+		fp::raii::dynarray<entry> entries;
+		entries.append_range({{2.5f, 0}, {-1.f, 1}, {2.5f, 2}, {0.f, 3}});
+		fp::radix_sort_by_key(entries.full_view(), [](entry& e) -> float& { return e.weight; });
+		CHECK(entries[0].id == 1);
+		CHECK(entries[1].id == 3);
+		CHECK(entries[2].id == 0);
+		CHECK(entries[3].id == 2);
+	}
+
+	TEST_CASE("Parallel") {
+		fp::thread_pool pool(3);
+		CHECK(pool.concurrency() == 4);
+		fp::parallel::options opts{.pool = &pool, .sequential_threshold = 0};
+
+		std::atomic<size_t> ran = 0;
+		pool.run(100, [&](size_t i) {
+			pool.run(2, [&](size_t) { ran.fetch_add(1); }); // Nested batches run sequentially instead of deadlocking
+		});
+		CHECK(ran == 200);
+
+		fp::raii::dynarray<int> arr; arr.resize(10007);
+		fp::parallel::fill(arr.full_view(), 1, opts);
+		CHECK(fp::parallel::reduce(arr.full_view(), size_t{0}, std::plus<>{}, opts) == 10007);
+		fp::parallel::inclusive_scan(arr.full_view(), arr.full_view(), std::plus<>{}, opts);
+		CHECK(arr[0] == 1);
+		CHECK(arr[5000] == 5001);
+		CHECK(arr[10006] == 10007);
+
+		// Carries which aren't cheap to copy (moving a string leaves it empty) must still combine correctly
+		std::vector<std::string> letters(1000), prefixes(letters.size());
+		for(size_t i = 0; i < letters.size(); ++i) letters[i] = std::string(1, char('a' + i % 26));
+		fp::parallel::inclusive_scan(fp::view<std::string>{letters.data(), letters.size()}, fp::view<std::string>{prefixes.data(), prefixes.size()}, std::plus<>{}, opts);
+		std::string prefix;
+		size_t wrong = 0;
+		for(size_t i = 0; i < letters.size(); ++i)
+			wrong += prefixes[i] != (prefix += letters[i]);
+		CHECK(wrong == 0);
+
+		fp::raii::dynarray<double> halves; halves.resize(arr.size());
+		fp::parallel::transform(arr.full_view(), halves.full_view(), [](int x) { return x / 2.0; }, opts);
+		CHECK(halves[10006] == 10007 / 2.0);
+		fp::parallel::for_each(arr.full_view(), [](int& x) { x = -x; }, opts);
+		CHECK(arr[41] == -42);
+
+		uint32_t state = 7;
+		for(auto& x: arr) x = (int)((state = state * 1664525 + 1013904223) >> 8) % 5000;
+		fp::raii::dynarray<int> expected = arr;
+		std::sort(expected.begin(), expected.end());
+		for(size_t workers: {3, 4, 0}) { // Also covers uneven numbers of runs and the sequential fallback
+			pool.resize(workers);
+			fp::raii::dynarray<int> sorted = arr;
+			fp::parallel::sort(sorted.full_view(), std::less<>{}, opts);
+			CHECK(std::equal(sorted.begin(), sorted.end(), expected.begin(), expected.end()));
+		}
+	}
+
+	TEST_CASE("Deque") {
+		fp::raii::deque<int> q;
+		for(int i = 0; i < 5; ++i) q.push_back(i);
+		q.push_front(-1);
+		CHECK(q.size() == 6);
+		CHECK(q.front() == -1);
+		CHECK(q.back() == 4);
+		CHECK(q.pop_front() == -1);
+		CHECK(q.pop_back() == 4);
+
+		int expected = 0;
+		for(int x: q) CHECK(x == expected++);
+		CHECK(expected == 4);
+
+		q.append_range({10, 11, 12, 13, 14});
+		CHECK(q.first_segment().size() + q.second_segment().size() == 9);
+		fp::raii::deque<int> copy = q;
+		int out[4];
+		CHECK(q.pop_front_range({out, 4}) == 4);
+		CHECK(out[3] == 3);
+		CHECK(q[0] == 10);
+		CHECK(copy.size() == 9);
+		CHECK(copy[4] == 10);
+	}
+
+	TEST_CASE("Queue") {
+		fp::spsc_queue<int> spsc(4);
+		int values[] = {1, 2, 3, 4, 5};
+		CHECK(spsc.push_range({values, 5}) == 4);
+		CHECK(!spsc.push(6));
+		CHECK(spsc.pop() == 1);
+		CHECK(spsc.size() == 3);
+		int out[4];
+		CHECK(spsc.pop_range({out, 4}) == 3);
+		CHECK(out[2] == 4);
+		CHECK(!spsc.pop());
+
+		fp::mpmc_queue<double> mpmc(2);
+		CHECK(mpmc.push(1.5));
+		CHECK(mpmc.push(2.5));
+		CHECK(!mpmc.push(3.5));
+		double value;
+		CHECK(mpmc.pop(value));
+		CHECK(value == 1.5);
+		CHECK(mpmc.pop() == 2.5);
+		CHECK(!mpmc.pop());
+	}
+
+	TEST_CASE("Concurrent Dynamic Array") {
+		fp::concurrent_dynarray<int> a(2);
+		CHECK(a.push_back(1) == 0);
+		int& first = a[0];
+		int values[] = {2, 3, 4, 5};
+		CHECK(a.append_range({values, 4}) == 1);
+		CHECK(&a[0] == &first);
+		size_t start = a.reserve(2);
+		a[start] = 6;
+		a[start + 1] = 7;
+		a.commit(2);
+		CHECK(a.size() == 7);
+
+		fp::raii::dynarray<int> frozen = a.freeze();
+		REQUIRE(frozen.size() == 7);
+		for(size_t i = 0; i < 7; ++i)
+			CHECK(frozen[i] == int(i + 1));
+		CHECK(a.size() == 0);
+	}
+
+	TEST_CASE("Struct of Arrays Dynamic Array") {
+		fp::raii::soa_dynarray<float, int, char> a;
+		for(int i = 0; i < 20; ++i)
+			CHECK(a.push_back(i * .5f, i, 'a' + i) == size_t(i));
+		CHECK(a.is_soa_dynarray());
+		CHECK(a.size() == 20);
+		CHECK(a.column<1>().size() == 20);
+		CHECK(a.column<1>()[19] == 19);
+		CHECK(a.get<2>(2) == 'c');
+
+		auto [x, id, tag] = a[5];
+		CHECK(x == 2.5f);
+		id = -5;
+		CHECK(a.get<1>(5) == -5);
+
+		CHECK(a.insert(0, 100.f, 100, 'z') == 0);
+		a.delete_(1);
+		CHECK(a.get<0>(0) == 100.f);
+		CHECK(a.get<1>(1) == 1);
+		a.swap_delete(0);
+		CHECK(a.get<2>(0) == 'a' + 19);
+		CHECK(a.size() == 19);
+
+		int sum = 0;
+		for(int v: a.column<1>()) sum += v;
+		CHECK(sum == 190 - 5 - 5); // Dropped 0, changed 5 to -5
+
+		a.resize(25);
+		CHECK(a.get<1>(24) == 0);
+		fp::raii::soa_dynarray<float, int, char> b = a;
+		CHECK(b.size() == 25);
+		CHECK(b.get<2>(0) == 'a' + 19);
+		a.clear();
+		CHECK(a.empty());
+		CHECK(!b.empty());
+	}
+
+	TEST_CASE("Bitset") {
+		int values[] = {5, -1, 3, 0, -7, 2};
+		auto positive = fp::raii::bitset::from(fp::view<int>{values, 6}, [](int v) { return v > 0; });
+		CHECK(positive.size() == 6);
+		CHECK(positive.count() == 3);
+		CHECK(positive[0]);
+		CHECK(!positive[1]);
+		size_t expected[] = {0, 2, 5}, n = 0;
+		for(size_t i: positive)
+			CHECK(i == expected[n++]);
+		CHECK(n == 3);
+
+		fp::raii::bitset odd(6);
+		odd.set(0).set(2).set(4);
+		auto both = positive;
+		both &= odd;
+		CHECK(both.count() == 2);
+		CHECK(both != positive);
+		both |= positive;
+		CHECK(both == positive);
+		both.and_not(odd);
+		CHECK(both.count() == 1);
+		CHECK(both.find_next_set(0) == 5);
+
+		int kept[6];
+		CHECK(positive.compress(fp::view<const int>{values, 6}, fp::view<int>{kept, 6}) == 3);
+		CHECK(kept[2] == 2);
+
+		auto index = positive.rank_index();
+		CHECK(positive.rank(index.data(), 3) == 2);
+		CHECK(positive.select(index.data(), 2) == 5);
+
+		positive.resize(70, true).push_back(false);
+		CHECK(positive.size() == 71);
+		CHECK(positive.count() == 67);
+		CHECK(!positive.all());
+	}
+
+	TEST_CASE("SlotMap") {
+		struct entity { float x, y; int id; };
+		fp::slotmap<entity> entities;
+		auto a = entities.insert({1, 2, 0});
+		auto b = entities.insert({3, 4, 1});
+		auto c = entities.insert({5, 6, 2});
+		CHECK(entities.size() == 3);
+		CHECK(entities[b].x == 3);
+
+		CHECK(entities.erase(a));
+		CHECK(!entities.contains(a));
+		CHECK(entities.get(a) == nullptr);
+		CHECK(entities[c].id == 2);
+		CHECK(entities.handle_at(0) == c);
+
+		int ids = 0;
+		for(auto& e: entities) ids += e.id;
+		CHECK(ids == 3);
+
+		auto copy = entities;
+		entities.clear();
+		CHECK(entities.empty());
+		CHECK(copy.size() == 2);
+		CHECK(copy[b].y == 4);
+	}
+
+	TEST_CASE("SparseSet") {
+		fp::sparse_set set;
+		for(uint32_t id: {3u, 1u, 4u, 1u, 5u}) set.insert(id);
+		CHECK(set.size() == 4);
+		CHECK(set.contains(4));
+		CHECK(set.erase(3));
+		CHECK(!set.contains(3));
+		uint32_t sum = 0;
+		for(auto id: set) sum += id;
+		CHECK(sum == 10);
+		CHECK(set.index_of(3) == set.size());
+	}
+
+	TEST_CASE("SegmentedDynarray") {
+		fp::segmented_dynarray<int> arr(8);
+		int& first = arr.push_back(5);
+		for(int i = 1; i < 1000; ++i) arr.push_back(i);
+		CHECK(&arr[0] == &first);
+		CHECK(arr.size() == 1000);
+		CHECK(arr.back() == 999);
+
+		size_t sum = 0;
+		for(auto chunk: arr.chunks())
+			for(int v: chunk) sum += v;
+		CHECK(sum == 999 * 1000 / 2 + 5);
+		CHECK(arr.chunks()[0].size() == 8);
+
+		CHECK(arr.pop_back() == 999);
+		arr.resize(1010, 7);
+		CHECK(arr[1005] == 7);
+		CHECK(arr.end() - arr.begin() == 1010);
+
+		auto copy = arr;
+		arr.clear().shrink_to_fit();
+		CHECK(arr.empty());
+		CHECK(arr.capacity() == 0);
+		CHECK(copy[1] == 1);
+		auto flat = copy.to_dynarray();
+		CHECK(flat.size() == 1010);
+		CHECK(flat[998] == 998);
+	}
+
+	TEST_CASE("CompressedIntegers") {
+		fp::raii::dynarray<uint64_t> ids;
+		for(uint64_t i = 0; i < 500; ++i) ids.push_back(i * 3 + i % 2);
+
+		fp::packed_array packed(ids.full_view());
+		CHECK(packed.width() == 11);
+		CHECK(packed[499] == ids[499]);
+		auto copy = packed;
+		copy.set(0, 7).push_back(1);
+		CHECK(copy.size() == 501);
+		CHECK(packed[0] == 0);
+		CHECK(copy.unpack()[0] == 7);
+
+		fp::for_array delta(ids.full_view(), true);
+		CHECK(delta.is_delta());
+		CHECK(delta.bytes() < packed.bytes());
+		CHECK(delta[321] == ids[321]);
+		CHECK(delta.lower_bound(ids[321]) == 321);
+		auto decoded = delta.decode();
+		CHECK(decoded.size() == 500);
+		CHECK(decoded[250] == ids[250]);
+
+		auto bytes = fp::varint_encode(ids.full_view(), true);
+		CHECK(bytes.size() == 500);
+		auto back = fp::varint_decode(bytes.full_view(), true);
+		CHECK(back.size() == 500);
+		CHECK(back[499] == ids[499]);
+	}
+
 	TEST_CASE("String") {
 		auto str = fp::raii::string{"Hello World"};
 		CHECK(str.is_fp());